@@ -36,25 +36,46 @@ CONFIG += utf8_source
 #-------------------------------------------------------------------------------
 
 include($$PWD/lib/Libraries.pri)
+include($$PWD/src/Core.pri)
 
 HEADERS += \
-    src/HAL_Driver.h \
-    src/MainWindow.h \
-    src/Serial.h \
-    src/Utilities.h
+    src/Headless.h
 
 SOURCES += \
-    src/MainWindow.cpp \
-    src/Serial.cpp \
-    src/Utilities.cpp \
+    src/Headless.cpp \
     src/main.cpp
 
-FORMS += \
-    src/MainWindow.ui
-
 RESOURCES += \
     res/Resources.qrc
 
+#-------------------------------------------------------------------------------
+# Interfaz grafica (deshabilitar con CONFIG+=headless)
+#-------------------------------------------------------------------------------
+
+headless {
+    QT -= svg
+    QT -= widgets
+    QTPLUGIN -= qsvg
+    DEFINES += HEADLESS_BUILD
+}
+
+else {
+    HEADERS += \
+        src/InputPanel.h \
+        src/MainWindow.h \
+        src/TelemetryPlot.h \
+        src/Utilities.h
+
+    SOURCES += \
+        src/InputPanel.cpp \
+        src/MainWindow.cpp \
+        src/TelemetryPlot.cpp \
+        src/Utilities.cpp
+
+    FORMS += \
+        src/MainWindow.ui
+}
+
 #-------------------------------------------------------------------------------
 # Opciones especificas a cada plataforma
 #-------------------------------------------------------------------------------
@@ -0,0 +1,210 @@
+/*
+ * Copyright (c) 2022 Alex Spataru <https://github.com/alex-spataru>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "Bench_Evdev.h"
+
+#include <QTest>
+#include <QTimer>
+#include <QThread>
+#include <QEventLoop>
+#include <QElapsedTimer>
+#include <QRandomGenerator>
+
+#include <QJoysticks.h>
+#include <QJoysticks/Evdev_Joysticks.h>
+
+#include <algorithm>
+#include <cstdio>
+
+/**
+ * Name of the virtual gamepad, used to recognize its events
+ */
+static const char *DEVICE_NAME = "Joystick2Serial Benchmark Gamepad";
+
+/**
+ * Time given to an input system to register the gamepad & to deliver each sample
+ */
+static const int REGISTER_TIMEOUT = 5000;
+static const int SAMPLE_TIMEOUT = 1000;
+
+/**
+ * Returns the value at the given @a percentile of the sorted list of @a samples
+ */
+static qint64 percentile(const QVector<qint64> &samples, const double percentile)
+{
+    if (samples.isEmpty())
+        return 0;
+
+    auto index = static_cast<int>(percentile * (samples.count() - 1) + 0.5);
+    return samples.at(qBound(0, index, samples.count() - 1));
+}
+
+/**
+ * Constructor function, 500 samples are taken for each input system by default
+ */
+Bench_Evdev::Bench_Evdev(QObject *parent)
+    : QObject(parent)
+    , m_samples(500)
+{
+}
+
+/**
+ * Returns the results of the input systems that have been measured
+ */
+QJsonArray Bench_Evdev::results() const
+{
+    return m_results;
+}
+
+/**
+ * Changes the number of @a samples taken for each input system
+ */
+void Bench_Evdev::setSamples(const int samples)
+{
+    m_samples = qMax(1, samples);
+}
+
+/**
+ * Creates the virtual gamepad
+ */
+void Bench_Evdev::initTestCase()
+{
+    QString error;
+    if (!m_device.create(DEVICE_NAME, &error))
+        QSKIP(qPrintable(error));
+}
+
+/**
+ * Removes the virtual gamepad & reads the joysticks with SDL again
+ */
+void Bench_Evdev::cleanupTestCase()
+{
+    QJoysticks::getInstance()->setEvdevEnabled(false);
+    m_device.destroy();
+}
+
+/**
+ * Input systems to compare
+ */
+void Bench_Evdev::latency_data()
+{
+    QTest::addColumn<bool>("evdev");
+
+    QTest::newRow("sdl") << false;
+    QTest::newRow("evdev") << true;
+}
+
+/**
+ * Moves the X axis of the gamepad back & forth, and measures the time until the axis
+ * event is emitted by @c QJoysticks
+ */
+void Bench_Evdev::latency()
+{
+    QFETCH(bool, evdev);
+
+#ifndef SDL_SUPPORTED
+    if (!evdev)
+        QSKIP("QJoysticks was built without SDL");
+#endif
+    if (evdev && !Evdev_Joysticks::isSupported())
+        QSKIP("evdev is only available on Linux");
+
+    // Wait until the input system has registered the gamepad
+    auto joysticks = QJoysticks::getInstance();
+    joysticks->setEvdevEnabled(evdev);
+    QTRY_VERIFY_WITH_TIMEOUT(joysticks->deviceNames().contains(DEVICE_NAME),
+                             REGISTER_TIMEOUT);
+
+    // Preallocate the latency samples, so that measuring does not allocate memory
+    QVector<qint64> latencies;
+    latencies.reserve(m_samples);
+
+    QEventLoop loop;
+    QTimer timeout;
+    QElapsedTimer clock;
+    double expected = 0;
+    bool received = false;
+    timeout.setSingleShot(true);
+    connect(&timeout, &QTimer::timeout, &loop, &QEventLoop::quit);
+    auto connection = connect(joysticks, &QJoysticks::axisEvent, this,
+                              [&](const QJoystickAxisEvent &event) {
+                                  if (received || !event.joystick
+                                      || event.joystick->name != DEVICE_NAME
+                                      || qAbs(event.value - expected) > 0.01)
+                                      return;
+
+                                  latencies.append(clock.nsecsElapsed());
+                                  received = true;
+                                  loop.quit();
+                              });
+
+    // Take the samples
+    int lost = 0;
+    for (int i = 0; i < m_samples; ++i)
+    {
+        QThread::usleep(QRandomGenerator::global()->bounded(10000));
+
+        expected = (i % 2) ? -0.5 : 0.5;
+        received = false;
+        clock.start();
+        QVERIFY(m_device.setAxis(UInputDevice::LeftX, qRound(expected * 32767)));
+
+        timeout.start(SAMPLE_TIMEOUT);
+        if (!received)
+            loop.exec();
+
+        lost += received ? 0 : 1;
+    }
+
+    disconnect(connection);
+
+    // Report the results
+    std::sort(latencies.begin(), latencies.end());
+    QJsonObject result;
+    result["name"] = QString("input_latency_%1").arg(QTest::currentDataTag());
+    result["samples"] = latencies.count();
+    result["lost"] = lost;
+    result["p50_us"] = percentile(latencies, 0.50) / 1000.0;
+    result["p90_us"] = percentile(latencies, 0.90) / 1000.0;
+    result["p99_us"] = percentile(latencies, 0.99) / 1000.0;
+    result["max_us"] = percentile(latencies, 1.00) / 1000.0;
+    report(result);
+
+    QVERIFY(!latencies.isEmpty());
+}
+
+/**
+ * Prints the given @a result in a single line & stores it in the JSON results
+ */
+void Bench_Evdev::report(const QJsonObject &result)
+{
+    QString line = "BENCH " + result.value("name").toString();
+    for (auto it = result.constBegin(); it != result.constEnd(); ++it)
+    {
+        if (it.key() != "name")
+            line += QString(" %1=%2").arg(it.key()).arg(it.value().toDouble(), 0, 'f', 3);
+    }
+
+    fprintf(stdout, "%s\n", qPrintable(line));
+    fflush(stdout);
+    m_results.append(result);
+}
@@ -0,0 +1,66 @@
+/*
+ * Copyright (c) 2022 Alex Spataru <https://github.com/alex-spataru>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <QObject>
+#include <QJsonArray>
+#include <QJsonObject>
+
+#include "UInputDevice.h"
+
+/**
+ * @brief The Bench_Evdev class
+ *
+ * Compares the input latency of the SDL & evdev input systems with a virtual gamepad
+ * created through uinput. Each sample moves an axis of the gamepad and measures the
+ * time until @c QJoysticks emits the matching axis event, with a random pause between
+ * samples so that the SDL polling loop is not always in the same phase.
+ *
+ * The test is skipped if /dev/uinput cannot be opened (e.g. without permissions or on
+ * another operating system).
+ */
+class Bench_Evdev : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit Bench_Evdev(QObject *parent = nullptr);
+
+    QJsonArray results() const;
+    void setSamples(const int samples);
+
+private Q_SLOTS:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void latency_data();
+    void latency();
+
+private:
+    void report(const QJsonObject &result);
+
+private:
+    int m_samples;
+    QJsonArray m_results;
+    UInputDevice m_device;
+};
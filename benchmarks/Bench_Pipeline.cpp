@@ -0,0 +1,699 @@
+/*
+ * Copyright (c) 2022 Alex Spataru <https://github.com/alex-spataru>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "Bench_Pipeline.h"
+
+#include <QTest>
+#include <QTimer>
+#include <QVector>
+#include <QEventLoop>
+#include <QElapsedTimer>
+#include <QJoysticks/SDL_Joysticks.h>
+
+#include <algorithm>
+#include <cstdio>
+
+#include "Bridge.h"
+#include "Profile.h"
+#include "Mixer.h"
+#include "Shaper.h"
+#include "Expression.h"
+#include "LineFramer.h"
+#include "AllocTracker.h"
+#include "TelemetryParser.h"
+
+/**
+ * Number of times each throughput benchmark is repeated, the median is reported
+ */
+static const int REPETITIONS = 5;
+
+/**
+ * SDL instance ID used by the simulated joystick
+ */
+static const int INSTANCE_ID = 1000;
+
+/**
+ * Number of round trips measured by the latency benchmark
+ */
+static const int LATENCY_SAMPLES = 2000;
+
+/**
+ * Number of SDL events delivered at once by the subscriber benchmark, i.e. the events
+ * read in one polling cycle
+ */
+static const int EVENTS_PER_POLL = 16;
+
+/**
+ * Mapping used by the benchmarks, similar to the built-in profile
+ */
+static const char *PROFILE = R"({
+    "name": "Benchmark",
+    "outputs": [
+        { "name": "a", "scale": 1000 },
+        { "name": "b", "scale": 20 },
+        { "name": "c" },
+        { "name": "d", "min": 0, "max": 3200 }
+    ],
+    "axes": [
+        { "axis": 0, "output": "a" },
+        { "axis": 1, "output": "b" }
+    ],
+    "buttons": [
+        { "button": 0, "pressed": { "add": { "d": 360 } } }
+    ]
+})";
+
+/**
+ * Telemetry line used by the line framing benchmark
+ */
+static const char *TELEMETRY_LINE = "1523,-20,90,3240\r\n";
+
+/**
+ * Output expressions evaluated by the expression benchmark, one frame evaluates all of
+ * them (mixing of two axes, button toggle & deadzone)
+ */
+static const char *EXPRESSIONS[] = {
+    "clamp(axis5 * 20 + axis4 * 5, -20, 20)",
+    "rise(button0 && button1) ? 1 - light : light",
+    "deadzone(axis1, 0.1) * (button4 ? 0.5 : 1)",
+};
+
+/**
+ * Prevents the compiler from removing the benchmarked code
+ */
+static volatile int SINK = 0;
+
+/**
+ * Returns the integer at the beginning of the given frame @a line
+ */
+static int firstField(const char *line, const int length)
+{
+    int i = 0;
+    int value = 0;
+    bool negative = false;
+    if (length > 0 && line[0] == '-')
+    {
+        negative = true;
+        ++i;
+    }
+
+    for (; i < length && line[i] >= '0' && line[i] <= '9'; ++i)
+        value = value * 10 + (line[i] - '0');
+
+    return negative ? -value : value;
+}
+
+/**
+ * Returns the value at the given @a percentile of the sorted list of @a samples
+ */
+static qint64 percentile(const QVector<qint64> &samples, const double percentile)
+{
+    auto index = static_cast<int>(percentile * (samples.count() - 1) + 0.5);
+    return samples.at(qBound(0, index, samples.count() - 1));
+}
+
+/**
+ * Constructor function
+ */
+Bench_Pipeline::Bench_Pipeline(QObject *parent)
+    : QObject(parent)
+    , m_device(nullptr)
+{
+}
+
+/**
+ * Returns the results of the benchmarks that have been run
+ */
+QJsonArray Bench_Pipeline::results() const
+{
+    return m_results;
+}
+
+/**
+ * Registers the simulated joystick as an SDL device (which takes its ownership) &
+ * sends the frames of the @c Bridge to the loopback driver.
+ */
+void Bench_Pipeline::initTestCase()
+{
+    m_device = new QJoystickDevice;
+    m_device->id = 0;
+    m_device->instanceID = INSTANCE_ID;
+    m_device->name = "Benchmark device";
+    m_device->blacklisted = false;
+    for (int i = 0; i < 6; ++i)
+        m_device->axes.append(0);
+    for (int i = 0; i < 16; ++i)
+        m_device->buttons.append(false);
+
+    auto joysticks = QJoysticks::getInstance();
+    joysticks->sdlJoysticks()->addSimulatedDevice(m_device);
+    QVERIFY(joysticks->getInputDevice(m_device->id) == m_device);
+
+    Profile profile;
+    QString error;
+    QVERIFY2(Profile::parse(PROFILE, profile, &error), qPrintable(error));
+
+    m_loopback.open(QIODevice::ReadWrite);
+    Bridge::instance().setProfile(profile);
+    Bridge::instance().setDriver(&m_loopback);
+    Bridge::instance().setJoystick(m_device->id);
+    Bridge::instance().setSendRate(1);
+}
+
+/**
+ * Removes the simulated joystick
+ */
+void Bench_Pipeline::cleanupTestCase()
+{
+    QJoysticks::getInstance()->sdlJoysticks()->removeSimulatedDevice(INSTANCE_ID);
+    m_device = nullptr;
+
+    Bridge::instance().setDriver(nullptr);
+    m_loopback.close();
+}
+
+/**
+ * Translation of SDL axis events into @c QJoystickAxisEvent, without dispatching
+ */
+void Bench_Pipeline::sdlTranslation()
+{
+    auto sdl = QJoysticks::getInstance()->sdlJoysticks();
+
+    SDL_Event event;
+    memset(&event, 0, sizeof(event));
+    event.type = SDL_JOYAXISMOTION;
+    event.jaxis.which = INSTANCE_ID;
+    event.jaxis.axis = 0;
+
+    auto listener = sdl->listener();
+    sdl->setListener(nullptr);
+    sdl->blockSignals(true);
+    throughput("sdl_translation", 1000000, [&](int iterations) {
+        ALLOC_SCOPE(AllocTracker::Input);
+        for (int i = 0; i < iterations; ++i)
+        {
+            event.jaxis.value = (i & 1) ? 16384 : -16384;
+            sdl->injectEvents(&event, 1);
+        }
+    });
+    sdl->blockSignals(false);
+    sdl->setListener(listener);
+}
+
+/**
+ * Translation of SDL axis events & dispatch up to the output values of the @c Bridge,
+ * delivering each event on its own
+ */
+void Bench_Pipeline::sdlToBridge()
+{
+    auto sdl = QJoysticks::getInstance()->sdlJoysticks();
+
+    SDL_Event event;
+    memset(&event, 0, sizeof(event));
+    event.type = SDL_JOYAXISMOTION;
+    event.jaxis.which = INSTANCE_ID;
+    event.jaxis.axis = 0;
+
+    throughput("sdl_to_bridge", 500000, [&](int iterations) {
+        ALLOC_SCOPE(AllocTracker::Input);
+        for (int i = 0; i < iterations; ++i)
+        {
+            event.jaxis.value = (i & 1) ? 16384 : -16384;
+            sdl->injectEvents(&event, 1);
+        }
+    });
+}
+
+/**
+ * Dispatch of @c QJoysticks axis events emitted by another input system
+ * (@c onAxisEvent, @c axisChanged & the @c Bridge listener)
+ */
+void Bench_Pipeline::axisDispatch()
+{
+    QJoystickAxisEvent event;
+    event.axis = 0;
+    event.joystick = m_device;
+
+    auto joysticks = QJoysticks::getInstance();
+    throughput("axis_dispatch", 500000, [&](int iterations) {
+        ALLOC_SCOPE(AllocTracker::Input);
+        for (int i = 0; i < iterations; ++i)
+        {
+            event.value = (i & 1) ? 0.5 : -0.5;
+            Q_EMIT joysticks->axisEvent(event);
+        }
+    });
+}
+
+/**
+ * Cost of a subscriber to the joystick events. SDL axis events are delivered in
+ * batches of @c EVENTS_PER_POLL without any other subscriber, then with a slot
+ * connected to @c QJoysticks::axisEvent & then with a @c QJoystickListener. The
+ * difference with the first result is the cost of each kind of subscriber per event.
+ */
+void Bench_Pipeline::subscriberDispatch()
+{
+    struct Counter : public QJoystickListener
+    {
+        int events = 0;
+        void joystickEvents(const QJoystickEvent *, const int count) override
+        {
+            events += count;
+        }
+    };
+
+    auto joysticks = QJoysticks::getInstance();
+    auto sdl = joysticks->sdlJoysticks();
+
+    SDL_Event events[EVENTS_PER_POLL];
+    memset(events, 0, sizeof(events));
+    for (int i = 0; i < EVENTS_PER_POLL; ++i)
+    {
+        events[i].type = SDL_JOYAXISMOTION;
+        events[i].jaxis.which = INSTANCE_ID;
+        events[i].jaxis.axis = 0;
+        events[i].jaxis.value = (i & 1) ? 16384 : -16384;
+    }
+
+    auto run = [&](int iterations) {
+        ALLOC_SCOPE(AllocTracker::Input);
+        for (int i = 0; i < iterations; i += EVENTS_PER_POLL)
+            sdl->injectEvents(events, qMin(EVENTS_PER_POLL, iterations - i));
+    };
+
+    throughput("subscriber_none", 500000, run);
+
+    int received = 0;
+    auto connection = connect(joysticks, &QJoysticks::axisEvent, this,
+                              [&](const QJoystickAxisEvent &) { ++received; });
+    throughput("subscriber_signal", 500000, run);
+    disconnect(connection);
+
+    Counter counter;
+    joysticks->addListener(&counter);
+    throughput("subscriber_listener", 500000, run);
+    joysticks->removeListener(&counter);
+
+    QVERIFY(received > 0);
+    QCOMPARE(counter.events, received);
+}
+
+/**
+ * Encoding of the command frame sent by @c Bridge::sendData(), reusing the buffer
+ */
+void Bench_Pipeline::frameEncoding()
+{
+    QByteArray frame;
+    throughput("frame_encoding", 200000, [&](int iterations) {
+        ALLOC_SCOPE(AllocTracker::Frame);
+        for (int i = 0; i < iterations; ++i)
+        {
+            Bridge::instance().encodeFrame(frame);
+            SINK = SINK + frame.size();
+        }
+    });
+}
+
+/**
+ * Framing of received telemetry lines, fed in chunks of 64 bytes
+ */
+void Bench_Pipeline::lineFraming()
+{
+    const int linesPerBuffer = 64;
+    QByteArray data;
+    for (int i = 0; i < linesPerBuffer; ++i)
+        data.append(TELEMETRY_LINE);
+
+    int lines = 0;
+    LineFramer framer;
+    auto handler = [&](const char *line, const int length) {
+        lines += length > 0 ? 1 : 0;
+        SINK = SINK + line[0];
+    };
+
+    throughput("line_framing", linesPerBuffer * 8192, [&](int iterations) {
+        ALLOC_SCOPE(AllocTracker::Receive);
+        for (int i = 0; i < iterations / linesPerBuffer; ++i)
+        {
+            for (int offset = 0; offset < data.size(); offset += 64)
+            {
+                auto length = qMin(64, data.size() - offset);
+                framer.append(data.constData() + offset, length, handler);
+            }
+        }
+    });
+
+    QVERIFY(lines > 0);
+    QCOMPARE(framer.overflows(), quint64(0));
+}
+
+/**
+ * Decoding of received telemetry lines into the typed record, after framing
+ */
+void Bench_Pipeline::telemetryParsing()
+{
+    const int linesPerBuffer = 64;
+    QByteArray data;
+    for (int i = 0; i < linesPerBuffer; ++i)
+        data.append(TELEMETRY_LINE);
+
+    LineFramer framer;
+    TelemetryParser parser;
+    auto handler = [&](const char *line, const int length) {
+        if (parser.parseLine(line, length, 0))
+            SINK = SINK + parser.record().count;
+    };
+
+    throughput("telemetry_parsing", linesPerBuffer * 8192, [&](int iterations) {
+        ALLOC_SCOPE(AllocTracker::Receive);
+        for (int i = 0; i < iterations / linesPerBuffer; ++i)
+            framer.append(data.constData(), data.size(), handler);
+    });
+
+    QCOMPARE(parser.errors(), quint64(0));
+    QCOMPARE(parser.record().count, 4);
+    QCOMPARE(parser.record().fields[1].value, -20.0);
+}
+
+/**
+ * Mixing of three axes into the four wheels of a mecanum drive, each operation is one
+ * frame
+ */
+void Bench_Pipeline::outputMixing()
+{
+    const float weights[4][3] = {
+        { 1, 1, 1 }, { 1, -1, -1 }, { 1, -1, 1 }, { 1, 1, -1 },
+    };
+
+    Mixer mixer;
+    for (int i = 0; i < 3; ++i)
+        mixer.addInput(i);
+
+    for (int o = 0; o < 4; ++o)
+    {
+        mixer.addOutput(o, Mixer::Normalize);
+        for (int i = 0; i < 3; ++i)
+            mixer.setWeight(o, i, weights[o][i]);
+    }
+
+    float outputs[Mixer::MAX_OUTPUTS];
+    QVector<double> axes(Expression::MAX_INPUTS, 0);
+    throughput("output_mixing", 1 << 22, [&](int iterations) {
+        ALLOC_SCOPE(AllocTracker::Frame);
+        for (int i = 0; i < iterations; ++i)
+        {
+            axes[0] = (i % 200) / 100.0 - 1;
+            axes[1] = (i % 300) / 150.0 - 1;
+            mixer.mix(axes.constData(), axes.count(), outputs);
+            SINK = SINK + static_cast<int>(outputs[0] * 100);
+        }
+    });
+
+    // Full forward & full strafe saturate the first wheel, which is normalized to 1
+    axes[0] = 1;
+    axes[1] = 1;
+    axes[2] = 0;
+    mixer.mix(axes.constData(), axes.count(), outputs);
+    QCOMPARE(outputs[0], 1.0f);
+    QCOMPARE(outputs[1], 0.0f);
+}
+
+/**
+ * Evaluation of typical output expressions over a joystick state snapshot, each
+ * operation is one frame (every expression evaluated once)
+ */
+void Bench_Pipeline::expressionEvaluation()
+{
+    const QStringList outputs = { "spd1", "light", "stp1" };
+    const int count = sizeof(EXPRESSIONS) / sizeof(EXPRESSIONS[0]);
+
+    int size = 0;
+    int memorySize = 0;
+    QVector<Expression> expressions(count);
+    for (int i = 0; i < count; ++i)
+    {
+        QString error;
+        QVERIFY2(expressions[i].compile(EXPRESSIONS[i], outputs, &error),
+                 qPrintable(error));
+
+        size += expressions.at(i).registerCount();
+        memorySize += expressions.at(i).memoryCount();
+    }
+
+    QVector<double> registers(size);
+    QVector<double> memory(qMax(1, memorySize));
+    QVector<double> axes(Expression::MAX_INPUTS, 0);
+    QVector<double> buttons(Expression::MAX_INPUTS, 0);
+    QVector<double> values(outputs.count(), 0);
+    for (int i = 0, r = 0, m = 0; i < count; ++i)
+    {
+        expressions.at(i).initialize(registers.data() + r, memory.data() + m);
+        r += expressions.at(i).registerCount();
+        m += expressions.at(i).memoryCount();
+    }
+
+    Expression::Inputs inputs;
+    inputs.axes = axes.constData();
+    inputs.axisCount = axes.count();
+    inputs.buttons = buttons.constData();
+    inputs.buttonCount = buttons.count();
+    inputs.outputs = values.constData();
+    inputs.outputCount = values.count();
+
+    int active = 0;
+    throughput("expression_evaluation", 1 << 20, [&](int iterations) {
+        ALLOC_SCOPE(AllocTracker::Frame);
+        for (int i = 0; i < iterations; ++i)
+        {
+            // Move the axes & press both buttons every 64 frames
+            axes[1] = axes[4] = axes[5] = (i % 200) / 100.0 - 1;
+            buttons[0] = buttons[1] = (i & 63) == 0;
+
+            auto r = registers.data();
+            auto m = memory.data();
+            for (int j = 0; j < count; ++j)
+            {
+                values[j] = expressions.at(j).evaluate(inputs, r, m);
+                r += expressions.at(j).registerCount();
+                m += expressions.at(j).memoryCount();
+            }
+
+            active += values.at(1) != 0;
+        }
+    });
+
+    SINK = SINK + active;
+    QVERIFY(active > 0);
+    QCOMPARE(values.at(0), qBound(-20.0, axes.at(5) * 25, 20.0));
+}
+
+/**
+ * Shaping of four outputs at 1 kHz (slew limit, trapezoidal ramp, S-curve & no
+ * limit), with targets that change every 500 frames. Each operation is one frame.
+ */
+void Bench_Pipeline::outputShaping()
+{
+    const Shaper::Limits limits[] = {
+        { 2000, 0, 0 },
+        { 2000, 8000, 0 },
+        { 2000, 8000, 80000 },
+        { 0, 0, 0 },
+    };
+
+    const int count = sizeof(limits) / sizeof(limits[0]);
+    QVector<Shaper::State> states(count);
+    for (auto &state : states)
+        Shaper::reset(state, 0);
+
+    const double dt = 0.001;
+    throughput("output_shaping", 1 << 20, [&](int iterations) {
+        ALLOC_SCOPE(AllocTracker::Frame);
+        auto shaped = states.data();
+        for (int i = 0; i < iterations; ++i)
+        {
+            const auto target = (i / 500) % 2 ? 360.0 : 0.0;
+            for (int j = 0; j < count; ++j)
+                Shaper::step(shaped[j], target, limits[j], dt);
+
+            SINK = SINK + static_cast<int>(shaped[2].value);
+        }
+    });
+
+    // Every profile reaches the target & stops there
+    for (int i = 0; i < 2000; ++i)
+    {
+        for (int j = 0; j < count; ++j)
+            Shaper::step(states[j], 360, limits[j], dt);
+    }
+
+    for (const auto &state : states)
+        QCOMPARE(state.value, 360.0);
+}
+
+/**
+ * Time from a joystick event until the frame with the new value is received back
+ * through the loopback driver, with frames sent at 1 kHz.
+ */
+void Bench_Pipeline::loopbackLatency()
+{
+    QEventLoop loop;
+    LineFramer framer;
+    QElapsedTimer clock;
+    QVector<qint64> latencies;
+    latencies.reserve(LATENCY_SAMPLES);
+
+    int expected = 0;
+    qint64 sentAt = 0;
+    QJoystickAxisEvent event;
+    event.axis = 0;
+    event.joystick = m_device;
+
+    // Changes the axis value & waits for it to be received back
+    auto next = [&]() {
+        expected = (latencies.count() % 999) + 1;
+        event.value = (expected + 0.5) / 1000;
+        sentAt = clock.nsecsElapsed();
+        Q_EMIT QJoysticks::getInstance()->axisEvent(event);
+    };
+
+    // Measures the latency of each received frame with the expected value
+    auto handler = [&](const char *line, const int length) {
+        if (firstField(line, length) != expected)
+            return;
+
+        latencies.append(clock.nsecsElapsed() - sentAt);
+        if (latencies.count() < LATENCY_SAMPLES)
+            next();
+        else
+            loop.quit();
+    };
+
+    // clang-format off
+    auto connection = connect(&m_loopback, &HAL_Driver::dataReceived, this,
+                              [&](const QByteArray &data) {
+        framer.append(data.constData(), data.size(), handler);
+    }, Qt::QueuedConnection);
+    // clang-format on
+
+    // Run the pipeline at 1 kHz
+    Bridge::instance().setSendRate(1000);
+    QTimer::singleShot(60 * 1000, &loop, &QEventLoop::quit);
+
+    clock.start();
+    const auto writes = m_loopback.writeCount();
+    const auto allocations = AllocTracker::total();
+    next();
+    loop.exec();
+    const auto elapsed = clock.nsecsElapsed();
+    const auto allocated = AllocTracker::total() - allocations;
+    const auto frames = m_loopback.writeCount() - writes;
+
+    Bridge::instance().setSendRate(1);
+    disconnect(connection);
+    QCOMPARE(latencies.count(), LATENCY_SAMPLES);
+
+    // Report percentiles
+    std::sort(latencies.begin(), latencies.end());
+    QJsonObject result;
+    result["name"] = "loopback_latency";
+    result["ops_per_sec"] = latencies.count() * 1e9 / elapsed;
+    result["allocs_per_frame"] = frames > 0 ? static_cast<double>(allocated) / frames : 0;
+    result["p50_us"] = percentile(latencies, 0.50) / 1000.0;
+    result["p90_us"] = percentile(latencies, 0.90) / 1000.0;
+    result["p99_us"] = percentile(latencies, 0.99) / 1000.0;
+    result["max_us"] = latencies.last() / 1000.0;
+    report(result);
+}
+
+/**
+ * Prints the given @a result in a single line & stores it in the JSON results
+ */
+void Bench_Pipeline::report(const QJsonObject &result)
+{
+    QString line = "BENCH " + result.value("name").toString();
+    for (auto it = result.constBegin(); it != result.constEnd(); ++it)
+    {
+        if (it.key() != "name")
+            line += QString(" %1=%2").arg(it.key()).arg(it.value().toDouble(), 0, 'f', 3);
+    }
+
+    fprintf(stdout, "%s\n", qPrintable(line));
+    fflush(stdout);
+    m_results.append(result);
+}
+
+/**
+ * Runs @a run (which performs the given number of operations) once to warm up caches,
+ * then @c REPETITIONS times with the given number of @a iterations. The median time
+ * per operation & the average number of allocations per operation are reported.
+ */
+void Bench_Pipeline::throughput(const QString &name, const int iterations,
+                                const std::function<void(int)> &run)
+{
+    run(iterations / 10);
+
+    QVector<double> samples;
+    quint64 allocations[AllocTracker::SubsystemCount] = {};
+    for (int i = 0; i < REPETITIONS; ++i)
+    {
+        quint64 before[AllocTracker::SubsystemCount];
+        for (int j = 0; j < AllocTracker::SubsystemCount; ++j)
+            before[j] = AllocTracker::count(static_cast<AllocTracker::Subsystem>(j));
+
+        QElapsedTimer timer;
+        timer.start();
+        run(iterations);
+        const auto elapsed = timer.nsecsElapsed();
+        samples.append(static_cast<double>(elapsed) / iterations);
+
+        for (int j = 0; j < AllocTracker::SubsystemCount; ++j)
+        {
+            auto subsystem = static_cast<AllocTracker::Subsystem>(j);
+            allocations[j] += AllocTracker::count(subsystem) - before[j];
+        }
+    }
+
+    std::sort(samples.begin(), samples.end());
+    const auto nsPerOp = samples.at(REPETITIONS / 2);
+    const auto operations = static_cast<double>(iterations) * REPETITIONS;
+
+    QJsonObject result;
+    result["name"] = name;
+    result["ns_per_op"] = nsPerOp;
+    result["ops_per_sec"] = nsPerOp > 0 ? 1e9 / nsPerOp : 0;
+
+    // Total allocations & allocations of each subsystem that allocated memory
+    quint64 total = 0;
+    for (int j = 0; j < AllocTracker::SubsystemCount; ++j)
+    {
+        total += allocations[j];
+        if (allocations[j] > 0)
+        {
+            auto subsystem = static_cast<AllocTracker::Subsystem>(j);
+            auto key = QString("allocs_%1_per_op").arg(AllocTracker::name(subsystem));
+            result[key] = allocations[j] / operations;
+        }
+    }
+
+    result["allocs_per_op"] = total / operations;
+    report(result);
+}
@@ -0,0 +1,83 @@
+/*
+ * Copyright (c) 2022 Alex Spataru <https://github.com/alex-spataru>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <QObject>
+#include <QJsonArray>
+#include <QJsonObject>
+
+#include <functional>
+
+#include "QJoysticks.h"
+#include "LoopbackDriver.h"
+
+/**
+ * @brief The Bench_Pipeline class
+ *
+ * Measures the cost of each stage of the joystick-to-serial pipeline: translation of
+ * SDL events, dispatch of @c QJoysticks events to the @c Bridge, cost of a signal
+ * subscriber compared to a @c QJoystickListener, frame encoding, framing & decoding
+ * of received telemetry lines, axis mixing, evaluation of output expressions & output
+ * shaping, as well as the end-to-end latency from a joystick event to the frame being
+ * received back through a @c LoopbackDriver.
+ *
+ * Every benchmark prints a single line with a stable format, e.g.
+ * "BENCH axis_dispatch ops_per_sec=... ns_per_op=... allocs_per_op=...", so that the
+ * output of two commits can be compared with diff-like tools. The same results are
+ * available as JSON through @c results().
+ */
+class Bench_Pipeline : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit Bench_Pipeline(QObject *parent = nullptr);
+
+    QJsonArray results() const;
+
+private Q_SLOTS:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void sdlTranslation();
+    void sdlToBridge();
+    void axisDispatch();
+    void subscriberDispatch();
+    void frameEncoding();
+    void lineFraming();
+    void telemetryParsing();
+    void outputMixing();
+    void expressionEvaluation();
+    void outputShaping();
+    void loopbackLatency();
+
+private:
+    void report(const QJsonObject &result);
+    void throughput(const QString &name, const int iterations,
+                    const std::function<void(int)> &run);
+
+private:
+    QJsonArray m_results;
+    LoopbackDriver m_loopback;
+    QJoystickDevice *m_device;
+};
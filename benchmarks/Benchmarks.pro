@@ -0,0 +1,54 @@
+#-------------------------------------------------------------------------------
+# Benchmarks del pipeline joystick -> serial
+#
+# Compilar en modo release para obtener resultados comparables:
+#   qmake CONFIG+=release && make && ./joystick2serial-benchmarks --json out.json
+#-------------------------------------------------------------------------------
+
+UI_DIR = uic
+MOC_DIR = moc
+RCC_DIR = qrc
+OBJECTS_DIR = obj
+
+CONFIG += c++11
+CONFIG += silent
+CONFIG += console
+CONFIG += utf8_source
+CONFIG += alloc_tracking
+CONFIG -= app_bundle
+
+TEMPLATE = app
+TARGET = joystick2serial-benchmarks
+
+QT += core
+QT += testlib
+
+REVISION = $$system(git -C $$PWD rev-parse --short HEAD)
+DEFINES += BENCH_REVISION=\\\"$$REVISION\\\"
+
+#-------------------------------------------------------------------------------
+# Archivos
+#-------------------------------------------------------------------------------
+
+include($$PWD/../lib/Libraries.pri)
+include($$PWD/../src/Core.pri)
+
+HEADERS += \
+    $$PWD/Bench_Evdev.h \
+    $$PWD/Bench_Pipeline.h \
+    $$PWD/EventInjector.h \
+    $$PWD/LoopbackDriver.h \
+    $$PWD/Stress_SDL.h \
+    $$PWD/UInputDevice.h
+
+SOURCES += \
+    $$PWD/Bench_Evdev.cpp \
+    $$PWD/Bench_Pipeline.cpp \
+    $$PWD/EventInjector.cpp \
+    $$PWD/LoopbackDriver.cpp \
+    $$PWD/Stress_SDL.cpp \
+    $$PWD/UInputDevice.cpp \
+    $$PWD/main.cpp
+
+RESOURCES += \
+    $$PWD/../res/Resources.qrc
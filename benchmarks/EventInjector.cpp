@@ -0,0 +1,218 @@
+/*
+ * Copyright (c) 2022 Alex Spataru <https://github.com/alex-spataru>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "EventInjector.h"
+
+#include <QJoysticks/SDL_Joysticks.h>
+
+#include <cstring>
+
+/**
+ * Number of axes & buttons used on each virtual device
+ */
+static const int AXES = 6;
+static const int BUTTONS = 16;
+
+/**
+ * Constructor function
+ */
+EventInjector::EventInjector(QObject *parent)
+    : QThread(parent)
+    , m_rate(0)
+    , m_duration(0)
+    , m_rejected(0)
+    , m_maxBacklog(0)
+    , m_accepted(0)
+    , m_delivered(0)
+{
+}
+
+/**
+ * Waits for the injection to finish
+ */
+EventInjector::~EventInjector()
+{
+    wait();
+}
+
+/**
+ * Returns the number of nanoseconds since the injection started
+ */
+qint64 EventInjector::elapsed() const
+{
+    return m_clock.nsecsElapsed();
+}
+
+/**
+ * Returns the number of events accepted by the SDL queue
+ */
+quint64 EventInjector::accepted() const
+{
+    return m_accepted.loadAcquire();
+}
+
+/**
+ * Returns the number of events rejected by the SDL queue (e.g. because it was full).
+ * Only valid once the injection has finished.
+ */
+quint64 EventInjector::rejected() const
+{
+    return m_rejected;
+}
+
+/**
+ * Returns the largest number of accepted events that were waiting to be delivered.
+ * Only valid once the injection has finished.
+ */
+quint64 EventInjector::maxBacklog() const
+{
+    return m_maxBacklog;
+}
+
+/**
+ * Returns the time (in nanoseconds since the injection started) at which the accepted
+ * event with the given @a index was pushed, or -1 if there is no such event.
+ */
+qint64 EventInjector::pushTime(const quint64 index) const
+{
+    if (index >= static_cast<quint64>(m_pushTimes.size()))
+        return -1;
+
+    return m_pushTimes.at(static_cast<int>(index));
+}
+
+/**
+ * Must be called by the consumer every time that an event is delivered
+ */
+void EventInjector::delivered()
+{
+    m_delivered.fetchAndAddRelease(1);
+}
+
+/**
+ * Returns the number of events delivered to the consumer
+ */
+quint64 EventInjector::deliveredCount() const
+{
+    return m_delivered.loadAcquire();
+}
+
+/**
+ * Starts pushing @a rate events per second to the given @a devices (SDL instance IDs)
+ * during @a duration milliseconds.
+ */
+void EventInjector::inject(const QVector<int> &devices, const int rate,
+                           const int duration)
+{
+    wait();
+
+    m_rate = rate;
+    m_devices = devices;
+    m_duration = duration;
+    m_rejected = 0;
+    m_maxBacklog = 0;
+    m_accepted.store(0);
+    m_delivered.store(0);
+
+    m_pushTimes.clear();
+    m_pushTimes.resize(static_cast<int>(qint64(rate) * duration / 1000) + 1);
+
+    m_clock.start();
+    start();
+}
+
+/**
+ * Pushes events as fast as needed to follow the configured rate, the thread sleeps
+ * for 100 µs whenever the injection is ahead of schedule.
+ */
+void EventInjector::run()
+{
+    quint64 sequence = 0;
+    const auto end = qint64(m_duration) * 1000 * 1000;
+    const auto capacity = static_cast<quint64>(m_pushTimes.size());
+
+    while (m_clock.nsecsElapsed() < end && !m_devices.isEmpty())
+    {
+        const auto now = m_clock.nsecsElapsed();
+        const auto due = static_cast<quint64>(now / 1000 * m_rate / 1000000);
+
+        while (sequence < due && m_accepted.loadRelaxed() < capacity)
+        {
+            if (!push(sequence++))
+                ++m_rejected;
+        }
+
+        const auto backlog = m_accepted.loadRelaxed() - m_delivered.loadAcquire();
+        m_maxBacklog = qMax(m_maxBacklog, backlog);
+
+        QThread::usleep(100);
+    }
+}
+
+/**
+ * Pushes the event with the given @a sequence number, the device & the type of the
+ * event are chosen in round-robin. Returns @c false if the SDL queue rejected it.
+ */
+bool EventInjector::push(const quint64 sequence)
+{
+#ifdef SDL_SUPPORTED
+    SDL_Event event;
+    memset(&event, 0, sizeof(event));
+
+    const auto device = m_devices.at(static_cast<int>(sequence % m_devices.count()));
+    const auto kind = (sequence / m_devices.count()) % 8;
+    if (kind < AXES)
+    {
+        event.type = SDL_JOYAXISMOTION;
+        event.jaxis.which = device;
+        event.jaxis.axis = static_cast<Uint8>(kind);
+        event.jaxis.value = static_cast<Sint16>((sequence * 2654435761u) & 0x7fff);
+    }
+    else if (kind == AXES)
+    {
+        const auto pressed = (sequence / 16) & 1;
+        event.type = pressed ? SDL_JOYBUTTONDOWN : SDL_JOYBUTTONUP;
+        event.jbutton.which = device;
+        event.jbutton.button = static_cast<Uint8>(sequence % BUTTONS);
+        event.jbutton.state = pressed ? SDL_PRESSED : SDL_RELEASED;
+    }
+    else
+    {
+        event.type = SDL_JOYHATMOTION;
+        event.jhat.which = device;
+        event.jhat.hat = 0;
+        event.jhat.value = static_cast<Uint8>(1 << (sequence % 4));
+    }
+
+    // Record the push time first, the event may be consumed before SDL_PushEvent returns
+    const auto index = m_accepted.loadRelaxed();
+    m_pushTimes[static_cast<int>(index)] = m_clock.nsecsElapsed();
+    if (SDL_PushEvent(&event) != 1)
+        return false;
+
+    m_accepted.storeRelease(index + 1);
+    return true;
+#else
+    Q_UNUSED(sequence);
+    return false;
+#endif
+}
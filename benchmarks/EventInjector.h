@@ -0,0 +1,79 @@
+/*
+ * Copyright (c) 2022 Alex Spataru <https://github.com/alex-spataru>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <QVector>
+#include <QThread>
+#include <QElapsedTimer>
+#include <QAtomicInteger>
+
+/**
+ * @brief The EventInjector class
+ *
+ * Pushes synthetic SDL joystick events (axis motion, button presses & hat motion) into
+ * the SDL event queue at a fixed rate, spread over a set of virtual devices. Events
+ * are consumed by the regular @c SDL_Joysticks polling loop, exactly like the events
+ * of a physical controller.
+ *
+ * The time at which each accepted event was pushed is recorded in a buffer that is
+ * allocated before the injection starts. Since the SDL queue is FIFO, the n-th event
+ * delivered by @c SDL_Joysticks corresponds to the n-th accepted event, which allows
+ * measuring the processing latency without modifying the events.
+ */
+class EventInjector : public QThread
+{
+    Q_OBJECT
+
+public:
+    explicit EventInjector(QObject *parent = nullptr);
+    ~EventInjector();
+
+    qint64 elapsed() const;
+    quint64 accepted() const;
+    quint64 rejected() const;
+    quint64 maxBacklog() const;
+    qint64 pushTime(const quint64 index) const;
+
+    void delivered();
+    quint64 deliveredCount() const;
+
+    void inject(const QVector<int> &devices, const int rate, const int duration);
+
+protected:
+    void run() override;
+
+private:
+    bool push(const quint64 sequence);
+
+private:
+    int m_rate;
+    int m_duration;
+    QVector<int> m_devices;
+    QVector<qint64> m_pushTimes;
+
+    QElapsedTimer m_clock;
+    quint64 m_rejected;
+    quint64 m_maxBacklog;
+    QAtomicInteger<quint64> m_accepted;
+    QAtomicInteger<quint64> m_delivered;
+};
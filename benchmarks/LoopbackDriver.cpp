@@ -0,0 +1,105 @@
+/*
+ * Copyright (c) 2022 Alex Spataru <https://github.com/alex-spataru>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "LoopbackDriver.h"
+
+/**
+ * Constructor function
+ */
+LoopbackDriver::LoopbackDriver(QObject *parent)
+    : m_open(0)
+    , m_writes(0)
+{
+    setParent(parent);
+}
+
+/**
+ * Returns the number of chunks written since the driver was created
+ */
+quint64 LoopbackDriver::writeCount() const
+{
+    return static_cast<quint64>(m_writes.load());
+}
+
+/**
+ * Stops looping back written data
+ */
+void LoopbackDriver::close()
+{
+    m_open.store(0);
+}
+
+/**
+ * Returns @c true if the driver is open
+ */
+bool LoopbackDriver::isOpen() const
+{
+    return m_open.load() != 0;
+}
+
+/**
+ * Returns @c true if the driver is open
+ */
+bool LoopbackDriver::isReadable() const
+{
+    return isOpen();
+}
+
+/**
+ * Returns @c true if the driver is open
+ */
+bool LoopbackDriver::isWritable() const
+{
+    return isOpen();
+}
+
+/**
+ * The loopback driver does not need any configuration
+ */
+bool LoopbackDriver::configurationOk() const
+{
+    return true;
+}
+
+/**
+ * Reports the given @a data as sent & received, returns the number of bytes written
+ */
+quint64 LoopbackDriver::write(const QByteArray &data)
+{
+    if (!isOpen())
+        return -1;
+
+    m_writes.fetchAndAddRelaxed(1);
+    Q_EMIT dataSent(data);
+    Q_EMIT dataReceived(data);
+    return data.size();
+}
+
+/**
+ * Starts looping back written data
+ */
+bool LoopbackDriver::open(const QIODevice::OpenMode mode)
+{
+    Q_UNUSED(mode);
+    m_open.store(1);
+    return true;
+}
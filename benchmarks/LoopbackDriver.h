@@ -0,0 +1,56 @@
+/*
+ * Copyright (c) 2022 Alex Spataru <https://github.com/alex-spataru>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <QAtomicInt>
+
+#include "HAL_Driver.h"
+
+/**
+ * @brief The LoopbackDriver class
+ *
+ * Driver that reports every written chunk as received data, as if the TX & RX lines of
+ * a serial adapter were connected. Used to measure the latency of the whole pipeline
+ * without any hardware. Writes may be done from any thread.
+ */
+class LoopbackDriver : public HAL_Driver
+{
+    Q_OBJECT
+
+public:
+    explicit LoopbackDriver(QObject *parent = nullptr);
+
+    quint64 writeCount() const;
+
+    void close() override;
+    bool isOpen() const override;
+    bool isReadable() const override;
+    bool isWritable() const override;
+    bool configurationOk() const override;
+    quint64 write(const QByteArray &data) override;
+    bool open(const QIODevice::OpenMode mode) override;
+
+private:
+    QAtomicInt m_open;
+    QAtomicInt m_writes;
+};
@@ -0,0 +1,282 @@
+/*
+ * Copyright (c) 2022 Alex Spataru <https://github.com/alex-spataru>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "Stress_SDL.h"
+
+#include <QTest>
+#include <QTimer>
+#include <QEventLoop>
+#include <QElapsedTimer>
+#include <QJoysticks/SDL_Joysticks.h>
+
+#include <algorithm>
+#include <cstdio>
+
+/**
+ * SDL instance ID of the first virtual device, far from the IDs of real devices
+ */
+static const int FIRST_INSTANCE_ID = 2000;
+
+/**
+ * Time given to the event loop to process the pending events after the injection
+ */
+static const int DRAIN_TIMEOUT = 2000;
+
+/**
+ * Returns the value at the given @a percentile of the sorted list of @a samples
+ */
+static qint64 percentile(const QVector<qint64> &samples, const double percentile)
+{
+    if (samples.isEmpty())
+        return 0;
+
+    auto index = static_cast<int>(percentile * (samples.count() - 1) + 0.5);
+    return samples.at(qBound(0, index, samples.count() - 1));
+}
+
+/**
+ * Constructor function, each load is applied during one second by default
+ */
+Stress_SDL::Stress_SDL(QObject *parent)
+    : QObject(parent)
+    , m_rate(0)
+    , m_devices(0)
+    , m_duration(1)
+    , m_invalid(0)
+{
+}
+
+/**
+ * Stops observing the events & removes the virtual devices that may still be registered
+ */
+Stress_SDL::~Stress_SDL()
+{
+    QJoysticks::getInstance()->removeListener(this);
+    cleanup();
+}
+
+/**
+ * Returns the results of the loads that have been applied
+ */
+QJsonArray Stress_SDL::results() const
+{
+    return m_results;
+}
+
+/**
+ * Changes the number of @a seconds during which each load is applied
+ */
+void Stress_SDL::setDuration(const int seconds)
+{
+    m_duration = qMax(1, seconds);
+}
+
+/**
+ * Replaces the default loads with a single load of @a rate events per second, spread
+ * over the given number of @a devices.
+ */
+void Stress_SDL::setLoad(const int rate, const int devices)
+{
+    m_rate = qMax(1, rate);
+    m_devices = qMax(1, devices);
+}
+
+/**
+ * Starts the SDL polling loop before injecting any event
+ */
+void Stress_SDL::initTestCase()
+{
+#ifndef SDL_SUPPORTED
+    QSKIP("QJoysticks was built without SDL");
+#endif
+
+    QVERIFY(QJoysticks::getInstance()->sdlJoysticks() != nullptr);
+    QTest::qWait(200);
+}
+
+/**
+ * Unregisters & deletes the virtual devices of the last load
+ */
+void Stress_SDL::cleanup()
+{
+    if (m_joysticks.isEmpty())
+        return;
+
+    auto sdl = QJoysticks::getInstance()->sdlJoysticks();
+    for (auto joystick : m_joysticks)
+        sdl->removeSimulatedDevice(joystick->instanceID);
+
+    m_joysticks.clear();
+}
+
+/**
+ * Loads applied by the test, the rate is given in events per second
+ */
+void Stress_SDL::flood_data()
+{
+    QTest::addColumn<int>("rate");
+    QTest::addColumn<int>("devices");
+
+    if (m_rate > 0)
+    {
+        QTest::newRow("custom") << m_rate << m_devices;
+        return;
+    }
+
+    QTest::newRow("1k") << 1000 << 1;
+    QTest::newRow("10k") << 10000 << 4;
+    QTest::newRow("100k") << 100000 << 16;
+    QTest::newRow("250k") << 250000 << 64;
+    QTest::newRow("500k") << 500000 << 128;
+}
+
+/**
+ * Injects events at the given rate & waits for them to be processed
+ */
+void Stress_SDL::flood()
+{
+    QFETCH(int, rate);
+    QFETCH(int, devices);
+
+    // Register the virtual devices
+    QVector<int> instanceIds;
+    auto joysticks = QJoysticks::getInstance();
+    for (int i = 0; i < devices; ++i)
+    {
+        auto joystick = new QJoystickDevice;
+        joystick->id = 0;
+        joystick->instanceID = FIRST_INSTANCE_ID + i;
+        joystick->name = QString("Virtual device %1").arg(i + 1);
+        joystick->blacklisted = false;
+        joystick->povs.append(0);
+        for (int j = 0; j < 6; ++j)
+            joystick->axes.append(0);
+        for (int j = 0; j < 16; ++j)
+            joystick->buttons.append(false);
+
+        m_joysticks.append(joystick);
+        instanceIds.append(joystick->instanceID);
+        joysticks->sdlJoysticks()->addSimulatedDevice(joystick);
+    }
+
+    // Preallocate the latency samples, so that measuring does not allocate memory
+    m_invalid = 0;
+    m_latencies.clear();
+    m_latencies.reserve(static_cast<int>(qint64(rate) * m_duration) + 1);
+
+    // Observe the events after every other listener (e.g. the Bridge)
+    joysticks->addListener(this);
+
+    // Inject the events
+    QEventLoop loop;
+    auto finished = connect(&m_injector, &QThread::finished, &loop, &QEventLoop::quit);
+    QTimer::singleShot(m_duration * 1000 + 10 * 1000, &loop, &QEventLoop::quit);
+    m_injector.inject(instanceIds, rate, m_duration * 1000);
+    loop.exec();
+    const auto elapsed = m_injector.elapsed();
+
+    // Let the polling loop process the remaining events
+    QElapsedTimer drain;
+    drain.start();
+    while (m_injector.deliveredCount() < m_injector.accepted()
+           && drain.elapsed() < DRAIN_TIMEOUT)
+        QTest::qWait(10);
+
+    disconnect(finished);
+    joysticks->removeListener(this);
+
+    QVERIFY(m_injector.isFinished());
+
+    // Report the results
+    const auto accepted = m_injector.accepted();
+    const auto rejected = m_injector.rejected();
+    const auto delivered = m_injector.deliveredCount();
+    const auto lost = accepted > delivered ? accepted - delivered : 0;
+    const auto pushed = accepted + rejected;
+
+    std::sort(m_latencies.begin(), m_latencies.end());
+    QJsonObject result;
+    result["name"] = QString("sdl_stress_%1").arg(QTest::currentDataTag());
+    result["rate"] = rate;
+    result["devices"] = devices;
+    result["events_per_sec"] = delivered * 1e9 / elapsed;
+    result["dropped"] = static_cast<double>(rejected + lost);
+    result["drop_ratio"] = pushed > 0 ? static_cast<double>(rejected + lost) / pushed : 0;
+    result["max_backlog"] = static_cast<double>(m_injector.maxBacklog());
+    result["p50_us"] = percentile(m_latencies, 0.50) / 1000.0;
+    result["p99_us"] = percentile(m_latencies, 0.99) / 1000.0;
+    result["max_us"] = percentile(m_latencies, 1.00) / 1000.0;
+    report(result);
+
+    QVERIFY(delivered > 0);
+    QCOMPARE(m_invalid, quint64(0));
+}
+
+/**
+ * Measures the latency of each event of the delivered batch of @a events
+ */
+void Stress_SDL::joystickEvents(const QJoystickEvent *events, const int count)
+{
+    for (int i = 0; i < count; ++i)
+    {
+        const auto &event = events[i];
+        if (event.type == QJoystickEvent::AxisEvent)
+            onEvent(event.axis.joystick);
+        else if (event.type == QJoystickEvent::ButtonEvent)
+            onEvent(event.button.joystick);
+        else
+            onEvent(event.pov.joystick);
+    }
+}
+
+/**
+ * Measures the latency of a delivered event, the SDL queue is FIFO so the n-th
+ * delivered event is the n-th event accepted by the queue.
+ */
+void Stress_SDL::onEvent(const QJoystickDevice *joystick)
+{
+    if (!joystick)
+        ++m_invalid;
+
+    const auto pushTime = m_injector.pushTime(m_injector.deliveredCount());
+    if (pushTime >= 0 && m_latencies.count() < m_latencies.capacity())
+        m_latencies.append(m_injector.elapsed() - pushTime);
+
+    m_injector.delivered();
+}
+
+/**
+ * Prints the given @a result in a single line & stores it in the JSON results
+ */
+void Stress_SDL::report(const QJsonObject &result)
+{
+    QString line = "BENCH " + result.value("name").toString();
+    for (auto it = result.constBegin(); it != result.constEnd(); ++it)
+    {
+        if (it.key() != "name")
+            line += QString(" %1=%2").arg(it.key()).arg(it.value().toDouble(), 0, 'f', 3);
+    }
+
+    fprintf(stdout, "%s\n", qPrintable(line));
+    fflush(stdout);
+    m_results.append(result);
+}
@@ -0,0 +1,82 @@
+/*
+ * Copyright (c) 2022 Alex Spataru <https://github.com/alex-spataru>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <QObject>
+#include <QVector>
+#include <QJsonArray>
+#include <QJsonObject>
+
+#include "QJoysticks.h"
+#include "EventInjector.h"
+
+/**
+ * @brief The Stress_SDL class
+ *
+ * Floods the SDL event queue with synthetic joystick events coming from many virtual
+ * devices, while the regular @c SDL_Joysticks polling loop, @c QJoysticks & the
+ * @c Bridge process them. No physical controller is needed, so the test can run on a
+ * headless CI machine.
+ *
+ * For each load, the test reports the delivered event rate, the events dropped by the
+ * SDL queue or lost on the way, the largest backlog of pending events and the
+ * percentiles of the processing latency (from @c SDL_PushEvent() until the event has
+ * gone through @c QJoysticks & every listener registered before the test).
+ */
+class Stress_SDL : public QObject, private QJoystickListener
+{
+    Q_OBJECT
+
+public:
+    explicit Stress_SDL(QObject *parent = nullptr);
+    ~Stress_SDL();
+
+    QJsonArray results() const;
+
+    void setDuration(const int seconds);
+    void setLoad(const int rate, const int devices);
+
+private Q_SLOTS:
+    void initTestCase();
+    void cleanup();
+
+    void flood_data();
+    void flood();
+
+private:
+    void joystickEvents(const QJoystickEvent *events, const int count) override;
+    void onEvent(const QJoystickDevice *joystick);
+    void report(const QJsonObject &result);
+
+private:
+    int m_rate;
+    int m_devices;
+    int m_duration;
+
+    quint64 m_invalid;
+    QVector<qint64> m_latencies;
+
+    QJsonArray m_results;
+    EventInjector m_injector;
+    QVector<QJoystickDevice *> m_joysticks;
+};
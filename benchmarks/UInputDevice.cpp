@@ -0,0 +1,188 @@
+/*
+ * Copyright (c) 2022 Alex Spataru <https://github.com/alex-spataru>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "UInputDevice.h"
+
+#ifdef Q_OS_LINUX
+#    include <errno.h>
+#    include <fcntl.h>
+#    include <string.h>
+#    include <unistd.h>
+#    include <sys/ioctl.h>
+#    include <linux/uinput.h>
+
+/**
+ * Evdev codes of the axes & buttons of the gamepad, in the order of the enums
+ */
+static const int AXES[] = { ABS_X, ABS_Y, ABS_RX, ABS_RY };
+static const int BUTTONS[] = { BTN_SOUTH, BTN_EAST, BTN_NORTH, BTN_WEST };
+#endif
+
+/**
+ * Constructor function, the device is not created until @c create() is called
+ */
+UInputDevice::UInputDevice()
+    : m_fd(-1)
+{
+}
+
+/**
+ * Removes the device from the system
+ */
+UInputDevice::~UInputDevice()
+{
+    destroy();
+}
+
+/**
+ * Returns @c true if the device exists
+ */
+bool UInputDevice::isCreated() const
+{
+    return m_fd >= 0;
+}
+
+/**
+ * Creates the gamepad with the given @a name. Returns @c false and sets @a error if
+ * uinput is not available or cannot be opened.
+ */
+bool UInputDevice::create(const QString &name, QString *error)
+{
+    destroy();
+
+#ifdef Q_OS_LINUX
+    m_fd = ::open("/dev/uinput", O_WRONLY | O_NONBLOCK | O_CLOEXEC);
+    if (m_fd < 0)
+    {
+        if (error)
+            *error = QString("cannot open /dev/uinput: %1").arg(strerror(errno));
+
+        return false;
+    }
+
+    struct uinput_user_dev device;
+    memset(&device, 0, sizeof(device));
+    strncpy(device.name, name.toUtf8().constData(), UINPUT_MAX_NAME_SIZE - 1);
+    device.id.bustype = BUS_VIRTUAL;
+    device.id.vendor = 0x1209;
+    device.id.product = 0x0001;
+    device.id.version = 1;
+
+    bool ok = ioctl(m_fd, UI_SET_EVBIT, EV_KEY) >= 0;
+    ok = ok && ioctl(m_fd, UI_SET_EVBIT, EV_ABS) >= 0;
+    for (const auto axis : AXES)
+    {
+        ok = ok && ioctl(m_fd, UI_SET_ABSBIT, axis) >= 0;
+        device.absmin[axis] = -32767;
+        device.absmax[axis] = 32767;
+    }
+
+    for (const auto button : BUTTONS)
+        ok = ok && ioctl(m_fd, UI_SET_KEYBIT, button) >= 0;
+
+    ok = ok && ::write(m_fd, &device, sizeof(device)) == sizeof(device);
+    ok = ok && ioctl(m_fd, UI_DEV_CREATE) >= 0;
+    if (!ok)
+    {
+        if (error)
+            *error = QString("cannot create the uinput device: %1").arg(strerror(errno));
+
+        ::close(m_fd);
+        m_fd = -1;
+    }
+
+    return ok;
+#else
+    Q_UNUSED(name);
+    if (error)
+        *error = "uinput is only available on Linux";
+
+    return false;
+#endif
+}
+
+/**
+ * Removes the device from the system, if it has been created
+ */
+void UInputDevice::destroy()
+{
+#ifdef Q_OS_LINUX
+    if (m_fd < 0)
+        return;
+
+    ioctl(m_fd, UI_DEV_DESTROY);
+    ::close(m_fd);
+    m_fd = -1;
+#endif
+}
+
+/**
+ * Moves the given @a axis & terminates the input report
+ */
+bool UInputDevice::setAxis(const Axis axis, const int value)
+{
+#ifdef Q_OS_LINUX
+    return write(EV_ABS, AXES[axis], value) && write(EV_SYN, SYN_REPORT, 0);
+#else
+    Q_UNUSED(axis);
+    Q_UNUSED(value);
+    return false;
+#endif
+}
+
+/**
+ * Presses or releases the given @a button & terminates the input report
+ */
+bool UInputDevice::setButton(const Button button, const bool pressed)
+{
+#ifdef Q_OS_LINUX
+    const auto value = pressed ? 1 : 0;
+    return write(EV_KEY, BUTTONS[button], value) && write(EV_SYN, SYN_REPORT, 0);
+#else
+    Q_UNUSED(button);
+    Q_UNUSED(pressed);
+    return false;
+#endif
+}
+
+/**
+ * Writes a single input event to the device, the kernel sets its timestamp
+ */
+bool UInputDevice::write(const int type, const int code, const int value)
+{
+#ifdef Q_OS_LINUX
+    if (m_fd < 0)
+        return false;
+
+    struct input_event event;
+    memset(&event, 0, sizeof(event));
+    event.type = type;
+    event.code = code;
+    event.value = value;
+    return ::write(m_fd, &event, sizeof(event)) == sizeof(event);
+#else
+    Q_UNUSED(type);
+    Q_UNUSED(code);
+    Q_UNUSED(value);
+    return false;
+#endif
+}
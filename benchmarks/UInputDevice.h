@@ -0,0 +1,72 @@
+/*
+ * Copyright (c) 2022 Alex Spataru <https://github.com/alex-spataru>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <QString>
+
+/**
+ * @brief The UInputDevice class
+ *
+ * Creates a virtual gamepad with the Linux uinput module, so that the input systems can
+ * be measured with real kernel events and without a physical controller. The gamepad
+ * has two sticks (ABS_X/ABS_Y & ABS_RX/ABS_RY, from -32767 to 32767) and four buttons
+ * (BTN_SOUTH, BTN_EAST, BTN_NORTH & BTN_WEST).
+ *
+ * Creating the device needs write access to /dev/uinput, on other operating systems
+ * @c create() always fails.
+ */
+class UInputDevice
+{
+public:
+    enum Axis
+    {
+        LeftX,
+        LeftY,
+        RightX,
+        RightY
+    };
+
+    enum Button
+    {
+        South,
+        East,
+        North,
+        West
+    };
+
+    UInputDevice();
+    ~UInputDevice();
+
+    bool isCreated() const;
+    bool create(const QString &name, QString *error = nullptr);
+    void destroy();
+
+    bool setAxis(const Axis axis, const int value);
+    bool setButton(const Button button, const bool pressed);
+
+private:
+    bool write(const int type, const int code, const int value);
+
+private:
+    int m_fd;
+};
@@ -0,0 +1,134 @@
+/*
+ * Copyright (c) 2022 Alex Spataru <https://github.com/alex-spataru>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <QFile>
+#include <QTest>
+#include <QJsonDocument>
+#include <QCoreApplication>
+
+#include <cstdio>
+
+#include "Stress_SDL.h"
+#include "Bench_Evdev.h"
+#include "Bench_Pipeline.h"
+
+#ifndef BENCH_REVISION
+#    define BENCH_REVISION "unknown"
+#endif
+
+/**
+ * Removes the option with the given @a name & its value from the @a arguments,
+ * returns the value of the option (or an empty string if it was not given).
+ */
+static QString takeOption(QStringList &arguments, const QString &name)
+{
+    QString value;
+    auto index = arguments.indexOf(name);
+    if (index > 0 && index + 1 < arguments.count())
+    {
+        value = arguments.at(index + 1);
+        arguments.removeAt(index + 1);
+        arguments.removeAt(index);
+    }
+
+    return value;
+}
+
+/**
+ * Runs the benchmarks, the results are also written to the JSON file given with
+ * "--json <file>". Any other argument is handled by QtTest (e.g. the name of the
+ * benchmarks to run).
+ *
+ * With "--stress", the SDL event stress test is run instead. The default loads can be
+ * replaced with "--rate <events/s>" & "--devices <n>", and each load lasts for the
+ * number of seconds given with "--duration <sec>".
+ *
+ * With "--evdev", the input latency of SDL & evdev is compared with a virtual uinput
+ * gamepad, taking the number of samples given with "--samples <n>".
+ */
+int main(int argc, char **argv)
+{
+    QCoreApplication app(argc, argv);
+    app.setApplicationName("Joystick2Serial Benchmarks");
+
+    // Extract our own options from the arguments
+    auto arguments = app.arguments();
+    const auto output = takeOption(arguments, "--json");
+    const auto rate = takeOption(arguments, "--rate");
+    const auto devices = takeOption(arguments, "--devices");
+    const auto duration = takeOption(arguments, "--duration");
+    const auto samples = takeOption(arguments, "--samples");
+    const auto stress = arguments.removeAll("--stress") > 0;
+    const auto evdev = arguments.removeAll("--evdev") > 0;
+
+    // Run benchmarks, stress test or input latency comparison
+    QJsonArray results;
+    int status = EXIT_SUCCESS;
+    fprintf(stdout, "BENCH revision=%s qt=%s\n", BENCH_REVISION, qVersion());
+    if (stress)
+    {
+        Stress_SDL test;
+        if (!duration.isEmpty())
+            test.setDuration(duration.toInt());
+        if (!rate.isEmpty())
+            test.setLoad(rate.toInt(), devices.isEmpty() ? 1 : devices.toInt());
+
+        status = QTest::qExec(&test, arguments);
+        results = test.results();
+    }
+    else if (evdev)
+    {
+        Bench_Evdev test;
+        if (!samples.isEmpty())
+            test.setSamples(samples.toInt());
+
+        status = QTest::qExec(&test, arguments);
+        results = test.results();
+    }
+    else
+    {
+        Bench_Pipeline bench;
+        status = QTest::qExec(&bench, arguments);
+        results = bench.results();
+    }
+
+    // Write results
+    if (!output.isEmpty())
+    {
+        QJsonObject document;
+        document["revision"] = BENCH_REVISION;
+        document["qt"] = qVersion();
+        document["results"] = results;
+
+        QFile file(output);
+        if (!file.open(QFile::WriteOnly | QFile::Truncate))
+        {
+            fprintf(stderr, "Cannot write %s\n", qPrintable(output));
+            return EXIT_FAILURE;
+        }
+
+        file.write(QJsonDocument(document).toJson());
+        file.close();
+    }
+
+    return status;
+}
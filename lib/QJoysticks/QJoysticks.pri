@@ -23,7 +23,6 @@ include ($$PWD/lib/SDL/SDL.pri)
 
 QT += gui
 QT += core
-QT += widgets
 
 INCLUDEPATH += $$PWD/src
 
@@ -31,12 +30,14 @@ HEADERS += \
     $$PWD/src/QJoysticks.h \
     $$PWD/src/QJoysticks/JoysticksCommon.h \
     $$PWD/src/QJoysticks/SDL_Joysticks.h \
+    $$PWD/src/QJoysticks/Evdev_Joysticks.h \
     $$PWD/src/QJoysticks/VirtualJoystick.h \
     $$PWD/src/QJoysticks/Android_Joystick.h
 
 SOURCES += \
     $$PWD/src/QJoysticks.cpp \
     $$PWD/src/QJoysticks/SDL_Joysticks.cpp \
+    $$PWD/src/QJoysticks/Evdev_Joysticks.cpp \
     $$PWD/src/QJoysticks/VirtualJoystick.cpp \
     $$PWD/src/QJoysticks/Android_Joystick.cpp
 
@@ -22,22 +22,27 @@
 
 #include <QDebug>
 #include <QSettings>
+#include <QCoreApplication>
 #include <QJoysticks.h>
 #include <QJoysticks/SDL_Joysticks.h>
+#include <QJoysticks/Evdev_Joysticks.h>
 #include <QJoysticks/VirtualJoystick.h>
 
 QJoysticks::QJoysticks()
 {
    /* Initialize input methods */
    m_sdlJoysticks = new SDL_Joysticks(this);
+   m_evdevJoysticks = new Evdev_Joysticks(this);
    m_virtualJoystick = new VirtualJoystick(this);
 
-   /* Configure SDL joysticks */
-   connect(sdlJoysticks(), &SDL_Joysticks::POVEvent, this, &QJoysticks::POVEvent);
-   connect(sdlJoysticks(), &SDL_Joysticks::axisEvent, this, &QJoysticks::axisEvent);
-   connect(sdlJoysticks(), &SDL_Joysticks::buttonEvent, this, &QJoysticks::buttonEvent);
+   /* Configure SDL joysticks, their events are delivered as batches */
+   sdlJoysticks()->setListener(this);
    connect(sdlJoysticks(), &SDL_Joysticks::countChanged, this, &QJoysticks::updateInterfaces);
 
+   /* Configure evdev joysticks, their events are delivered as batches */
+   evdevJoysticks()->setListener(this);
+   connect(evdevJoysticks(), &Evdev_Joysticks::countChanged, this, &QJoysticks::updateInterfaces);
+
    /* Configure virtual joysticks */
    connect(virtualJoystick(), &VirtualJoystick::povEvent, this, &QJoysticks::POVEvent);
    connect(virtualJoystick(), &VirtualJoystick::axisEvent, this, &QJoysticks::axisEvent);
@@ -51,6 +56,7 @@ QJoysticks::QJoysticks()
 
    /* Configure the settings */
    m_sortJoyticks = 0;
+   m_dispatching = false;
    m_settings = new QSettings(qApp->organizationName(), qApp->applicationName());
    m_settings->beginGroup("Blacklisted Joysticks");
 }
@@ -59,6 +65,7 @@ QJoysticks::~QJoysticks()
 {
    delete m_settings;
    delete m_sdlJoysticks;
+   delete m_evdevJoysticks;
    delete m_virtualJoystick;
 }
 
@@ -220,6 +227,15 @@ SDL_Joysticks *QJoysticks::sdlJoysticks() const
    return m_sdlJoysticks;
 }
 
+/**
+ * Returns a pointer to the evdev joysticks system, which reads the joysticks
+ * directly from the Linux kernel when enabled.
+ */
+Evdev_Joysticks *QJoysticks::evdevJoysticks() const
+{
+   return m_evdevJoysticks;
+}
+
 /**
  * Returns a pointer to the virtual joystick system.
  * This can be used if you need to get more information regarding the virtual
@@ -254,6 +270,61 @@ QList<QJoystickDevice *> QJoysticks::inputDevices() const
    return m_devices;
 }
 
+/**
+ * Registers a \a device that is not managed by any of the built-in input
+ * systems (e.g. a recorded joystick that is being replayed). External devices
+ * are listed after the SDL (or evdev) joysticks and before the virtual joystick.
+ *
+ * To generate input, connect the signals of the external input system to the
+ * \c axisEvent(), \c buttonEvent() and \c POVEvent() signals of this class.
+ *
+ * \note The caller keeps the ownership of the \a device
+ */
+void QJoysticks::registerDevice(QJoystickDevice *device)
+{
+   Q_ASSERT(device);
+
+   if (!m_externalDevices.contains(device))
+   {
+      m_externalDevices.append(device);
+      updateInterfaces();
+   }
+}
+
+/**
+ * Removes a \a device registered with \c registerDevice()
+ */
+void QJoysticks::unregisterDevice(QJoystickDevice *device)
+{
+   if (m_externalDevices.removeAll(device) > 0)
+      updateInterfaces();
+}
+
+/**
+ * Registers a \a listener that is called with every batch of joystick events,
+ * after the joystick values have been updated and before the \c axisEvent(),
+ * \c buttonEvent() and \c POVEvent() signals are emitted. Listeners receive
+ * the events of blacklisted joysticks too, like these signals.
+ *
+ * \note Listeners are called from the thread of this object, and must be
+ *       removed with \c removeListener() before they are destroyed
+ */
+void QJoysticks::addListener(QJoystickListener *listener)
+{
+   Q_ASSERT(listener);
+
+   if (!m_listeners.contains(listener))
+      m_listeners.append(listener);
+}
+
+/**
+ * Removes a \a listener registered with \c addListener()
+ */
+void QJoysticks::removeListener(QJoystickListener *listener)
+{
+   m_listeners.removeAll(listener);
+}
+
 /**
  * If \a sort is set to true, then the device list will put all blacklisted
  * joysticks at the end of the list
@@ -320,6 +391,28 @@ void QJoysticks::updateInterfaces()
             addInputDevice(joystick);
       }
 
+      /* Register non-blacklisted evdev joysticks */
+      foreach (QJoystickDevice *joystick, evdevJoysticks()->joysticks())
+      {
+         joystick->blacklisted = m_settings->value(joystick->name, false).toBool();
+         if (!joystick->blacklisted)
+         {
+            addInputDevice(joystick);
+            joystick->id = inputDevices().count() - 1;
+         }
+      }
+
+      /* Register non-blacklisted external joysticks */
+      foreach (QJoystickDevice *joystick, m_externalDevices)
+      {
+         joystick->blacklisted = m_settings->value(joystick->name, false).toBool();
+         if (!joystick->blacklisted)
+         {
+            addInputDevice(joystick);
+            joystick->id = inputDevices().count() - 1;
+         }
+      }
+
       /* Register the virtual joystick (if its not blacklisted) */
       if (virtualJoystick()->joystickEnabled())
       {
@@ -341,6 +434,28 @@ void QJoysticks::updateInterfaces()
             addInputDevice(joystick);
       }
 
+      /* Register blacklisted evdev joysticks */
+      foreach (QJoystickDevice *joystick, evdevJoysticks()->joysticks())
+      {
+         joystick->blacklisted = m_settings->value(joystick->name, false).toBool();
+         if (joystick->blacklisted)
+         {
+            addInputDevice(joystick);
+            joystick->id = inputDevices().count() - 1;
+         }
+      }
+
+      /* Register blacklisted external joysticks */
+      foreach (QJoystickDevice *joystick, m_externalDevices)
+      {
+         joystick->blacklisted = m_settings->value(joystick->name, false).toBool();
+         if (joystick->blacklisted)
+         {
+            addInputDevice(joystick);
+            joystick->id = inputDevices().count() - 1;
+         }
+      }
+
       /* Register the virtual joystick (if its blacklisted) */
       if (virtualJoystick()->joystickEnabled())
       {
@@ -365,6 +480,22 @@ void QJoysticks::updateInterfaces()
          joystick->blacklisted = m_settings->value(joystick->name, false).toBool();
       }
 
+      /* Register evdev joysticks */
+      foreach (QJoystickDevice *joystick, evdevJoysticks()->joysticks())
+      {
+         addInputDevice(joystick);
+         joystick->id = inputDevices().count() - 1;
+         joystick->blacklisted = m_settings->value(joystick->name, false).toBool();
+      }
+
+      /* Register external joysticks */
+      foreach (QJoystickDevice *joystick, m_externalDevices)
+      {
+         addInputDevice(joystick);
+         joystick->id = inputDevices().count() - 1;
+         joystick->blacklisted = m_settings->value(joystick->name, false).toBool();
+      }
+
       /* Register virtual joystick */
       if (virtualJoystick()->joystickEnabled())
       {
@@ -379,6 +510,31 @@ void QJoysticks::updateInterfaces()
    emit countChanged();
 }
 
+/**
+ * Reads the joysticks directly from the Linux input subsystem (evdev) instead
+ * of through SDL if \a enabled is \c true. The SDL joysticks are removed
+ * while evdev is enabled, so that each device is only registered once.
+ *
+ * \note This function does nothing on other operating systems
+ */
+void QJoysticks::setEvdevEnabled(bool enabled)
+{
+   if (!Evdev_Joysticks::isSupported())
+      return;
+
+   if (enabled)
+   {
+      sdlJoysticks()->setEnabled(false);
+      evdevJoysticks()->setEnabled(true);
+   }
+
+   else
+   {
+      evdevJoysticks()->setEnabled(false);
+      sdlJoysticks()->setEnabled(true);
+   }
+}
+
 /**
  * Changes the axis value range of the virtual joystick.
  *
@@ -422,58 +578,153 @@ void QJoysticks::addInputDevice(QJoystickDevice *device)
 }
 
 /**
- * Configures the QML-friendly signal based on the information given by the
- * \a event data and updates the joystick values
+ * Updates the joystick values with the given batch of \a events, calls the
+ * listeners and emits the signals of each event. This function is called
+ * directly by the SDL and evdev input systems.
+ *
+ * The signals of each kind of event are only emitted if they are connected to
+ * something else than the slots of this object, so that the events are not
+ * dispatched one by one when every receiver is a listener.
  */
-void QJoysticks::onPOVEvent(const QJoystickPOVEvent &e)
+void QJoysticks::joystickEvents(const QJoystickEvent *events, const int count)
 {
-   if (e.joystick == nullptr)
+   for (int i = 0; i < count; ++i)
+      applyEvent(events[i]);
+
+   notifyListeners(events, count);
+
+   const bool axes = receivers(SIGNAL(axisEvent(QJoystickAxisEvent))) > 1;
+   const bool buttons = receivers(SIGNAL(buttonEvent(QJoystickButtonEvent))) > 1;
+   const bool povs = receivers(SIGNAL(POVEvent(QJoystickPOVEvent))) > 1;
+   if (!axes && !buttons && !povs)
       return;
 
-   if (!isBlacklisted(e.joystick->id))
+   /* The events have already been applied, see onAxisEvent() */
+   const bool dispatching = m_dispatching;
+   m_dispatching = true;
+   for (int i = 0; i < count; ++i)
    {
-      if (e.pov < getInputDevice(e.joystick->id)->povs.count())
-      {
-         getInputDevice(e.joystick->id)->povs[e.pov] = e.angle;
-         emit povChanged(e.joystick->id, e.pov, e.angle);
-      }
+      const QJoystickEvent &event = events[i];
+      if (event.type == QJoystickEvent::AxisEvent && axes)
+         emit axisEvent(event.axis);
+      else if (event.type == QJoystickEvent::ButtonEvent && buttons)
+         emit buttonEvent(event.button);
+      else if (event.type == QJoystickEvent::POVEvent && povs)
+         emit POVEvent(event.pov);
    }
+   m_dispatching = dispatching;
 }
 
 /**
- * Configures the QML-friendly signal based on the information given by the
- * \a event data and updates the joystick values
+ * Calls every registered listener with the given batch of \a events
  */
-void QJoysticks::onAxisEvent(const QJoystickAxisEvent &e)
+void QJoysticks::notifyListeners(const QJoystickEvent *events, const int count)
 {
-   if (e.joystick == nullptr)
+   if (m_listeners.isEmpty() || count <= 0)
       return;
 
-   if (!isBlacklisted(e.joystick->id))
+   /* Iterate over a copy, a listener may remove itself */
+   const QVector<QJoystickListener *> listeners = m_listeners;
+   for (int i = 0; i < listeners.count(); ++i)
+      listeners.at(i)->joystickEvents(events, count);
+}
+
+/**
+ * Updates the joystick values with the given \a event and emits the
+ * QML-friendly signal, unless the joystick is blacklisted
+ */
+void QJoysticks::applyEvent(const QJoystickEvent &event)
+{
+   if (event.type == QJoystickEvent::AxisEvent)
    {
+      const QJoystickAxisEvent &e = event.axis;
+      if (e.joystick == nullptr || isBlacklisted(e.joystick->id))
+         return;
+
       if (e.axis < getInputDevice(e.joystick->id)->axes.count())
       {
          getInputDevice(e.joystick->id)->axes[e.axis] = e.value;
          emit axisChanged(e.joystick->id, e.axis, e.value);
       }
    }
-}
-
-/**
- * Configures the QML-friendly signal based on the information given by the
- * \a event data and updates the joystick values
- */
-void QJoysticks::onButtonEvent(const QJoystickButtonEvent &e)
-{
-   if (e.joystick == nullptr)
-      return;
 
-   if (!isBlacklisted(e.joystick->id))
+   else if (event.type == QJoystickEvent::ButtonEvent)
    {
+      const QJoystickButtonEvent &e = event.button;
+      if (e.joystick == nullptr || isBlacklisted(e.joystick->id))
+         return;
+
       if (e.button < getInputDevice(e.joystick->id)->buttons.count())
       {
          getInputDevice(e.joystick->id)->buttons[e.button] = e.pressed;
          emit buttonChanged(e.joystick->id, e.button, e.pressed);
       }
    }
+
+   else
+   {
+      const QJoystickPOVEvent &e = event.pov;
+      if (e.joystick == nullptr || isBlacklisted(e.joystick->id))
+         return;
+
+      if (e.pov < getInputDevice(e.joystick->id)->povs.count())
+      {
+         getInputDevice(e.joystick->id)->povs[e.pov] = e.angle;
+         emit povChanged(e.joystick->id, e.pov, e.angle);
+      }
+   }
+}
+
+/**
+ * Updates the joystick values with an \a e event emitted by another input
+ * system (e.g. the virtual joystick) and calls the listeners
+ */
+void QJoysticks::onPOVEvent(const QJoystickPOVEvent &e)
+{
+   if (m_dispatching)
+      return;
+
+   QJoystickEvent event;
+   event.type = QJoystickEvent::POVEvent;
+   event.pov = e;
+   event.timestamp = QJoystickEvent::currentTime();
+
+   applyEvent(event);
+   notifyListeners(&event, 1);
+}
+
+/**
+ * Updates the joystick values with an \a e event emitted by another input
+ * system (e.g. the virtual joystick) and calls the listeners
+ */
+void QJoysticks::onAxisEvent(const QJoystickAxisEvent &e)
+{
+   if (m_dispatching)
+      return;
+
+   QJoystickEvent event;
+   event.type = QJoystickEvent::AxisEvent;
+   event.axis = e;
+   event.timestamp = QJoystickEvent::currentTime();
+
+   applyEvent(event);
+   notifyListeners(&event, 1);
+}
+
+/**
+ * Updates the joystick values with an \a e event emitted by another input
+ * system (e.g. the virtual joystick) and calls the listeners
+ */
+void QJoysticks::onButtonEvent(const QJoystickButtonEvent &e)
+{
+   if (m_dispatching)
+      return;
+
+   QJoystickEvent event;
+   event.type = QJoystickEvent::ButtonEvent;
+   event.button = e;
+   event.timestamp = QJoystickEvent::currentTime();
+
+   applyEvent(event);
+   notifyListeners(&event, 1);
 }
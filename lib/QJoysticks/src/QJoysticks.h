@@ -24,11 +24,13 @@
 #define _QJOYSTICKS_MAIN_H
 
 #include <QObject>
+#include <QVector>
 #include <QStringList>
 #include <QJoysticks/JoysticksCommon.h>
 
 class QSettings;
 class SDL_Joysticks;
+class Evdev_Joysticks;
 class VirtualJoystick;
 
 /**
@@ -45,10 +47,18 @@ class VirtualJoystick;
  * has been connected to the computer will have \c 0 as an ID, the second
  * joystick will have \c 1 as an ID, and so on...
  *
+ * On Linux, the joysticks can be read directly from the kernel (evdev) instead
+ * of through SDL, see \c setEvdevEnabled().
+ *
+ * The input events are available through the signals of this class, and as
+ * batches through the listeners registered with \c addListener(). Listeners
+ * are called directly by the input systems, which avoids the cost of the
+ * signal dispatch for every event.
+ *
  * \note the virtual joystick will ALWAYS be the last joystick to be registered,
  *       even if it has been enabled before any SDL joystick has been attached.
  */
-class QJoysticks : public QObject
+class QJoysticks : public QObject, private QJoystickListener
 {
    Q_OBJECT
    Q_PROPERTY(int count READ count NOTIFY countChanged)
@@ -86,12 +96,20 @@ public:
    Q_INVOKABLE QString getName(const int index);
 
    SDL_Joysticks *sdlJoysticks() const;
+   Evdev_Joysticks *evdevJoysticks() const;
    VirtualJoystick *virtualJoystick() const;
    QJoystickDevice *getInputDevice(const int index);
    QList<QJoystickDevice *> inputDevices() const;
 
+   void registerDevice(QJoystickDevice *device);
+   void unregisterDevice(QJoystickDevice *device);
+
+   void addListener(QJoystickListener *listener);
+   void removeListener(QJoystickListener *listener);
+
 public slots:
    void updateInterfaces();
+   void setEvdevEnabled(bool enabled);
    void setVirtualJoystickRange(qreal range);
    void setVirtualJoystickEnabled(bool enabled);
    void setVirtualJoystickAxisSensibility(qreal sensibility);
@@ -110,13 +128,21 @@ private slots:
    void onButtonEvent(const QJoystickButtonEvent &e);
 
 private:
+   void applyEvent(const QJoystickEvent &event);
+   void notifyListeners(const QJoystickEvent *events, const int count);
+   void joystickEvents(const QJoystickEvent *events, const int count) Q_DECL_OVERRIDE;
+
    bool m_sortJoyticks;
+   bool m_dispatching;
 
    QSettings *m_settings;
    SDL_Joysticks *m_sdlJoysticks;
+   Evdev_Joysticks *m_evdevJoysticks;
    VirtualJoystick *m_virtualJoystick;
 
    QList<QJoystickDevice *> m_devices;
+   QList<QJoystickDevice *> m_externalDevices;
+   QVector<QJoystickListener *> m_listeners;
 };
 
 #endif
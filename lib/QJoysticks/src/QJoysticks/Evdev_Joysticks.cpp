@@ -0,0 +1,954 @@
+/*
+ * Copyright (c) 2015-2017 Alex Spataru <alex_spataru@outlook.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <QDir>
+#include <QFile>
+#include <QDebug>
+#include <QThread>
+#include <QJoysticks/Evdev_Joysticks.h>
+
+#include <algorithm>
+
+#if defined Q_OS_LINUX && !defined Q_OS_ANDROID
+#   define EVDEV_SUPPORTED
+#   include <time.h>
+#   include <errno.h>
+#   include <string.h>
+#   include <fcntl.h>
+#   include <unistd.h>
+#   include <sys/ioctl.h>
+#   include <sys/epoll.h>
+#   include <sys/eventfd.h>
+#   include <sys/inotify.h>
+#   include <linux/input.h>
+#endif
+
+#ifdef EVDEV_SUPPORTED
+
+/**
+ * Kernel headers older than 4.16 do not have the 64-bit safe timestamp fields
+ */
+#   ifndef input_event_sec
+#      define input_event_sec time.tv_sec
+#      define input_event_usec time.tv_usec
+#   endif
+
+/**
+ * Number of bytes needed to store one bit for each of the given \a codes
+ */
+#   define BIT_BYTES(codes) (((codes) + 7) / 8)
+
+/**
+ * Maximum number of events read from a device with each system call
+ */
+static const int READ_EVENTS = 64;
+
+/**
+ * Returns \c true if the given \a bit is set in the \a bits returned by the kernel
+ */
+static inline bool testBit(const quint8 *bits, const int bit)
+{
+   return bits[bit / 8] & (1 << (bit % 8));
+}
+
+/**
+ * Returns the time of the monotonic clock (the clock used to timestamp the
+ * events of every device) in microseconds
+ */
+static qint64 monotonicTime()
+{
+   struct timespec now;
+   clock_gettime(CLOCK_MONOTONIC, &now);
+   return qint64(now.tv_sec) * 1000000 + now.tv_nsec / 1000;
+}
+
+/**
+ * Converts the horizontal (\a x) and vertical (\a y) values of a hat into the
+ * angle used by the POV events, \c -1 means that the hat is centered.
+ */
+static int povAngle(const int x, const int y)
+{
+   static const int angles[3][3] = { { 315, 0, 45 }, { 270, -1, 90 }, { 225, 180, 135 } };
+   return angles[qBound(-1, y, 1) + 1][qBound(-1, x, 1) + 1];
+}
+
+/**
+ * \brief Reads the events of every joystick in a dedicated thread
+ *
+ * The thread waits on the event devices, on an inotify watch of \c /dev/input
+ * (to open new devices) and on an eventfd (to stop) with a single epoll set.
+ *
+ * The changes of each device are accumulated until the kernel terminates the
+ * report with \c SYN_REPORT. The complete reports, along with the devices that
+ * have been opened or lost, are handed over to the \c Evdev_Joysticks object
+ * once every ready device has been read.
+ */
+class Evdev_Reader : public QThread
+{
+public:
+   explicit Evdev_Reader(Evdev_Joysticks *owner);
+   ~Evdev_Reader();
+
+   void stop();
+
+protected:
+   void run() Q_DECL_OVERRIDE;
+
+private:
+   struct Device
+   {
+      int fd;
+      int instanceID;
+      bool closing;
+      bool dropped;
+      QString path;
+      int absIndex[ABS_CNT];
+      int keyIndex[KEY_CNT];
+      int hats[ABS_HAT3Y - ABS_HAT0X + 1];
+      QVector<int> povs;
+      QVector<bool> buttons;
+      QVector<double> axes;
+      QVector<int> minimum;
+      QVector<int> maximum;
+      QVector<Evdev_Joysticks::Change> pending;
+   };
+
+   void scan();
+   void openDevice(const QString &path);
+   void closeDevice(Device *device);
+   void readEvents(Device *device);
+   void synchronize(Device *device);
+   void flush(Device *device, const qint64 timestamp, const bool resync);
+   void setAbs(Device *device, const int code, const int value);
+   void setButton(Device *device, const int index, const bool pressed);
+
+   int m_epoll;
+   int m_wakeup;
+   int m_inotify;
+   int m_nextInstanceID;
+
+   Evdev_Joysticks *m_owner;
+   Evdev_Joysticks::Batch m_batch;
+   QList<Device *> m_devices;
+};
+
+/**
+ * Creates the epoll set, the stop notifier and the watch of \c /dev/input
+ */
+Evdev_Reader::Evdev_Reader(Evdev_Joysticks *owner)
+   : m_nextInstanceID(0)
+   , m_owner(owner)
+{
+   m_epoll = epoll_create1(EPOLL_CLOEXEC);
+   m_wakeup = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+   m_inotify = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+   if (m_epoll < 0 || m_wakeup < 0)
+   {
+      qWarning() << "Cannot initialize evdev input:" << strerror(errno);
+      return;
+   }
+
+   struct epoll_event event;
+   event.events = EPOLLIN;
+   event.data.ptr = &m_wakeup;
+   epoll_ctl(m_epoll, EPOLL_CTL_ADD, m_wakeup, &event);
+
+   /* Devices are created by the kernel, but can only be opened once udev
+    * has set their permissions */
+   const uint32_t mask = IN_CREATE | IN_ATTRIB;
+   if (m_inotify >= 0 && inotify_add_watch(m_inotify, "/dev/input", mask) >= 0)
+   {
+      event.data.ptr = &m_inotify;
+      epoll_ctl(m_epoll, EPOLL_CTL_ADD, m_inotify, &event);
+   }
+}
+
+/**
+ * Closes every device, the thread must have been stopped beforehand
+ */
+Evdev_Reader::~Evdev_Reader()
+{
+   while (!m_devices.isEmpty())
+      closeDevice(m_devices.first());
+
+   if (m_inotify >= 0)
+      ::close(m_inotify);
+   if (m_wakeup >= 0)
+      ::close(m_wakeup);
+   if (m_epoll >= 0)
+      ::close(m_epoll);
+}
+
+/**
+ * Wakes up the thread and waits until it has finished
+ */
+void Evdev_Reader::stop()
+{
+   const quint64 value = 1;
+   if (m_wakeup >= 0 && ::write(m_wakeup, &value, sizeof(value)) < 0)
+      qWarning() << "Cannot stop the evdev thread:" << strerror(errno);
+
+   wait();
+}
+
+/**
+ * Opens the joysticks that are already connected and reads the events of
+ * every device until \c stop() is called
+ */
+void Evdev_Reader::run()
+{
+   if (m_epoll < 0 || m_wakeup < 0)
+      return;
+
+   scan();
+   m_owner->publish(m_batch);
+
+   struct epoll_event events[16];
+   forever
+   {
+      const int count = epoll_wait(m_epoll, events, 16, -1);
+      if (count < 0)
+      {
+         if (errno == EINTR)
+            continue;
+
+         qWarning() << "Cannot wait for evdev events:" << strerror(errno);
+         return;
+      }
+
+      bool stopped = false;
+      bool rescan = false;
+      for (int i = 0; i < count; ++i)
+      {
+         void *source = events[i].data.ptr;
+         if (source == &m_wakeup)
+            stopped = true;
+
+         else if (source == &m_inotify)
+         {
+            char buffer[4096];
+            while (::read(m_inotify, buffer, sizeof(buffer)) > 0)
+               continue;
+
+            rescan = true;
+         }
+
+         else
+         {
+            Device *device = static_cast<Device *>(source);
+            if (events[i].events & EPOLLIN)
+               readEvents(device);
+            if (events[i].events & (EPOLLERR | EPOLLHUP))
+               device->closing = true;
+         }
+      }
+
+      /* Lost devices are closed once every ready device has been read */
+      for (int i = m_devices.count() - 1; i >= 0; --i)
+      {
+         if (m_devices.at(i)->closing)
+            closeDevice(m_devices.at(i));
+      }
+
+      if (rescan)
+         scan();
+
+      m_owner->publish(m_batch);
+
+      if (stopped)
+         return;
+   }
+}
+
+/**
+ * Opens every event device that has not been opened yet
+ */
+void Evdev_Reader::scan()
+{
+   const QDir directory("/dev/input");
+   const QStringList names = directory.entryList(QStringList("event*"), QDir::System);
+   foreach (const QString &name, names)
+      openDevice(directory.filePath(name));
+}
+
+/**
+ * Opens the device at the given \a path if it is a joystick (i.e. it has at
+ * least one joystick or gamepad button and one absolute axis), and queues the
+ * description and current state of the joystick.
+ */
+void Evdev_Reader::openDevice(const QString &path)
+{
+   for (int i = 0; i < m_devices.count(); ++i)
+   {
+      if (m_devices.at(i)->path == path)
+         return;
+   }
+
+   const QByteArray file = QFile::encodeName(path);
+   const int fd = ::open(file.constData(), O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+   if (fd < 0)
+      return;
+
+   /* Check the type of device */
+   quint8 keyBits[BIT_BYTES(KEY_CNT)] = { 0 };
+   quint8 absBits[BIT_BYTES(ABS_CNT)] = { 0 };
+   ioctl(fd, EVIOCGBIT(EV_KEY, sizeof(keyBits)), keyBits);
+   ioctl(fd, EVIOCGBIT(EV_ABS, sizeof(absBits)), absBits);
+
+   bool hasButtons = false;
+   bool hasAxes = false;
+   for (int code = BTN_JOYSTICK; code < BTN_DIGI && !hasButtons; ++code)
+      hasButtons = testBit(keyBits, code);
+   for (int code = 0; code < ABS_CNT && !hasAxes; ++code)
+      hasAxes = testBit(absBits, code);
+
+   if (!hasButtons || !hasAxes)
+   {
+      ::close(fd);
+      return;
+   }
+
+   /* Timestamp the events with the same clock used to measure the latency */
+   int clock = CLOCK_MONOTONIC;
+   ioctl(fd, EVIOCSCLOCKID, &clock);
+
+   Device *device = new Device;
+   device->fd = fd;
+   device->instanceID = m_nextInstanceID++;
+   device->closing = false;
+   device->dropped = false;
+   device->path = path;
+   std::fill(device->absIndex, device->absIndex + ABS_CNT, -1);
+   std::fill(device->keyIndex, device->keyIndex + KEY_CNT, -1);
+   std::fill(device->hats, device->hats + ABS_HAT3Y - ABS_HAT0X + 1, 0);
+
+   /* Number the buttons as SDL does: joystick & gamepad buttons first */
+   for (int code = BTN_JOYSTICK; code < KEY_CNT; ++code)
+   {
+      if (testBit(keyBits, code))
+      {
+         device->keyIndex[code] = device->buttons.count();
+         device->buttons.append(false);
+      }
+   }
+
+   for (int code = BTN_MISC; code < BTN_JOYSTICK; ++code)
+   {
+      if (testBit(keyBits, code))
+      {
+         device->keyIndex[code] = device->buttons.count();
+         device->buttons.append(false);
+      }
+   }
+
+   /* Hats are reported as POVs, the other absolute axes (except for
+    * multi-touch) as axes */
+   for (int code = ABS_HAT0X; code <= ABS_HAT3Y; code += 2)
+   {
+      if (testBit(absBits, code) || testBit(absBits, code + 1))
+      {
+         device->absIndex[code] = device->povs.count();
+         device->absIndex[code + 1] = device->povs.count();
+         device->povs.append(-1);
+      }
+   }
+
+   for (int code = 0; code < ABS_MT_SLOT; ++code)
+   {
+      if (!testBit(absBits, code) || (code >= ABS_HAT0X && code <= ABS_HAT3Y))
+         continue;
+
+      struct input_absinfo info;
+      if (ioctl(fd, EVIOCGABS(code), &info) < 0)
+         continue;
+
+      device->absIndex[code] = device->axes.count();
+      device->minimum.append(info.minimum);
+      device->maximum.append(info.maximum);
+      device->axes.append(0);
+   }
+
+   char name[256] = "Unknown";
+   ioctl(fd, EVIOCGNAME(sizeof(name) - 1), name);
+
+   struct epoll_event event;
+   event.events = EPOLLIN;
+   event.data.ptr = device;
+   if (epoll_ctl(m_epoll, EPOLL_CTL_ADD, fd, &event) < 0)
+   {
+      ::close(fd);
+      delete device;
+      return;
+   }
+
+   /* Register the joystick, followed by its current state */
+   Evdev_Joysticks::Description description;
+   description.instanceID = device->instanceID;
+   description.name = QString::fromUtf8(name);
+   description.axes = device->axes.count();
+   description.buttons = device->buttons.count();
+   description.povs = device->povs.count();
+   m_batch.added.append(description);
+   m_devices.append(device);
+
+   synchronize(device);
+   flush(device, monotonicTime(), false);
+}
+
+/**
+ * Closes the given \a device and queues its removal
+ */
+void Evdev_Reader::closeDevice(Device *device)
+{
+   epoll_ctl(m_epoll, EPOLL_CTL_DEL, device->fd, Q_NULLPTR);
+   ::close(device->fd);
+
+   m_batch.removed.append(device->instanceID);
+   m_devices.removeOne(device);
+   delete device;
+}
+
+/**
+ * Reads every pending event of the given \a device. Changes are accumulated
+ * until the end of the report, and discarded if the kernel dropped events
+ * (the state is then read again at the end of the next report).
+ */
+void Evdev_Reader::readEvents(Device *device)
+{
+   struct input_event events[READ_EVENTS];
+
+   forever
+   {
+      const ssize_t bytes = ::read(device->fd, events, sizeof(events));
+      if (bytes < 0)
+      {
+         if (errno == EINTR)
+            continue;
+
+         /* ENODEV: the device has been unplugged */
+         if (errno != EAGAIN)
+            device->closing = true;
+
+         return;
+      }
+
+      const int count = bytes / sizeof(struct input_event);
+      for (int i = 0; i < count; ++i)
+      {
+         const struct input_event &event = events[i];
+         if (event.type == EV_SYN && event.code == SYN_REPORT)
+         {
+            const bool resync = device->dropped;
+            if (resync)
+            {
+               device->dropped = false;
+               synchronize(device);
+            }
+
+            const qint64 seconds = event.input_event_sec;
+            flush(device, seconds * 1000000 + event.input_event_usec, resync);
+         }
+
+         else if (event.type == EV_SYN && event.code == SYN_DROPPED)
+         {
+            device->dropped = true;
+            device->pending.clear();
+         }
+
+         else if (device->dropped)
+            continue;
+
+         /* Ignore key auto-repeat (value 2) */
+         else if (event.type == EV_KEY && event.code < KEY_CNT && event.value != 2)
+         {
+            const int index = device->keyIndex[event.code];
+            if (index >= 0)
+               setButton(device, index, event.value != 0);
+         }
+
+         else if (event.type == EV_ABS && event.code < ABS_CNT)
+         {
+            if (device->absIndex[event.code] >= 0)
+               setAbs(device, event.code, event.value);
+         }
+      }
+
+      if (count < READ_EVENTS)
+         return;
+   }
+}
+
+/**
+ * Reads the current state of every button, axis and hat of the \a device
+ */
+void Evdev_Reader::synchronize(Device *device)
+{
+   quint8 keys[BIT_BYTES(KEY_CNT)] = { 0 };
+   if (ioctl(device->fd, EVIOCGKEY(sizeof(keys)), keys) >= 0)
+   {
+      for (int code = 0; code < KEY_CNT; ++code)
+      {
+         if (device->keyIndex[code] >= 0)
+            setButton(device, device->keyIndex[code], testBit(keys, code));
+      }
+   }
+
+   for (int code = 0; code < ABS_CNT; ++code)
+   {
+      struct input_absinfo info;
+      if (device->absIndex[code] >= 0 && ioctl(device->fd, EVIOCGABS(code), &info) >= 0)
+         setAbs(device, code, info.value);
+   }
+}
+
+/**
+ * Queues the changes accumulated since the previous report of the \a device
+ */
+void Evdev_Reader::flush(Device *device, const qint64 timestamp, const bool resync)
+{
+   if (device->pending.isEmpty() && !resync)
+      return;
+
+   Evdev_Joysticks::Report report;
+   report.instanceID = device->instanceID;
+   report.timestamp = timestamp;
+   report.first = m_batch.changes.count();
+   report.count = device->pending.count();
+   report.resync = resync;
+
+   m_batch.reports.append(report);
+   m_batch.changes += device->pending;
+   device->pending.clear();
+}
+
+/**
+ * Updates the axis or hat with the given \a code, the change is only queued if
+ * the normalized axis value (or the angle of the POV) has changed.
+ */
+void Evdev_Reader::setAbs(Device *device, const int code, const int value)
+{
+   const int index = device->absIndex[code];
+   Evdev_Joysticks::Change change;
+   change.index = index;
+
+   if (code >= ABS_HAT0X && code <= ABS_HAT3Y)
+   {
+      const int hat = (code - ABS_HAT0X) & ~1;
+      device->hats[code - ABS_HAT0X] = value;
+
+      const int angle = povAngle(device->hats[hat], device->hats[hat + 1]);
+      if (angle == device->povs.at(index))
+         return;
+
+      device->povs[index] = angle;
+      change.type = Evdev_Joysticks::POVChange;
+      change.value = angle;
+   }
+
+   else
+   {
+      const int minimum = device->minimum.at(index);
+      const int maximum = device->maximum.at(index);
+      double axis = 0;
+      if (maximum > minimum)
+         axis = qBound(-1.0, 2.0 * (value - minimum) / (maximum - minimum) - 1, 1.0);
+
+      if (axis == device->axes.at(index))
+         return;
+
+      device->axes[index] = axis;
+      change.type = Evdev_Joysticks::AxisChange;
+      change.value = axis;
+   }
+
+   device->pending.append(change);
+}
+
+/**
+ * Updates the button at the given \a index, the change is only queued if the
+ * state of the button has changed.
+ */
+void Evdev_Reader::setButton(Device *device, const int index, const bool pressed)
+{
+   if (device->buttons.at(index) == pressed)
+      return;
+
+   device->buttons[index] = pressed;
+
+   Evdev_Joysticks::Change change;
+   change.type = Evdev_Joysticks::ButtonChange;
+   change.index = index;
+   change.value = pressed;
+   device->pending.append(change);
+}
+
+#endif
+
+Evdev_Joysticks::Evdev_Joysticks(QObject *parent)
+   : QObject(parent)
+   , m_enabled(false)
+   , m_reader(Q_NULLPTR)
+   , m_listener(Q_NULLPTR)
+{
+   resetStats();
+}
+
+Evdev_Joysticks::~Evdev_Joysticks()
+{
+#ifdef EVDEV_SUPPORTED
+   if (m_reader)
+   {
+      m_reader->stop();
+      delete m_reader;
+   }
+#endif
+
+   qDeleteAll(m_joysticks);
+}
+
+/**
+ * Returns \c true if the evdev input system is available on this platform
+ */
+bool Evdev_Joysticks::isSupported()
+{
+#ifdef EVDEV_SUPPORTED
+   return true;
+#else
+   return false;
+#endif
+}
+
+/**
+ * Returns \c true if the joysticks are being read
+ */
+bool Evdev_Joysticks::isEnabled() const
+{
+   return m_enabled;
+}
+
+/**
+ * Returns the number of reports applied and their latency
+ */
+Evdev_Joysticks::Stats Evdev_Joysticks::stats() const
+{
+   return m_stats;
+}
+
+/**
+ * Sets the \a listener that receives each report as a batch of events. The
+ * \c axisEvent(), \c buttonEvent() and \c POVEvent() signals of this class
+ * are only emitted while no listener is set.
+ */
+void Evdev_Joysticks::setListener(QJoystickListener *listener)
+{
+   m_listener = listener;
+}
+
+/**
+ * Returns a list with all the registered joystick devices
+ */
+QMap<int, QJoystickDevice *> Evdev_Joysticks::joysticks()
+{
+   return m_joysticks;
+}
+
+/**
+ * Clears the report counters and the latency measurements
+ */
+void Evdev_Joysticks::resetStats()
+{
+   m_stats.reports = 0;
+   m_stats.events = 0;
+   m_stats.resyncs = 0;
+   m_stats.lastLatency = 0;
+   m_stats.maximumLatency = 0;
+}
+
+/**
+ * Starts or stops reading the joysticks. When disabled, every joystick of this
+ * input system is removed.
+ *
+ * \note This function does nothing if evdev is not supported
+ */
+void Evdev_Joysticks::setEnabled(const bool enabled)
+{
+#ifdef EVDEV_SUPPORTED
+   if (m_enabled == enabled)
+      return;
+
+   m_enabled = enabled;
+   if (enabled)
+   {
+      resetStats();
+      m_reader = new Evdev_Reader(this);
+      m_reader->start();
+   }
+
+   else
+   {
+      m_reader->stop();
+      delete m_reader;
+      m_reader = Q_NULLPTR;
+
+      /* Discard the reports that have not been applied yet */
+      m_mutex.lock();
+      m_pending.clear();
+      m_mutex.unlock();
+
+      removeJoysticks();
+   }
+
+   emit enabledChanged(enabled);
+#else
+   Q_UNUSED(enabled);
+#endif
+}
+
+/**
+ * Registers the new joysticks, applies the reports handed over by the reader
+ * thread and removes the joysticks that have been lost.
+ *
+ * The values of every change of a report are applied to the joystick before
+ * the events of the report are emitted.
+ */
+void Evdev_Joysticks::processReports()
+{
+#ifdef EVDEV_SUPPORTED
+   m_mutex.lock();
+   m_processing.swap(m_pending);
+   m_mutex.unlock();
+
+   if (!m_enabled)
+   {
+      m_processing.clear();
+      return;
+   }
+
+   /* Register the new joysticks */
+   for (int i = 0; i < m_processing.added.count(); ++i)
+   {
+      const Description &description = m_processing.added.at(i);
+
+      QJoystickDevice *joystick = new QJoystickDevice;
+      joystick->id = 0;
+      joystick->instanceID = description.instanceID;
+      joystick->name = description.name;
+      joystick->blacklisted = false;
+
+      for (int j = 0; j < description.povs; ++j)
+         joystick->povs.append(-1);
+      for (int j = 0; j < description.axes; ++j)
+         joystick->axes.append(0);
+      for (int j = 0; j < description.buttons; ++j)
+         joystick->buttons.append(false);
+
+      m_joysticks[description.instanceID] = joystick;
+   }
+
+   if (!m_processing.added.isEmpty())
+      emit countChanged();
+
+   /* Apply the reports */
+   for (int i = 0; i < m_processing.reports.count() && m_enabled; ++i)
+   {
+      const Report &report = m_processing.reports.at(i);
+      QJoystickDevice *joystick = m_joysticks.value(report.instanceID);
+      if (!joystick)
+         continue;
+
+      const Change *changes = m_processing.changes.constData() + report.first;
+      for (int j = 0; j < report.count; ++j)
+      {
+         const Change &change = changes[j];
+         if (change.type == AxisChange)
+            joystick->axes[change.index] = change.value;
+         else if (change.type == ButtonChange)
+            joystick->buttons[change.index] = change.value != 0;
+         else
+            joystick->povs[change.index] = static_cast<int>(change.value);
+      }
+
+      /* Deliver the whole report to the listener at once */
+      if (m_listener)
+      {
+         m_events.clear();
+         for (int j = 0; j < report.count; ++j)
+            m_events.append(createEvent(changes[j], joystick, report.timestamp));
+
+         m_listener->joystickEvents(m_events.constData(), m_events.count());
+      }
+
+      else
+      {
+         for (int j = 0; j < report.count && m_enabled; ++j)
+         {
+            const QJoystickEvent event = createEvent(changes[j], joystick, report.timestamp);
+            if (event.type == QJoystickEvent::AxisEvent)
+               emit axisEvent(event.axis);
+            else if (event.type == QJoystickEvent::ButtonEvent)
+               emit buttonEvent(event.button);
+            else
+               emit POVEvent(event.pov);
+         }
+      }
+
+      const qint64 latency = monotonicTime() - report.timestamp;
+      m_stats.lastLatency = latency;
+      m_stats.maximumLatency = qMax(m_stats.maximumLatency, latency);
+      m_stats.events += report.count;
+      m_stats.resyncs += report.resync ? 1 : 0;
+      ++m_stats.reports;
+   }
+
+   /* Remove the joysticks that have been lost */
+   bool removed = false;
+   for (int i = 0; i < m_processing.removed.count(); ++i)
+   {
+      QJoystickDevice *joystick = m_joysticks.take(m_processing.removed.at(i));
+      removed |= joystick != Q_NULLPTR;
+      delete joystick;
+   }
+
+   m_processing.clear();
+
+   if (removed)
+      emit countChanged();
+#endif
+}
+
+/**
+ * Returns the event of the given \a joystick that corresponds to a \a change,
+ * reported by the kernel at the given \a timestamp
+ */
+QJoystickEvent Evdev_Joysticks::createEvent(const Change &change, QJoystickDevice *joystick,
+                                            const qint64 timestamp)
+{
+   QJoystickEvent event;
+   event.timestamp = timestamp;
+   if (change.type == AxisChange)
+   {
+      event.type = QJoystickEvent::AxisEvent;
+      event.axis.axis = change.index;
+      event.axis.value = change.value;
+      event.axis.joystick = joystick;
+   }
+
+   else if (change.type == ButtonChange)
+   {
+      event.type = QJoystickEvent::ButtonEvent;
+      event.button.button = change.index;
+      event.button.pressed = change.value != 0;
+      event.button.joystick = joystick;
+   }
+
+   else
+   {
+      event.type = QJoystickEvent::POVEvent;
+      event.pov.pov = change.index;
+      event.pov.angle = static_cast<int>(change.value);
+      event.pov.joystick = joystick;
+   }
+
+   return event;
+}
+
+/**
+ * Hands over a \a batch of reports from the reader thread. The batch is
+ * swapped with the pending one if the main thread has already processed it,
+ * so that the buffers are reused instead of being allocated again.
+ */
+void Evdev_Joysticks::publish(Batch &batch)
+{
+   if (batch.isEmpty())
+      return;
+
+   bool idle;
+   {
+      QMutexLocker locker(&m_mutex);
+      idle = m_pending.isEmpty();
+      if (idle)
+         m_pending.swap(batch);
+
+      else
+      {
+         const int offset = m_pending.changes.count();
+         for (int i = 0; i < batch.reports.count(); ++i)
+         {
+            Report report = batch.reports.at(i);
+            report.first += offset;
+            m_pending.reports.append(report);
+         }
+
+         m_pending.added += batch.added;
+         m_pending.changes += batch.changes;
+         m_pending.removed += batch.removed;
+      }
+   }
+
+   batch.clear();
+
+   if (idle)
+      QMetaObject::invokeMethod(this, "processReports", Qt::QueuedConnection);
+}
+
+/**
+ * Deletes every joystick of this input system
+ */
+void Evdev_Joysticks::removeJoysticks()
+{
+   if (m_joysticks.isEmpty())
+      return;
+
+   qDeleteAll(m_joysticks);
+   m_joysticks.clear();
+   emit countChanged();
+}
+
+/**
+ * Returns \c true if the batch has nothing to hand over
+ */
+bool Evdev_Joysticks::Batch::isEmpty() const
+{
+   return added.isEmpty() && reports.isEmpty() && removed.isEmpty();
+}
+
+/**
+ * Empties the batch, the memory of the buffers is kept for the next reports
+ */
+void Evdev_Joysticks::Batch::clear()
+{
+   added.clear();
+   reports.clear();
+   changes.clear();
+   removed.clear();
+}
+
+/**
+ * Exchanges the contents of this batch with the \a other batch
+ */
+void Evdev_Joysticks::Batch::swap(Batch &other)
+{
+   added.swap(other.added);
+   reports.swap(other.reports);
+   changes.swap(other.changes);
+   removed.swap(other.removed);
+}
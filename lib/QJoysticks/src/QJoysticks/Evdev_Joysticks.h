@@ -0,0 +1,163 @@
+/*
+ * Copyright (c) 2015-2017 Alex Spataru <alex_spataru@outlook.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef _QJOYSTICKS_EVDEV_JOYSTICKS_H
+#define _QJOYSTICKS_EVDEV_JOYSTICKS_H
+
+#include <QMap>
+#include <QMutex>
+#include <QObject>
+#include <QVector>
+#include <QJoysticks/JoysticksCommon.h>
+
+class Evdev_Reader;
+
+/**
+ * \brief Reads joysticks directly from the Linux input subsystem
+ *
+ * This class opens the \c /dev/input/event* devices that look like joysticks
+ * and reads their events in a dedicated thread (waiting on all of them with
+ * epoll), without going through the SDL event queue and its polling loop.
+ *
+ * The kernel groups the changes of a device in reports, terminated by a
+ * \c SYN_REPORT event. The reader thread hands over complete reports only, and
+ * every axis, button and POV of a report is applied to the joystick before any
+ * of the resulting events is emitted. Hence, a slot that reacts to one of the
+ * events always sees the joystick in a state that the device has reported.
+ * Each report is also delivered as a single batch to the listener set with
+ * \c setListener() (which is \c QJoysticks).
+ *
+ * \note The axes and buttons are numbered in the order used by the kernel,
+ *       which may differ from the game controller mapping applied by SDL.
+ * \note This input system is only available on Linux, on other operating
+ *       systems it has no joysticks and cannot be enabled.
+ */
+class Evdev_Joysticks : public QObject
+{
+   Q_OBJECT
+
+   friend class Evdev_Reader;
+
+signals:
+   void countChanged();
+   void enabledChanged(const bool enabled);
+   void POVEvent(const QJoystickPOVEvent &event);
+   void axisEvent(const QJoystickAxisEvent &event);
+   void buttonEvent(const QJoystickButtonEvent &event);
+
+public:
+   /**
+    * Counters of the reports applied since the input system was enabled.
+    * The latency is measured from the kernel timestamp of each report until
+    * its values have been applied, in microseconds.
+    */
+   struct Stats
+   {
+      quint64 reports; /**< Number of reports applied */
+      quint64 events; /**< Number of axis, button and POV changes applied */
+      quint64 resyncs; /**< Times the kernel dropped events (SYN_DROPPED) */
+      qint64 lastLatency; /**< Latency of the last report */
+      qint64 maximumLatency; /**< Highest latency of any report */
+   };
+
+   Evdev_Joysticks(QObject *parent = Q_NULLPTR);
+   ~Evdev_Joysticks();
+
+   static bool isSupported();
+
+   bool isEnabled() const;
+   Stats stats() const;
+   QMap<int, QJoystickDevice *> joysticks();
+
+   void setListener(QJoystickListener *listener);
+
+public slots:
+   void resetStats();
+   void setEnabled(const bool enabled);
+
+private slots:
+   void processReports();
+
+private:
+   enum ChangeType
+   {
+      AxisChange,
+      ButtonChange,
+      POVChange
+   };
+
+   struct Change
+   {
+      int type;
+      int index;
+      double value;
+   };
+
+   struct Report
+   {
+      int instanceID;
+      qint64 timestamp;
+      int first;
+      int count;
+      bool resync;
+   };
+
+   struct Description
+   {
+      int instanceID;
+      QString name;
+      int axes;
+      int buttons;
+      int povs;
+   };
+
+   struct Batch
+   {
+      QVector<Description> added;
+      QVector<Report> reports;
+      QVector<Change> changes;
+      QVector<int> removed;
+
+      bool isEmpty() const;
+      void clear();
+      void swap(Batch &other);
+   };
+
+   static QJoystickEvent createEvent(const Change &change, QJoystickDevice *joystick,
+                                     const qint64 timestamp);
+
+   void publish(Batch &batch);
+   void removeJoysticks();
+
+   bool m_enabled;
+   Stats m_stats;
+   Evdev_Reader *m_reader;
+   QJoystickListener *m_listener;
+   QVector<QJoystickEvent> m_events;
+
+   QMutex m_mutex;
+   Batch m_pending;
+   Batch m_processing;
+   QMap<int, QJoystickDevice *> m_joysticks;
+};
+
+#endif
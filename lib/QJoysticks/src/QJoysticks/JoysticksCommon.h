@@ -24,6 +24,7 @@
 #define _QJOYSTICKS_COMMON_H
 
 #include <QString>
+#include <QDeadlineTimer>
 
 /**
  * @brief Represents a joystick and its properties
@@ -108,4 +109,56 @@ struct QJoystickButtonEvent
    QJoystickDevice *joystick; /**< Pointer to the device that caused the event */
 };
 
+/**
+ * @brief Represents an axis, button or POV event in a batch of events
+ *
+ * This structure contains:
+ *   - The type of the event
+ *   - The time at which the input system received the event
+ *   - The event itself, in the member that corresponds to its type
+ */
+struct QJoystickEvent
+{
+   enum Type
+   {
+      AxisEvent,
+      ButtonEvent,
+      POVEvent
+   };
+
+   Type type; /**< Selects the member that holds the event */
+   qint64 timestamp; /**< Time of the event, see \c currentTime() */
+   union
+   {
+      QJoystickAxisEvent axis; /**< Set if the type is \c AxisEvent */
+      QJoystickButtonEvent button; /**< Set if the type is \c ButtonEvent */
+      QJoystickPOVEvent pov; /**< Set if the type is \c POVEvent */
+   };
+
+   /**
+    * Returns the current time of the monotonic clock used to timestamp the
+    * events, in microseconds
+    */
+   static qint64 currentTime()
+   {
+      return QDeadlineTimer::current(Qt::PreciseTimer).deadlineNSecs() / 1000;
+   }
+};
+
+/**
+ * @brief Receives the joystick events as batches, without signals
+ *
+ * A listener registered with \c QJoysticks::addListener() is called directly
+ * with every batch of events read by an input system (e.g. all the events
+ * polled from SDL at once, or a complete evdev report), in the order in which
+ * they happened. The joystick values have already been updated when the
+ * listener is called.
+ */
+class QJoystickListener
+{
+public:
+   virtual ~QJoystickListener() {}
+   virtual void joystickEvents(const QJoystickEvent *events, const int count) = 0;
+};
+
 #endif
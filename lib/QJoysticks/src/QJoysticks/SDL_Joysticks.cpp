@@ -23,7 +23,7 @@
 #include <QFile>
 #include <QDebug>
 #include <QTimer>
-#include <QApplication>
+#include <QCoreApplication>
 #include <QJoysticks/SDL_Joysticks.h>
 
 /**
@@ -49,6 +49,10 @@ static QString GENERIC_MAPPINGS;
 
 SDL_Joysticks::SDL_Joysticks(QObject *parent)
    : QObject(parent)
+   , m_enabled(true)
+   , m_polling(false)
+   , m_listener(Q_NULLPTR)
+   , m_eventTime(0)
 {
 
 #ifdef SDL_SUPPORTED
@@ -77,15 +81,16 @@ SDL_Joysticks::SDL_Joysticks(QObject *parent)
       genericMappings.close();
    }
 
+   m_polling = true;
    QTimer::singleShot(100, Qt::PreciseTimer, this, SLOT(update()));
 #endif
 }
 
 SDL_Joysticks::~SDL_Joysticks()
 {
-   for (QMap<int, QJoystickDevice *>::iterator i = m_joysticks.begin(); i != m_joysticks.end(); ++i)
+   for (QMap<int, Device>::iterator i = m_devices.begin(); i != m_devices.end(); ++i)
    {
-      delete i.value();
+      delete i.value().joystick;
    }
 
 #ifdef SDL_SUPPORTED
@@ -93,6 +98,69 @@ SDL_Joysticks::~SDL_Joysticks()
 #endif
 }
 
+/**
+ * Returns \c true if the joysticks are being read through SDL
+ */
+bool SDL_Joysticks::isEnabled() const
+{
+   return m_enabled;
+}
+
+/**
+ * Returns the listener that receives the events polled from SDL as batches
+ */
+QJoystickListener *SDL_Joysticks::listener() const
+{
+   return m_listener;
+}
+
+/**
+ * Sets the \a listener that receives the events polled from SDL as batches.
+ * The \c axisEvent(), \c buttonEvent() and \c POVEvent() signals of this
+ * class are only emitted while no listener is set.
+ */
+void SDL_Joysticks::setListener(QJoystickListener *listener)
+{
+   m_events.clear();
+   m_listener = listener;
+}
+
+/**
+ * Registers a \a joystick that is not opened through SDL, and takes its
+ * ownership. Its events can be pushed to the SDL queue with its instance ID,
+ * or given to \c injectEvents().
+ */
+void SDL_Joysticks::addSimulatedDevice(QJoystickDevice *joystick)
+{
+   flushEvents();
+   addDevice(joystick, Q_NULLPTR, Q_NULLPTR);
+
+   emit countChanged();
+}
+
+/**
+ * Removes and deletes the joystick registered with \c addSimulatedDevice()
+ * with the given \a instanceID
+ */
+void SDL_Joysticks::removeSimulatedDevice(int instanceID)
+{
+   flushEvents();
+   removeJoystick(instanceID);
+}
+
+/**
+ * Translates the given \a count SDL \a events as if they had been polled in
+ * one cycle, and delivers them to the listener as one batch (or through the
+ * signals of this class if no listener is set).
+ */
+void SDL_Joysticks::injectEvents(const SDL_Event *events, int count)
+{
+   for (int i = 0; i < count; ++i)
+      processEvent(&events[i]);
+
+   flushEvents();
+}
+
 /**
  * Returns a list with all the registered joystick devices
  */
@@ -101,10 +169,10 @@ QMap<int, QJoystickDevice *> SDL_Joysticks::joysticks()
 #ifdef SDL_SUPPORTED
    int index = 0;
    QMap<int, QJoystickDevice *> joysticks;
-   for (QMap<int, QJoystickDevice *>::iterator it = m_joysticks.begin(); it != m_joysticks.end(); ++it)
+   for (QMap<int, Device>::iterator it = m_devices.begin(); it != m_devices.end(); ++it)
    {
-      it.value()->id = index;
-      joysticks[index++] = it.value();
+      it.value().joystick->id = index;
+      joysticks[index++] = it.value().joystick;
    }
 
    return joysticks;
@@ -112,6 +180,47 @@ QMap<int, QJoystickDevice *> SDL_Joysticks::joysticks()
    return QMap<int, QJoystickDevice *>();
 }
 
+/**
+ * Starts or stops reading the joysticks through SDL (e.g. when another input
+ * system reads the same devices). When disabled, every joystick is closed and
+ * removed, and the SDL events are no longer polled.
+ */
+void SDL_Joysticks::setEnabled(const bool enabled)
+{
+   if (m_enabled == enabled)
+      return;
+
+   m_enabled = enabled;
+
+#ifdef SDL_SUPPORTED
+   if (enabled)
+   {
+      /* SDL reports the attached joysticks again once initialized */
+      if (SDL_InitSubSystem(SDL_INIT_GAMECONTROLLER))
+         qDebug() << "Cannot initialize SDL:" << SDL_GetError();
+
+      if (!m_polling)
+      {
+         m_polling = true;
+         QTimer::singleShot(10, Qt::PreciseTimer, this, SLOT(update()));
+      }
+   }
+
+   else
+   {
+      flushEvents();
+      while (!m_devices.isEmpty())
+         removeJoystick(m_devices.firstKey());
+
+      SDL_QuitSubSystem(SDL_INIT_GAMECONTROLLER);
+   }
+
+   emit countChanged();
+#endif
+
+   emit enabledChanged(enabled);
+}
+
 /**
  * Based on the data contained in the \a request, this function will instruct
  * the appropriate joystick to rumble for
@@ -137,161 +246,215 @@ void SDL_Joysticks::rumble(const QJoystickRumble &request)
 void SDL_Joysticks::update()
 {
 #ifdef SDL_SUPPORTED
+   /* Stop polling until SDL is enabled again */
+   m_polling = m_enabled;
+   if (!m_polling)
+      return;
+
    SDL_Event event;
 
    while (SDL_PollEvent(&event))
-   {
-      switch (event.type)
-      {
-         case SDL_JOYDEVICEADDED:
-            configureJoystick(&event);
-            break;
-         case SDL_JOYDEVICEREMOVED: {
-            SDL_Joystick *js = SDL_JoystickFromInstanceID(event.jdevice.which);
-            if (js)
-            {
-               SDL_JoystickClose(js);
-            }
-
-            SDL_GameController *gc = SDL_GameControllerFromInstanceID(event.cdevice.which);
-            if (gc)
-            {
-               SDL_GameControllerClose(gc);
-            }
-         }
-
-            delete m_joysticks[event.jdevice.which];
-            m_joysticks.remove(event.jdevice.which);
-
-            emit countChanged();
-            break;
-         case SDL_JOYAXISMOTION:
-            if (!SDL_IsGameController(event.cdevice.which))
-            {
-               emit axisEvent(getAxisEvent(&event));
-            }
-            break;
-         case SDL_CONTROLLERAXISMOTION:
-            if (SDL_IsGameController(event.cdevice.which))
-            {
-               emit axisEvent(getAxisEvent(&event));
-            }
-            break;
-         case SDL_JOYBUTTONUP:
-            emit buttonEvent(getButtonEvent(&event));
-            break;
-         case SDL_JOYBUTTONDOWN:
-            emit buttonEvent(getButtonEvent(&event));
-            break;
-         case SDL_JOYHATMOTION:
-            emit POVEvent(getPOVEvent(&event));
-            break;
-      }
-   }
+      processEvent(&event);
+
+   flushEvents();
 
    QTimer::singleShot(10, Qt::PreciseTimer, this, SLOT(update()));
 #endif
 }
 
 /**
- * Checks if the joystick referenced by the \a event can be initialized.
- * If not, the function will apply a generic mapping to the joystick and
- * attempt to initialize the joystick again.
+ * Delivers the events translated since the last call to the listener. This is
+ * done after each polling cycle, and before a joystick is added or removed so
+ * that no event refers to a joystick that has been deleted.
  */
-void SDL_Joysticks::configureJoystick(const SDL_Event *event)
+void SDL_Joysticks::flushEvents()
 {
-#ifdef SDL_SUPPORTED
-   QJoystickDevice *joystick = getJoystick(event->jdevice.which);
+   if (m_events.isEmpty())
+      return;
 
-   if (!SDL_IsGameController(event->cdevice.which))
-   {
-      SDL_Joystick *js = SDL_JoystickFromInstanceID(joystick->instanceID);
-      if (js)
-      {
-         char guid[1024];
-         SDL_JoystickGetGUIDString(SDL_JoystickGetGUID(js), guid, sizeof(guid));
+   if (m_listener)
+      m_listener->joystickEvents(m_events.constData(), m_events.count());
 
-         QString mapping = QString("%1,%2,%3").arg(guid).arg(SDL_JoystickName(js)).arg(GENERIC_MAPPINGS);
+   m_events.clear();
+}
 
-         SDL_GameControllerAddMapping(mapping.toStdString().c_str());
-      }
-   }
+/**
+ * Translates the given SDL \a event and notifies the rest of the application.
+ *
+ * The source of the axis and button events of each joystick has been decided
+ * when the joystick was configured, so no SDL function is called here.
+ */
+void SDL_Joysticks::processEvent(const SDL_Event *event)
+{
+#ifdef SDL_SUPPORTED
+   QMap<int, Device>::const_iterator device;
 
-   SDL_GameControllerOpen(event->cdevice.which);
+   /* SDL timestamps the events in milliseconds since it was initialized */
+   m_eventTime = QJoystickEvent::currentTime();
+   if (event->common.timestamp > 0)
+      m_eventTime -= qint64(SDL_GetTicks() - event->common.timestamp) * 1000;
 
-   emit countChanged();
+   switch (event->type)
+   {
+      case SDL_JOYDEVICEADDED:
+         flushEvents();
+         configureJoystick(event);
+         break;
+      case SDL_JOYDEVICEREMOVED:
+         flushEvents();
+         removeJoystick(event->jdevice.which);
+         break;
+      case SDL_JOYAXISMOTION:
+         device = m_devices.constFind(event->jaxis.which);
+         if (device != m_devices.constEnd() && !device->controller)
+            emitAxisEvent(device->joystick, event->jaxis.axis, event->jaxis.value);
+         break;
+      case SDL_CONTROLLERAXISMOTION:
+         device = m_devices.constFind(event->caxis.which);
+         if (device != m_devices.constEnd() && device->controller)
+            emitAxisEvent(device->joystick, event->caxis.axis, event->caxis.value);
+         break;
+      case SDL_JOYBUTTONUP:
+      case SDL_JOYBUTTONDOWN:
+         device = m_devices.constFind(event->jbutton.which);
+         if (device != m_devices.constEnd() && !device->controller)
+            emitButtonEvent(device->joystick, event->jbutton.button,
+                            event->jbutton.state == SDL_PRESSED);
+         break;
+      case SDL_CONTROLLERBUTTONUP:
+      case SDL_CONTROLLERBUTTONDOWN:
+         device = m_devices.constFind(event->cbutton.which);
+         if (device != m_devices.constEnd() && device->controller)
+            emitButtonEvent(device->joystick, event->cbutton.button,
+                            event->cbutton.state == SDL_PRESSED);
+         break;
+      case SDL_JOYHATMOTION:
+         device = m_devices.constFind(event->jhat.which);
+         if (device != m_devices.constEnd())
+            emitPOVEvent(device->joystick, event->jhat.hat, event->jhat.value);
+         break;
+   }
 #else
    Q_UNUSED(event);
 #endif
 }
 
 /**
- * Returns the josytick device registered with the given \a id.
- * If no joystick with the given \a id is found, then the function will warn
- * the user through the console.
+ * Opens the joystick referenced by the \a event and reads its capabilities.
+ *
+ * If the joystick is not known by SDL, the function applies a generic mapping
+ * to the joystick so that it can be opened as a game controller. Joysticks
+ * that can be opened as game controllers report their axes and buttons with
+ * the game controller numbering.
  */
-QJoystickDevice *SDL_Joysticks::getJoystick(int id)
+void SDL_Joysticks::configureJoystick(const SDL_Event *event)
 {
 #ifdef SDL_SUPPORTED
-   QJoystickDevice *joystick = new QJoystickDevice;
-   SDL_Joystick *sdl_joystick = SDL_JoystickOpen(id);
+   const int index = event->jdevice.which;
+   SDL_Joystick *js = SDL_JoystickOpen(index);
+   if (!js)
+   {
+      qWarning() << Q_FUNC_INFO << "Cannot find joystick with id:" << index;
+      return;
+   }
 
-   if (sdl_joystick)
+   if (!SDL_IsGameController(index))
    {
-      joystick->id = id;
-      joystick->instanceID = SDL_JoystickInstanceID(sdl_joystick);
-      joystick->blacklisted = false;
-      joystick->name = SDL_JoystickName(sdl_joystick);
+      char guid[1024];
+      SDL_JoystickGetGUIDString(SDL_JoystickGetGUID(js), guid, sizeof(guid));
 
-      /* Get joystick properties */
-      int povs = SDL_JoystickNumHats(sdl_joystick);
-      int axes = SDL_JoystickNumAxes(sdl_joystick);
-      int buttons = SDL_JoystickNumButtons(sdl_joystick);
+      QString mapping = QString("%1,%2,%3").arg(guid).arg(SDL_JoystickName(js)).arg(GENERIC_MAPPINGS);
 
-      /* Initialize POVs */
-      for (int i = 0; i < povs; ++i)
-         joystick->povs.append(0);
+      SDL_GameControllerAddMapping(mapping.toStdString().c_str());
+   }
 
-      /* Initialize axes */
-      for (int i = 0; i < axes; ++i)
-         joystick->axes.append(0);
+   SDL_GameController *gc = Q_NULLPTR;
+   if (SDL_IsGameController(index))
+      gc = SDL_GameControllerOpen(index);
 
-      /* Initialize buttons */
-      for (int i = 0; i < buttons; ++i)
-         joystick->buttons.append(false);
+   QJoystickDevice *joystick = new QJoystickDevice;
+   joystick->id = index;
+   joystick->instanceID = SDL_JoystickInstanceID(js);
+   joystick->blacklisted = false;
+   joystick->name = SDL_JoystickName(js);
 
-      m_joysticks[joystick->instanceID] = joystick;
-   }
-   else
-   {
-      qWarning() << Q_FUNC_INFO << "Cannot find joystick with id:" << id;
-   }
+   /* Get joystick properties */
+   int povs = SDL_JoystickNumHats(js);
+   int axes = gc ? SDL_CONTROLLER_AXIS_MAX : SDL_JoystickNumAxes(js);
+   int buttons = gc ? SDL_CONTROLLER_BUTTON_MAX : SDL_JoystickNumButtons(js);
+
+   /* Initialize POVs */
+   for (int i = 0; i < povs; ++i)
+      joystick->povs.append(0);
+
+   /* Initialize axes */
+   for (int i = 0; i < axes; ++i)
+      joystick->axes.append(0);
 
-   return joystick;
+   /* Initialize buttons */
+   for (int i = 0; i < buttons; ++i)
+      joystick->buttons.append(false);
+
+   addDevice(joystick, js, gc);
+
+   emit countChanged();
 #else
-   Q_UNUSED(id);
-   return NULL;
+   Q_UNUSED(event);
 #endif
 }
 
 /**
- * Reads the contents of the given \a event and constructs a new
- * \c QJoystickPOVEvent to be used with the \c QJoysticks system.
+ * Closes the joystick with the given \a instanceID and removes it
  */
-QJoystickPOVEvent SDL_Joysticks::getPOVEvent(const SDL_Event *sdl_event)
+void SDL_Joysticks::removeJoystick(int instanceID)
 {
-   QJoystickPOVEvent event;
+   QMap<int, Device>::iterator device = m_devices.find(instanceID);
+   if (device == m_devices.end())
+      return;
 
-   if (!m_joysticks.contains(sdl_event->jdevice.which))
-   {
-      return event;
-   }
+#ifdef SDL_SUPPORTED
+   if (device->controller)
+      SDL_GameControllerClose(device->controller);
 
+   if (device->sdlJoystick)
+      SDL_JoystickClose(device->sdlJoystick);
+#endif
+
+   delete device->joystick;
+   m_devices.erase(device);
+
+   emit countChanged();
+}
+
+/**
+ * Registers the given \a joystick with its SDL handles. The axis and button
+ * events are read from the game controller API if \a controller is set, and
+ * from the joystick API otherwise.
+ */
+void SDL_Joysticks::addDevice(QJoystickDevice *joystick, SDL_Joystick *sdlJoystick,
+                              SDL_GameController *controller)
+{
+   Q_ASSERT(joystick);
+
+   Device device;
+   device.joystick = joystick;
+   device.sdlJoystick = sdlJoystick;
+   device.controller = controller;
+   m_devices[joystick->instanceID] = device;
+}
+
+/**
+ * Constructs a new \c QJoystickPOVEvent from the SDL hat \a value and
+ * notifies the rest of the application.
+ */
+void SDL_Joysticks::emitPOVEvent(QJoystickDevice *joystick, int pov, int value)
+{
 #ifdef SDL_SUPPORTED
-   event.pov = sdl_event->jhat.hat;
-   event.joystick = m_joysticks[sdl_event->jdevice.which];
+   QJoystickPOVEvent event;
+   event.pov = pov;
+   event.joystick = joystick;
 
-   switch (sdl_event->jhat.value)
+   switch (value)
    {
       case SDL_HAT_RIGHTUP:
          event.angle = 45;
@@ -321,58 +484,76 @@ QJoystickPOVEvent SDL_Joysticks::getPOVEvent(const SDL_Event *sdl_event)
          event.angle = -1;
          break;
    }
+
+   if (m_listener)
+   {
+      QJoystickEvent batched;
+      batched.type = QJoystickEvent::POVEvent;
+      batched.timestamp = m_eventTime;
+      batched.pov = event;
+      m_events.append(batched);
+   }
+
+   else
+      emit POVEvent(event);
 #else
-   Q_UNUSED(sdl_event);
+   Q_UNUSED(joystick);
+   Q_UNUSED(pov);
+   Q_UNUSED(value);
 #endif
-
-   return event;
 }
 
 /**
- * Reads the contents of the given \a event and constructs a new
- * \c QJoystickAxisEvent to be used with the \c QJoysticks system.
+ * Constructs a new \c QJoystickAxisEvent from the SDL axis \a value and
+ * notifies the rest of the application.
  */
-QJoystickAxisEvent SDL_Joysticks::getAxisEvent(const SDL_Event *sdl_event)
+void SDL_Joysticks::emitAxisEvent(QJoystickDevice *joystick, int axis, int value)
 {
+   if (axis >= joystick->axes.count())
+      return;
+
    QJoystickAxisEvent event;
+   event.axis = axis;
+   event.value = static_cast<qreal>(value) / 32767;
+   event.joystick = joystick;
 
-   if (!m_joysticks.contains(sdl_event->cdevice.which))
+   if (m_listener)
    {
-      return event;
+      QJoystickEvent batched;
+      batched.type = QJoystickEvent::AxisEvent;
+      batched.timestamp = m_eventTime;
+      batched.axis = event;
+      m_events.append(batched);
    }
 
-#ifdef SDL_SUPPORTED
-   event.axis = sdl_event->caxis.axis;
-   event.value = static_cast<qreal>(sdl_event->caxis.value) / 32767;
-   event.joystick = m_joysticks[sdl_event->cdevice.which];
-#else
-   Q_UNUSED(sdl_event);
-#endif
-
-   return event;
+   else
+      emit axisEvent(event);
 }
 
 /**
- * Reads the contents of the given \a event and constructs a new
- * \c QJoystickButtonEvent to be used with the \c QJoysticks system.
+ * Updates the state of the \a button, constructs a new
+ * \c QJoystickButtonEvent and notifies the rest of the application.
  */
-QJoystickButtonEvent SDL_Joysticks::getButtonEvent(const SDL_Event *sdl_event)
+void SDL_Joysticks::emitButtonEvent(QJoystickDevice *joystick, int button, bool pressed)
 {
+   if (button >= joystick->buttons.count())
+      return;
+
    QJoystickButtonEvent event;
+   event.button = button;
+   event.pressed = pressed;
+   event.joystick = joystick;
+   event.joystick->buttons[button] = pressed;
 
-   if (!m_joysticks.contains(sdl_event->jdevice.which))
+   if (m_listener)
    {
-      return event;
+      QJoystickEvent batched;
+      batched.type = QJoystickEvent::ButtonEvent;
+      batched.timestamp = m_eventTime;
+      batched.button = event;
+      m_events.append(batched);
    }
 
-#ifdef SDL_SUPPORTED
-   event.button = sdl_event->jbutton.button;
-   event.pressed = sdl_event->jbutton.state == SDL_PRESSED;
-   event.joystick = m_joysticks[sdl_event->jdevice.which];
-   event.joystick->buttons[event.button] = event.pressed;
-#else
-   Q_UNUSED(sdl_event);
-#endif
-
-   return event;
+   else
+      emit buttonEvent(event);
 }
@@ -26,6 +26,7 @@
 #include <SDL.h>
 #include <QObject>
 #include <QMap>
+#include <QVector>
 #include <QJoysticks/JoysticksCommon.h>
 
 /**
@@ -37,6 +38,13 @@
  * The only thing that differs from each operating system is the backup mapping
  * applied in the case that we do not know what mapping to apply to a joystick.
  *
+ * The events polled at once from SDL are also delivered as a single batch to
+ * the listener set with \c setListener() (which is \c QJoysticks).
+ *
+ * Simulated joysticks and events can be injected without a physical device
+ * (e.g. by tests and benchmarks), see \c addSimulatedDevice() and
+ * \c injectEvents().
+ *
  * \note The joystick values are refreshed every 20 milliseconds through a
  *       simple event loop.
  */
@@ -46,6 +54,7 @@ class SDL_Joysticks : public QObject
 
 signals:
    void countChanged();
+   void enabledChanged(const bool enabled);
    void POVEvent(const QJoystickPOVEvent &event);
    void axisEvent(const QJoystickAxisEvent &event);
    void buttonEvent(const QJoystickButtonEvent &event);
@@ -54,9 +63,18 @@ public:
    SDL_Joysticks(QObject *parent = Q_NULLPTR);
    ~SDL_Joysticks();
 
+   bool isEnabled() const;
    QMap<int, QJoystickDevice *> joysticks();
 
+   QJoystickListener *listener() const;
+   void setListener(QJoystickListener *listener);
+
+   void addSimulatedDevice(QJoystickDevice *joystick);
+   void removeSimulatedDevice(int instanceID);
+   void injectEvents(const SDL_Event *events, int count);
+
 public slots:
+   void setEnabled(const bool enabled);
    void rumble(const QJoystickRumble &request);
 
 private slots:
@@ -64,12 +82,36 @@ private slots:
    void configureJoystick(const SDL_Event *event);
 
 private:
-   QJoystickDevice *getJoystick(int id);
-   QJoystickPOVEvent getPOVEvent(const SDL_Event *sdl_event);
-   QJoystickAxisEvent getAxisEvent(const SDL_Event *sdl_event);
-   QJoystickButtonEvent getButtonEvent(const SDL_Event *sdl_event);
+   /**
+    * SDL handles and event source of an attached joystick, decided once when
+    * the joystick is configured. Joysticks with a game controller mapping
+    * report their axes and buttons through the game controller API only, the
+    * other joysticks through the joystick API. Hats are always reported by
+    * the joystick API.
+    */
+   struct Device
+   {
+      QJoystickDevice *joystick; /**< Holds the values of the joystick */
+      SDL_Joystick *sdlJoystick; /**< Joystick handle, closed on removal */
+      SDL_GameController *controller; /**< Set if the game controller API is used */
+   };
+
+   void flushEvents();
+   void processEvent(const SDL_Event *event);
+   void removeJoystick(int instanceID);
+   void addDevice(QJoystickDevice *joystick, SDL_Joystick *sdlJoystick,
+                  SDL_GameController *controller);
+
+   void emitPOVEvent(QJoystickDevice *joystick, int pov, int value);
+   void emitAxisEvent(QJoystickDevice *joystick, int axis, int value);
+   void emitButtonEvent(QJoystickDevice *joystick, int button, bool pressed);
 
-   QMap<int, QJoystickDevice *> m_joysticks;
+   bool m_enabled;
+   bool m_polling;
+   QMap<int, Device> m_devices;
+   QJoystickListener *m_listener;
+   qint64 m_eventTime;
+   QVector<QJoystickEvent> m_events;
 };
 
 #endif
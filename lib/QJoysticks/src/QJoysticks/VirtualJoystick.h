@@ -23,10 +23,10 @@
 #ifndef _QJOYSTICKS_JOYSTICK_H
 #define _QJOYSTICKS_JOYSTICK_H
 
-#include <QWidget>
-#include <QKeyEvent>
-#include <QApplication>
 #include <QTimer>
+#include <QVector>
+#include <QKeyEvent>
+#include <QCoreApplication>
 #include <QScopedPointer>
 
 #include <QJoysticks/JoysticksCommon.h>
@@ -23,6 +23,7 @@
 #
 
 QT += testlib
+QT += widgets
 TARGET = QJoysticks_Test
 
 include ($$PWD/../QJoysticks.pri)
@@ -0,0 +1,174 @@
+/*
+ * Copyright (c) 2022 Alex Spataru <https://github.com/alex-spataru>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "AllocTracker.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+/**
+ * Number of allocations made by each subsystem
+ */
+static std::atomic<quint64> COUNTERS[AllocTracker::SubsystemCount];
+
+/**
+ * Subsystem of the innermost allocation scope of each thread
+ */
+static thread_local int CURRENT_SUBSYSTEM = AllocTracker::Other;
+
+/**
+ * Makes @a subsystem the current subsystem of the calling thread
+ */
+AllocTracker::Scope::Scope(const Subsystem subsystem)
+    : m_previous(CURRENT_SUBSYSTEM)
+{
+    CURRENT_SUBSYSTEM = subsystem;
+}
+
+/**
+ * Restores the subsystem that was active before the scope was created
+ */
+AllocTracker::Scope::~Scope()
+{
+    CURRENT_SUBSYSTEM = m_previous;
+}
+
+/**
+ * Returns @c true if the application was built with allocation tracking
+ */
+bool AllocTracker::enabled()
+{
+#ifdef ALLOC_TRACKING
+    return true;
+#else
+    return false;
+#endif
+}
+
+/**
+ * Returns the number of allocations made by all subsystems
+ */
+quint64 AllocTracker::total()
+{
+    quint64 sum = 0;
+    for (int i = 0; i < SubsystemCount; ++i)
+        sum += COUNTERS[i].load(std::memory_order_relaxed);
+
+    return sum;
+}
+
+/**
+ * Returns the number of allocations made by the given @a subsystem
+ */
+quint64 AllocTracker::count(const Subsystem subsystem)
+{
+    return COUNTERS[subsystem].load(std::memory_order_relaxed);
+}
+
+/**
+ * Returns the name of the given @a subsystem, used in reports
+ */
+const char *AllocTracker::name(const Subsystem subsystem)
+{
+    switch (subsystem)
+    {
+        case Input:
+            return "input";
+        case Mapping:
+            return "mapping";
+        case Frame:
+            return "frame";
+        case Receive:
+            return "receive";
+        default:
+            return "other";
+    }
+}
+
+/**
+ * Counts an allocation made by the current subsystem of the calling thread
+ */
+void AllocTracker::allocated()
+{
+    COUNTERS[CURRENT_SUBSYSTEM].fetch_add(1, std::memory_order_relaxed);
+}
+
+//----------------------------------------------------------------------------------------
+// Replacements of the global allocation functions
+//----------------------------------------------------------------------------------------
+
+#ifdef ALLOC_TRACKING
+static void *allocate(std::size_t size)
+{
+    AllocTracker::allocated();
+    return std::malloc(size ? size : 1);
+}
+
+void *operator new(std::size_t size)
+{
+    auto pointer = allocate(size);
+    if (!pointer)
+        throw std::bad_alloc();
+
+    return pointer;
+}
+
+void *operator new[](std::size_t size)
+{
+    auto pointer = allocate(size);
+    if (!pointer)
+        throw std::bad_alloc();
+
+    return pointer;
+}
+
+void *operator new(std::size_t size, const std::nothrow_t &) noexcept
+{
+    return allocate(size);
+}
+
+void *operator new[](std::size_t size, const std::nothrow_t &) noexcept
+{
+    return allocate(size);
+}
+
+void operator delete(void *pointer) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete[](void *pointer) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete(void *pointer, std::size_t) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete[](void *pointer, std::size_t) noexcept
+{
+    std::free(pointer);
+}
+#endif
@@ -0,0 +1,75 @@
+/*
+ * Copyright (c) 2022 Alex Spataru <https://github.com/alex-spataru>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <QtGlobal>
+
+/**
+ * @brief The AllocTracker class
+ *
+ * Counts the heap allocations made by each subsystem of the pipeline. When the
+ * application is built with @c CONFIG+=alloc_tracking, the global @c operator new is
+ * replaced and every allocation is attributed to the subsystem of the innermost
+ * @c ALLOC_SCOPE() of the calling thread (or to @c Other if there is none).
+ *
+ * In regular builds, @c ALLOC_SCOPE() expands to nothing and all counters are zero.
+ */
+class AllocTracker
+{
+public:
+    enum Subsystem
+    {
+        Other,
+        Input,
+        Mapping,
+        Frame,
+        Receive,
+        SubsystemCount
+    };
+
+    class Scope
+    {
+    public:
+        explicit Scope(const Subsystem subsystem);
+        ~Scope();
+
+    private:
+        Scope(const Scope &) = delete;
+        Scope &operator=(const Scope &) = delete;
+
+    private:
+        int m_previous;
+    };
+
+    static bool enabled();
+    static quint64 total();
+    static quint64 count(const Subsystem subsystem);
+    static const char *name(const Subsystem subsystem);
+    static void allocated();
+};
+
+#ifdef ALLOC_TRACKING
+#    define ALLOC_SCOPE(subsystem) AllocTracker::Scope allocScope(subsystem)
+#else
+#    define ALLOC_SCOPE(subsystem)
+#endif
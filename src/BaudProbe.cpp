@@ -0,0 +1,116 @@
+/*
+ * Copyright (c) 2022 Alex Spataru <https://github.com/alex-spataru>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+#include "BaudProbe.h"
+
+#include <cstring>
+
+/**
+ * Constructor function
+ */
+BaudProbe::BaudProbe()
+    : m_framer(256)
+{
+    clear();
+}
+
+/**
+ * Discards the bytes received so far, e.g. before switching to another rate
+ */
+void BaudProbe::clear()
+{
+    memset(&m_score, 0, sizeof(m_score));
+    m_firstLine = true;
+    m_framer.clear();
+    m_overflows = m_framer.overflows();
+    m_text.clear();
+    m_binary.clear();
+}
+
+/**
+ * Returns the number of bytes, lines & binary frames received so far
+ */
+BaudProbe::Score BaudProbe::score() const
+{
+    return m_score;
+}
+
+/**
+ * Returns @c true if the received bytes show that the device is sending at the
+ * current rate.
+ */
+bool BaudProbe::accepted() const
+{
+    // Lines that are too long are not valid either
+    const auto overflows = m_framer.overflows() - m_overflows;
+    const auto lines = m_score.lines + static_cast<int>(overflows);
+    const auto invalidLines = lines - m_score.validLines;
+    if (m_score.validLines >= MIN_VALID && invalidLines * 4 <= m_score.validLines)
+        return true;
+
+    return m_score.frames >= MIN_VALID && m_score.invalidFrames * 4 <= m_score.frames;
+}
+
+/**
+ * Scores a chunk of @a length bytes received from the device
+ */
+void BaudProbe::append(const char *data, const int length)
+{
+    m_score.bytes += length;
+
+    // Text lines
+    m_framer.append(data, length, [this](const char *line, const int size) {
+        onLine(line, size);
+    });
+
+    // Binary frames
+    const auto errors = m_binary.errors();
+    m_binary.appendBinary(data, length, 0, [this](const TelemetryParser::Record &) {
+        ++m_score.frames;
+    });
+    m_score.invalidFrames += static_cast<int>(m_binary.errors() - errors);
+}
+
+/**
+ * Checks that a received line only contains printable characters & is either a
+ * control line or a valid telemetry line.
+ */
+void BaudProbe::onLine(const char *line, const int length)
+{
+    if (m_firstLine)
+    {
+        m_firstLine = false;
+        return;
+    }
+
+    ++m_score.lines;
+    for (int i = 0; i < length; ++i)
+    {
+        const auto c = static_cast<unsigned char>(line[i]);
+        if ((c < 0x20 && c != '\t' && c != '\r') || c > 0x7E)
+            return;
+    }
+
+    if (line[0] == '#' || m_text.parseLine(line, length, 0))
+        ++m_score.validLines;
+}
@@ -0,0 +1,72 @@
+/*
+ * Copyright (c) 2022 Alex Spataru <https://github.com/alex-spataru>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+#pragma once
+
+#include "LineFramer.h"
+#include "TelemetryParser.h"
+
+/**
+ * @brief The BaudProbe class
+ *
+ * Scores the bytes received at a candidate baud rate, to tell whether the device is
+ * sending at that rate. At a wrong rate, the bytes are decoded with framing errors &
+ * arrive as non-printable characters, lines that are not numbers and binary frames with
+ * a bad checksum.
+ *
+ * The rate is accepted once @c MIN_VALID valid text lines (telemetry or control lines,
+ * without the first line, which may have been cut) or binary telemetry frames have been
+ * received, with at most one invalid line or frame for every four valid ones.
+ */
+class BaudProbe
+{
+public:
+    static const int MIN_VALID = 2;
+
+    struct Score
+    {
+        quint64 bytes;
+        int lines;
+        int validLines;
+        int frames;
+        int invalidFrames;
+    };
+
+    BaudProbe();
+
+    void clear();
+    Score score() const;
+    bool accepted() const;
+    void append(const char *data, const int length);
+
+private:
+    void onLine(const char *line, const int length);
+
+private:
+    Score m_score;
+    bool m_firstLine;
+    quint64 m_overflows;
+    LineFramer m_framer;
+    TelemetryParser m_text;
+    TelemetryParser m_binary;
+};
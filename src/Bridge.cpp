@@ -0,0 +1,1025 @@
+/*
+ * Copyright (c) 2022 Alex Spataru <https://github.com/alex-spataru>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "Bridge.h"
+#include "Serial.h"
+#include "QJoysticks.h"
+#include "ReliableLink.h"
+
+#include <QDebug>
+#include <QCoreApplication>
+
+#include <cstring>
+
+/**
+ * Writes the decimal representation of @a value to @a buffer (which must have room for
+ * 11 characters), returns the number of characters written.
+ */
+static int formatInteger(const int value, char *buffer)
+{
+    char digits[10];
+    int count = 0;
+    auto magnitude = value < 0 ? 0u - static_cast<unsigned>(value)
+                               : static_cast<unsigned>(value);
+    do
+    {
+        digits[count++] = static_cast<char>('0' + magnitude % 10);
+        magnitude /= 10;
+    } while (magnitude > 0);
+
+    int length = 0;
+    if (value < 0)
+        buffer[length++] = '-';
+
+    while (count > 0)
+        buffer[length++] = digits[--count];
+
+    return length;
+}
+
+//----------------------------------------------------------------------------------------
+// Constructor & singleton access functions
+//----------------------------------------------------------------------------------------
+
+/**
+ * Constructor function, loads the built-in profile and starts sending frames every
+ * 250 milliseconds from the scheduler thread.
+ */
+Bridge::Bridge()
+    : m_lost(0)
+    , m_joystick(0)
+    , m_events(0)
+    , m_multiDevice(false)
+    , m_attached(0)
+    , m_failsafe(0)
+    , m_overBandwidth(0)
+    , m_frames(0)
+    , m_scheduler([this]() { sendData(); })
+{
+    // Load default mapping
+    memset(&m_stopStats, 0, sizeof(m_stopStats));
+    setProfile(Profile::defaultProfile());
+
+    // Create the serial driver in the main thread before the scheduler uses it
+    setDriver(&Serial::instance());
+
+    // clang-format off
+
+    // React to joystick input
+    QJoysticks::getInstance()->addListener(this);
+    connect(QJoysticks::getInstance(), &QJoysticks::countChanged,
+            this, &Bridge::onJoysticksChanged);
+
+    // Send command frames periodically
+    connect(&m_scheduler, &Scheduler::intervalChanged,
+            this, &Bridge::sendIntervalChanged);
+    connect(QCoreApplication::instance(), &QCoreApplication::aboutToQuit,
+            &m_scheduler, &Scheduler::stop);
+
+    // clang-format on
+
+    onJoysticksChanged();
+    m_scheduler.start();
+}
+
+/**
+ * Destructor function, stops receiving joystick input
+ */
+Bridge::~Bridge()
+{
+    QJoysticks::getInstance()->removeListener(this);
+}
+
+/**
+ * Returns the only instance of the class
+ */
+Bridge &Bridge::instance()
+{
+    static Bridge singleton;
+    return singleton;
+}
+
+//----------------------------------------------------------------------------------------
+// Member access functions
+//----------------------------------------------------------------------------------------
+
+/**
+ * Returns the index of the joystick that controls the output values, -1 if that
+ * joystick has been removed
+ */
+int Bridge::joystick() const
+{
+    return m_joystick;
+}
+
+/**
+ * Returns the number of command frames sent per second
+ */
+int Bridge::sendRate() const
+{
+    return m_scheduler.rate();
+}
+
+/**
+ * Returns the time (in microseconds) between each command frame
+ */
+int Bridge::sendInterval() const
+{
+    return m_scheduler.interval();
+}
+
+/**
+ * Returns @c true if each joystick is bound to its own output channel
+ */
+bool Bridge::multiDevice() const
+{
+    return m_multiDevice;
+}
+
+/**
+ * Returns the driver used to send the command frames
+ */
+HAL_Driver *Bridge::driver() const
+{
+    return m_driver.loadAcquire();
+}
+
+/**
+ * Builds a command frame with the current output values, e.g. "20,0,90,360\n" (or one
+ * line per attached joystick in multi-device mode).
+ */
+QByteArray Bridge::frame() const
+{
+    QByteArray data;
+    encodeFrame(data);
+    return data;
+}
+
+/**
+ * Returns the number of command frames written to the driver
+ */
+quint64 Bridge::frameCount() const
+{
+    return m_frames.loadAcquire();
+}
+
+/**
+ * Returns the number of axis & button events applied to the output values
+ */
+quint64 Bridge::eventCount() const
+{
+    return m_events;
+}
+
+/**
+ * Computes the outputs from the current joystick state, like before each frame is
+ * sent (mixer, expressions & shaping over one frame interval), then writes the
+ * resulting command frame to @a data without sending it. This is used to measure the
+ * generation of the frames when replaying input as fast as possible.
+ */
+void Bridge::computeFrame(QByteArray &data)
+{
+    computeOutputs();
+    encodeFrame(data);
+}
+
+/**
+ * Writes a command frame with the current output values to @a data. The memory of
+ * @a data is reused, so encoding a frame does not allocate memory once the buffer is
+ * large enough.
+ */
+void Bridge::encodeFrame(QByteArray &data) const
+{
+    QMutexLocker locker(&m_mutex);
+
+    // Reserve space for the channel numbers, longest integers, separators & line endings
+    int capacity = 0;
+    for (const auto &output : m_outputs)
+        capacity += output.values.count() * 12 + 13;
+
+    if (data.capacity() < capacity)
+        data.reserve(capacity);
+
+    data.resize(capacity);
+    auto buffer = data.data();
+
+    int length = 0;
+    const auto failsafe = m_failsafe.load() != 0;
+    for (const auto &output : m_outputs)
+    {
+        if (!m_multiDevice || output.attached || failsafe)
+            length += encodeOutput(output, m_multiDevice, buffer + length);
+    }
+
+    data.resize(length);
+}
+
+/**
+ * Returns @c true if the failsafe values are being sent instead of the joystick input
+ */
+bool Bridge::failsafe() const
+{
+    return m_failsafe.load() != 0;
+}
+
+/**
+ * Returns @c true if at least one of the joysticks that drive the outputs is attached
+ */
+bool Bridge::inputAttached() const
+{
+    return m_attached.load() > 0;
+}
+
+/**
+ * Returns @c true if a joystick bound to an output has been removed & has not been
+ * plugged back (or replaced by selecting another joystick) yet
+ */
+bool Bridge::inputLost() const
+{
+    return m_lost > 0;
+}
+
+/**
+ * Returns the number of emergency stops sent & the time (in microseconds) from the
+ * button event until the stop frame was transmitted.
+ */
+Bridge::StopStats Bridge::stopStats() const
+{
+    return m_stopStats;
+}
+
+/**
+ * Returns the number of frames & events processed so far, and the number of heap
+ * allocations made while building the frames or while mapping the events to the
+ * outputs. The allocations made by the input systems before the events reach the
+ * @c Bridge are not included. Allocations are only counted in builds with
+ * @c CONFIG+=alloc_tracking.
+ */
+Bridge::AllocationStats Bridge::allocationStats() const
+{
+    AllocationStats stats;
+    stats.frames = frameCount();
+    stats.events = eventCount();
+    stats.frameAllocations = AllocTracker::count(AllocTracker::Frame);
+    stats.mappingAllocations = AllocTracker::count(AllocTracker::Mapping);
+    return stats;
+}
+
+/**
+ * Returns the mapping profile currently in use
+ */
+const Profile &Bridge::profile() const
+{
+    return m_profile;
+}
+
+/**
+ * Returns the output channels used in multi-device mode (an empty list otherwise)
+ */
+QVector<Bridge::Channel> Bridge::channels() const
+{
+    QVector<Channel> channels;
+    if (!m_multiDevice)
+        return channels;
+
+    QMutexLocker locker(&m_mutex);
+    for (const auto &output : m_outputs)
+    {
+        Channel channel;
+        channel.number = output.number;
+        channel.joystick = output.joystick;
+        channel.profile = output.profile;
+        channels.append(channel);
+    }
+
+    return channels;
+}
+
+/**
+ * Returns the measured intervals between each command frame
+ */
+const TimingStats &Bridge::stats() const
+{
+    return m_scheduler.stats();
+}
+
+/**
+ * Returns the real-time settings of the scheduler thread
+ */
+Realtime::Settings Bridge::realtime() const
+{
+    return m_scheduler.realtime();
+}
+
+/**
+ * Changes the @a driver used to send the command frames, the driver must be safe to
+ * call from the scheduler thread.
+ */
+void Bridge::setDriver(HAL_Driver *driver)
+{
+    m_driver.storeRelease(driver);
+}
+
+/**
+ * Replaces the current mapping profile and resets all output values to zero. In
+ * multi-device mode, the profile is only used once the mode is disabled.
+ */
+void Bridge::setProfile(const Profile &profile)
+{
+    {
+        QMutexLocker locker(&m_mutex);
+        m_profile = profile;
+    }
+
+    if (!m_multiDevice)
+    {
+        Channel channel;
+        channel.number = 0;
+        channel.joystick = m_joystick;
+        channel.profile = profile;
+
+        QVector<Output> outputs = { createOutput(channel) };
+        replaceOutputs(outputs, false);
+    }
+
+    onJoysticksChanged();
+    Q_EMIT profileChanged();
+}
+
+/**
+ * Binds each joystick of the given list of @a channels to its own output channel &
+ * profile. An empty list disables the multi-device mode, in which case the selected
+ * joystick & the current profile are used again.
+ *
+ * A joystick can only drive one channel, if it appears several times, only its first
+ * channel receives its input.
+ */
+void Bridge::setChannels(const QVector<Channel> &channels)
+{
+    QVector<Output> outputs;
+    for (const auto &channel : channels)
+        outputs.append(createOutput(channel));
+
+    if (outputs.isEmpty())
+    {
+        Channel channel;
+        channel.number = 0;
+        channel.joystick = m_joystick;
+        channel.profile = m_profile;
+        outputs.append(createOutput(channel));
+    }
+
+    replaceOutputs(outputs, !channels.isEmpty());
+    onJoysticksChanged();
+    Q_EMIT channelsChanged();
+}
+
+/**
+ * Loads the profile stored at the given @a path, returns @c false and leaves the
+ * current profile untouched if the file is not valid.
+ */
+bool Bridge::loadProfile(const QString &path, QString *error)
+{
+    Profile profile;
+    if (!Profile::load(path, profile, error))
+        return false;
+
+    setProfile(profile);
+    return true;
+}
+
+//----------------------------------------------------------------------------------------
+// Frame generation
+//----------------------------------------------------------------------------------------
+
+/**
+ * Writes the current output values to the current driver, as long as a bound joystick
+ * is attached or the failsafe mode is active. This function is called from the
+ * scheduler thread.
+ */
+void Bridge::sendData()
+{
+    ALLOC_SCOPE(AllocTracker::Frame);
+
+    auto driver = m_driver.loadAcquire();
+    if (driver && (m_attached.load() || m_failsafe.load()))
+    {
+        computeOutputs();
+        encodeFrame(m_frame);
+        checkBandwidth(driver);
+        driver->write(m_frame);
+        m_frames.fetchAndAddRelease(1);
+    }
+}
+
+/**
+ * Warns once when the frames, sent at the current rate, need more bytes per second
+ * than the @a driver can send. The frames would then pile up in the output queue of
+ * the driver until they are dropped.
+ */
+void Bridge::checkBandwidth(const HAL_Driver *driver)
+{
+    const auto available = driver->bytesPerSecond();
+    const auto needed = qint64(m_frame.size()) * m_scheduler.rate();
+    const auto exceeded = available > 0 && needed > available;
+    if (exceeded == (m_overBandwidth.load() != 0))
+        return;
+
+    m_overBandwidth.store(exceeded ? 1 : 0);
+    if (exceeded)
+        qWarning() << "Frames need" << needed << "bytes/s, the device can only send"
+                   << available << "bytes/s";
+}
+
+/**
+ * Clears the frame interval statistics
+ */
+void Bridge::resetStats()
+{
+    m_scheduler.resetStats();
+}
+
+/**
+ * Sends the emergency stop frame of the current profile right away (e.g. when
+ * requested by the user interface).
+ */
+void Bridge::emergencyStop()
+{
+    sendEmergencyStop(m_profile.emergencyStop(), QJoystickEvent::currentTime());
+}
+
+/**
+ * Selects the joystick that controls the output values (when the multi-device mode is
+ * disabled). The output is bound to the joystick found at that @a index, even if it
+ * is the index of the joystick that was bound before, which replaces a joystick that
+ * has been removed.
+ */
+void Bridge::setJoystick(const int index)
+{
+    const auto changed = m_joystick != index;
+    m_joystick = index;
+    if (!m_multiDevice)
+    {
+        QMutexLocker locker(&m_mutex);
+        auto &output = m_outputs.first();
+        output.joystick = index;
+        output.device = nullptr;
+        output.deviceName.clear();
+    }
+
+    onJoysticksChanged();
+    if (changed)
+        Q_EMIT joystickChanged();
+}
+
+/**
+ * Changes the number of command frames sent per second (up to 1 kHz)
+ */
+void Bridge::setSendRate(const int hz)
+{
+    m_scheduler.setRate(hz);
+}
+
+/**
+ * Changes the time (in microseconds) between each command frame
+ */
+void Bridge::setSendInterval(const int usec)
+{
+    m_scheduler.setInterval(usec);
+}
+
+/**
+ * Changes the real-time scheduling @a settings of the thread that sends the frames
+ */
+void Bridge::setRealtime(const Realtime::Settings &settings)
+{
+    m_scheduler.setRealtime(settings);
+}
+
+/**
+ * Enters or leaves the failsafe mode. When entering it, every output is set to its
+ * failsafe value, the first failsafe frame is written right away through the priority
+ * lane of the driver & frames are sent at (at least) @a hz frames per second. The send
+ * interval itself is not changed, so changes made by the user meanwhile are kept & the
+ * interval statistics are not cleared.
+ */
+void Bridge::setFailsafe(const bool active, const int hz)
+{
+    if (failsafe() == active)
+        return;
+
+    if (active)
+    {
+        {
+            QMutexLocker locker(&m_mutex);
+            for (auto &output : m_outputs)
+            {
+                for (int i = 0; i < output.values.count(); ++i)
+                {
+                    const auto value = output.profile.output(i).failsafe;
+                    output.values[i] = output.profile.clamp(i, value);
+                }
+
+                // Failsafe values are sent without shaping
+                for (int i = 0; i < output.shaped.count(); ++i)
+                    Shaper::reset(output.shaped[i], output.values.at(i));
+
+                // Expressions start from neutral input once the watchdog recovers
+                output.axes.fill(0);
+                output.buttons.fill(0);
+            }
+        }
+
+        m_failsafe.store(1);
+        m_scheduler.setMinimumRate(hz);
+
+        auto driver = m_driver.loadAcquire();
+        if (driver)
+        {
+            encodeFrame(m_failsafeFrame);
+            driver->writeUrgent(m_failsafeFrame, 1);
+        }
+    }
+
+    else
+    {
+        m_failsafe.store(0);
+        m_scheduler.setMinimumRate(0);
+    }
+
+    Q_EMIT failsafeChanged();
+}
+
+/**
+ * Finds the joystick bound to the given @a output in the list of @a devices & returns
+ * its index, or -1 if it is not attached:
+ *
+ * - An output that is bound to a device keeps it, wherever it is in the list.
+ * - An output whose device has been removed takes the first device with the same name
+ *   that is not bound to another output.
+ * - An output that has never been bound takes the device at its joystick index.
+ */
+int Bridge::findDevice(const QList<QJoystickDevice *> &devices,
+                       const Output &output) const
+{
+    if (output.deviceName.isEmpty())
+        return output.joystick < devices.count() ? output.joystick : -1;
+
+    if (output.device)
+    {
+        const auto index = devices.indexOf(const_cast<QJoystickDevice *>(output.device));
+        if (index >= 0 && devices.at(index)->name == output.deviceName)
+            return index;
+    }
+
+    for (int i = 0; i < devices.count(); ++i)
+    {
+        if (devices.at(i)->name != output.deviceName)
+            continue;
+
+        bool bound = false;
+        for (const auto &other : m_outputs)
+            bound |= (&other != &output && other.device == devices.at(i));
+
+        if (!bound)
+            return i;
+    }
+
+    return -1;
+}
+
+/**
+ * Binds each output channel to its joystick, rebuilds the table that routes the events
+ * of each device to its output channel and updates the number of attached joysticks,
+ * which is used by the scheduler thread since @c QJoysticks may only be accessed from
+ * the main thread.
+ *
+ * The joystick index of an output follows its joystick when the list of joysticks
+ * changes, & becomes -1 if the joystick has been removed.
+ */
+void Bridge::onJoysticksChanged()
+{
+    const auto devices = QJoysticks::getInstance()->inputDevices();
+
+    int lost = 0;
+    int attached = 0;
+    auto joystick = m_joystick;
+    {
+        QMutexLocker locker(&m_mutex);
+        m_routes.clear();
+        for (int i = 0; i < m_outputs.count(); ++i)
+        {
+            auto &output = m_outputs[i];
+            const auto index = findDevice(devices, output);
+            output.attached = (index >= 0);
+            if (!output.attached)
+            {
+                output.device = nullptr;
+                if (!output.deviceName.isEmpty())
+                {
+                    output.joystick = -1;
+                    ++lost;
+                }
+
+                continue;
+            }
+
+            auto device = devices.at(index);
+            output.joystick = index;
+            output.device = device;
+            output.deviceName = device->name;
+
+            ++attached;
+            if (!device->blacklisted && !m_routes.contains(device))
+                m_routes.insert(device, i);
+        }
+
+        if (!m_multiDevice)
+            joystick = m_outputs.first().joystick;
+    }
+
+    m_lost = lost;
+    m_attached.store(attached);
+    if (m_joystick != joystick)
+    {
+        m_joystick = joystick;
+        Q_EMIT joystickChanged();
+    }
+}
+
+/**
+ * Applies a batch of joystick @a events, called directly by @c QJoysticks
+ */
+void Bridge::joystickEvents(const QJoystickEvent *events, const int count)
+{
+    for (int i = 0; i < count; ++i)
+    {
+        const auto &event = events[i];
+        if (event.type == QJoystickEvent::AxisEvent)
+            onAxisEvent(event.axis);
+        else if (event.type == QJoystickEvent::ButtonEvent)
+            onButtonEvent(event.button, event.timestamp);
+    }
+}
+
+/**
+ * Updates the outputs driven by the given axis, on the channel of the device that
+ * generated the @a event (unless the failsafe mode is active).
+ */
+void Bridge::onAxisEvent(const QJoystickAxisEvent &event)
+{
+    auto route = m_routes.constFind(event.joystick);
+    if (route == m_routes.constEnd() || m_failsafe.load())
+        return;
+
+    ALLOC_SCOPE(AllocTracker::Mapping);
+
+    ++m_events;
+    QMutexLocker locker(&m_mutex);
+    auto &output = m_outputs[route.value()];
+    const auto &bindings = output.profile.axisBindings(event.axis);
+    for (int i = 0; i < bindings.count(); ++i)
+    {
+        const auto &binding = bindings.at(i);
+        auto value = event.value * binding.scale;
+        output.values[binding.output] = output.profile.clamp(binding.output, value);
+    }
+
+    if (event.axis >= 0 && event.axis < output.axes.count())
+        output.axes[event.axis] = event.value;
+}
+
+/**
+ * Runs the press/release actions of the given button, on the channel of the device
+ * that generated the @a event. The @a timestamp of the event is the reference of the
+ * emergency stop latency.
+ */
+void Bridge::onButtonEvent(const QJoystickButtonEvent &event, const qint64 timestamp)
+{
+    auto route = m_routes.constFind(event.joystick);
+    if (route == m_routes.constEnd())
+        return;
+
+    // Emergency stop, send it before anything else (outputs only change in this thread)
+    const auto &stop = m_outputs.at(route.value()).profile.emergencyStop();
+    if (event.pressed && event.button == stop.button)
+        sendEmergencyStop(stop, timestamp);
+
+    // Keep the failsafe values until the watchdog recovers
+    if (m_failsafe.load())
+        return;
+
+    ALLOC_SCOPE(AllocTracker::Mapping);
+
+    ++m_events;
+    QMutexLocker locker(&m_mutex);
+    auto &output = m_outputs[route.value()];
+    if (event.pressed)
+        applyActions(output, output.profile.pressActions(event.button));
+    else
+        applyActions(output, output.profile.releaseActions(event.button));
+
+    // The values set by the emergency stop button are sent without shaping
+    if (event.pressed && event.button == stop.button)
+    {
+        for (int i = 0; i < output.shaped.count(); ++i)
+            Shaper::reset(output.shaped[i], output.values.at(i));
+    }
+
+    if (event.button >= 0 && event.button < output.buttons.count())
+        output.buttons[event.button] = event.pressed ? 1 : 0;
+}
+
+//----------------------------------------------------------------------------------------
+// Output channels
+//----------------------------------------------------------------------------------------
+
+/**
+ * Creates the output channel described by @a channel, with every value set to zero.
+ * If the profile mixes axes, has output expressions or shapes its outputs, the snapshot
+ * of the joystick state, the registers used to evaluate the expressions & the state
+ * of the shaped outputs are allocated here, once.
+ */
+Bridge::Output Bridge::createOutput(const Channel &channel)
+{
+    Output output;
+    output.number = channel.number;
+    output.joystick = channel.joystick;
+    output.attached = false;
+    output.device = nullptr;
+    output.profile = channel.profile;
+    output.values.fill(0, output.profile.outputCount());
+    for (int i = 0; i < output.values.count(); ++i)
+        output.values[i] = output.profile.clamp(i, 0);
+
+    const auto &transforms = output.profile.transforms();
+    if (!transforms.isEmpty() || !output.profile.mixer().isEmpty())
+    {
+        output.axes.fill(0, Expression::MAX_INPUTS);
+        output.buttons.fill(0, Expression::MAX_INPUTS);
+        output.registers.fill(0, output.profile.registerCount());
+        output.memory.fill(0, output.profile.memoryCount());
+        for (const auto &transform : transforms)
+        {
+            transform.expression.initialize(
+                output.registers.data() + transform.registerOffset,
+                output.memory.data() + transform.memoryOffset);
+        }
+    }
+
+    if (output.profile.hasShaping())
+    {
+        output.shaped.resize(output.values.count());
+        for (int i = 0; i < output.values.count(); ++i)
+            Shaper::reset(output.shaped[i], output.values.at(i));
+    }
+
+    return output;
+}
+
+/**
+ * Computes the outputs of every channel that are mixed or driven by an expression,
+ * from the last joystick state received, then shapes the values to send: axes are
+ * mixed first, the expressions are evaluated in the order in which they appear in the
+ * profile (so they can use the mixed values) and every output of a profile with
+ * limits moves towards its new value during one frame interval.
+ *
+ * This function is called from the scheduler thread before each frame is encoded, it
+ * does not allocate memory. Outputs are not computed in failsafe mode.
+ */
+void Bridge::computeOutputs()
+{
+    QMutexLocker locker(&m_mutex);
+    if (m_failsafe.load())
+        return;
+
+    const auto dt = m_scheduler.interval() / 1e6;
+    for (auto &output : m_outputs)
+    {
+        auto values = output.values.data();
+        const auto &profile = output.profile;
+
+        // Mix axes
+        const auto &mixer = profile.mixer();
+        if (!mixer.isEmpty())
+        {
+            float mixed[Mixer::MAX_OUTPUTS];
+            mixer.mix(output.axes.constData(), output.axes.count(), mixed);
+            for (int i = 0; i < mixer.outputCount(); ++i)
+            {
+                const auto target = mixer.outputTarget(i);
+                values[target] = profile.clamp(target, mixed[i]);
+            }
+        }
+
+        // Evaluate expressions
+        const auto &transforms = profile.transforms();
+        if (!transforms.isEmpty())
+        {
+            auto registers = output.registers.data();
+            auto memory = output.memory.data();
+
+            Expression::Inputs inputs;
+            inputs.axes = output.axes.constData();
+            inputs.axisCount = output.axes.count();
+            inputs.buttons = output.buttons.constData();
+            inputs.buttonCount = output.buttons.count();
+            inputs.outputs = values;
+            inputs.outputCount = output.values.count();
+
+            for (const auto &transform : transforms)
+            {
+                const auto value = transform.expression.evaluate(
+                    inputs, registers + transform.registerOffset,
+                    memory + transform.memoryOffset);
+
+                values[transform.output] = profile.clamp(transform.output, value);
+            }
+        }
+
+        // Shape the values to send
+        if (!output.shaped.isEmpty())
+        {
+            auto shaped = output.shaped.data();
+            for (int i = 0; i < output.values.count(); ++i)
+                Shaper::step(shaped[i], values[i], profile.output(i).shaping, dt);
+        }
+    }
+}
+
+/**
+ * Replaces the current output channels with @a outputs, which receives the previous
+ * channels, and enables or disables the @a multiDevice mode at the same time. This
+ * function is used to apply a new profile (e.g. when the profile file is edited)
+ * without disturbing the frames being sent:
+ *
+ * - The new channels are built by the caller, outside of the lock.
+ * - Each new output keeps the current value of the output with the same name in the
+ *   channel with the same number, so that a held axis or a toggled button keeps its
+ *   effect, and shaped outputs continue their motion. In failsafe mode, the failsafe
+ *   values of the new profile are used instead.
+ * - The joystick state seen by the mixer & the expressions is carried over in the
+ *   same way, as well as the joystick bound to the channel (unless the channel now
+ *   uses another joystick index).
+ * - The scheduler thread is only blocked while the values are carried over & the
+ *   channel vectors are swapped, the previous channels are released by the caller
+ *   after the lock.
+ */
+void Bridge::replaceOutputs(QVector<Output> &outputs, const bool multiDevice)
+{
+    QMutexLocker locker(&m_mutex);
+    const auto failsafe = m_failsafe.load() != 0;
+    for (auto &output : outputs)
+    {
+        const Output *previous = nullptr;
+        for (const auto &current : m_outputs)
+        {
+            if (current.number == output.number)
+            {
+                previous = &current;
+                break;
+            }
+        }
+
+        for (int i = 0; i < output.values.count(); ++i)
+        {
+            const auto &field = output.profile.output(i);
+            const auto index = previous ? previous->profile.outputIndex(field.name) : -1;
+            if (failsafe)
+                output.values[i] = output.profile.clamp(i, field.failsafe);
+            else if (index >= 0)
+                output.values[i] = output.profile.clamp(i, previous->values.at(index));
+
+            // Shaped outputs continue from the value being sent
+            if (output.shaped.isEmpty())
+                continue;
+
+            if (!failsafe && index >= 0 && !previous->shaped.isEmpty())
+                output.shaped[i] = previous->shaped.at(index);
+            else
+                Shaper::reset(output.shaped[i], output.values.at(i));
+        }
+
+        if (!previous)
+            continue;
+
+        // Keep the joystick bound to the channel if the channel still uses it
+        if (previous->joystick == output.joystick)
+        {
+            output.device = previous->device;
+            output.deviceName = previous->deviceName;
+        }
+
+        // Copy the joystick state without sharing (& later detaching) the buffers
+        output.attached = previous->attached;
+        if (!output.axes.isEmpty() && !previous->axes.isEmpty())
+        {
+            const auto size = sizeof(double) * Expression::MAX_INPUTS;
+            memcpy(output.axes.data(), previous->axes.constData(), size);
+            memcpy(output.buttons.data(), previous->buttons.constData(), size);
+        }
+    }
+
+    m_outputs.swap(outputs);
+    m_multiDevice = multiDevice;
+}
+
+/**
+ * Writes the values of the given @a output to @a buffer, preceded by the channel
+ * number if @a prefix is @c true. Returns the number of characters written.
+ */
+int Bridge::encodeOutput(const Output &output, const bool prefix, char *buffer)
+{
+    int length = 0;
+    if (prefix)
+    {
+        length += formatInteger(output.number, buffer);
+        buffer[length++] = ':';
+    }
+
+    for (int i = 0; i < output.values.count(); ++i)
+    {
+        if (i > 0)
+            buffer[length++] = ',';
+
+        auto value = output.shaped.isEmpty() ? output.values.at(i)
+                                             : output.shaped.at(i).value;
+        value *= output.profile.output(i).scale;
+        length += formatInteger(static_cast<int>(value), buffer + length);
+    }
+
+    buffer[length++] = '\n';
+    return length;
+}
+
+/**
+ * Updates the values of the given @a output according to the given list of
+ * @a actions, the caller must hold the output values mutex.
+ */
+void Bridge::applyActions(Output &output, const QVector<Profile::Action> &actions)
+{
+    for (int i = 0; i < actions.count(); ++i)
+    {
+        const auto &action = actions.at(i);
+        auto value = action.value;
+        if (action.type == Profile::AddValue)
+            value += output.values.at(action.output);
+
+        output.values[action.output] = output.profile.clamp(action.output, value);
+    }
+}
+
+//----------------------------------------------------------------------------------------
+// Emergency stop
+//----------------------------------------------------------------------------------------
+
+/**
+ * Writes the given emergency @a stop frame through the priority lane of the driver,
+ * without waiting for the next periodic frame, and records the time elapsed from the
+ * input event @a timestamp (see @c QJoystickEvent::currentTime()) until the frame is
+ * expected to be transmitted, from the data still queued by the driver. In reliable
+ * mode, the frame is also sent as a critical command so that it is retransmitted until
+ * the firmware acknowledges it.
+ */
+void Bridge::sendEmergencyStop(const Profile::EmergencyStop &stop,
+                               const qint64 timestamp)
+{
+    auto driver = m_driver.loadAcquire();
+    if (!driver || stop.button < 0)
+        return;
+
+    driver->writeUrgent(stop.frame, stop.repeat);
+
+    const auto transmitted = QJoystickEvent::currentTime() + driver->transmitDelay();
+    const auto elapsed = transmitted - timestamp;
+    if (m_stopStats.count == 0 || elapsed < m_stopStats.minimum)
+        m_stopStats.minimum = elapsed;
+
+    ++m_stopStats.count;
+    m_stopStats.last = elapsed;
+    m_stopStats.maximum = qMax(m_stopStats.maximum, elapsed);
+
+    if (ReliableLink::instance().enabled())
+        ReliableLink::instance().send(stop.frame.chopped(1));
+
+    Q_EMIT emergencyStopSent();
+}
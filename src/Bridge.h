@@ -0,0 +1,212 @@
+/*
+ * Copyright (c) 2022 Alex Spataru <https://github.com/alex-spataru>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <QHash>
+#include <QMutex>
+#include <QObject>
+#include <QVector>
+#include <QAtomicInt>
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QAtomicInteger>
+#include <QAtomicPointer>
+
+#include "Profile.h"
+#include "QJoysticks.h"
+#include "AllocTracker.h"
+#include "HAL_Driver.h"
+#include "Realtime.h"
+#include "Scheduler.h"
+#include "TimingStats.h"
+
+/**
+ * @brief The Bridge class
+ *
+ * Turns joystick input into command frames and periodically writes them to the serial
+ * device. The input-to-output mapping is defined by the current @c Profile, which allows
+ * the same pipeline to be used by the user interface and by the headless mode.
+ *
+ * Input events are processed in the main thread, while frames are sent from a
+ * dedicated @c Scheduler thread. The output values are protected by a mutex. The
+ * events are received as batches from a @c QJoysticks listener, not through signals.
+ *
+ * Frames are written to the serial port by default, any other @c HAL_Driver (e.g. a
+ * loopback driver used by the benchmarks) can be used instead.
+ *
+ * In multi-device mode, each joystick is bound to its own output channel with its own
+ * profile. Every frame then contains one line per attached joystick, prefixed with the
+ * channel number (e.g. "2:20,0,90,360\n"). Input events are routed to their channel
+ * through a table indexed by the device that generated them.
+ *
+ * Each output stays bound to the joystick it was given when other joysticks are
+ * plugged or unplugged, even if the index of that joystick changes. If the joystick is
+ * removed, its output waits for a joystick with the same name (e.g. the same controller
+ * plugged back) & the input is reported as lost, so that the @c Watchdog enters the
+ * failsafe mode.
+ *
+ * The emergency stop button of a profile bypasses the periodic frames: its stop frame
+ * is written through the priority lane of the driver as soon as the button is pressed,
+ * and the time from the input event (as timestamped by the input system) to the frame
+ * being transmitted is recorded.
+ *
+ * In failsafe mode (see @c Watchdog), every output is set to the failsafe value of its
+ * profile & input events are ignored. Frames are then sent even if no joystick is
+ * attached, at a higher rate, until the failsafe mode is left.
+ */
+class Bridge : public QObject, private QJoystickListener
+{
+    Q_OBJECT
+
+public:
+    struct Channel
+    {
+        int number;
+        int joystick;
+        Profile profile;
+    };
+
+    struct StopStats
+    {
+        quint64 count;
+        qint64 last;
+        qint64 minimum;
+        qint64 maximum;
+    };
+
+    struct AllocationStats
+    {
+        quint64 frames;
+        quint64 events;
+        quint64 frameAllocations;
+        quint64 mappingAllocations;
+    };
+
+Q_SIGNALS:
+    void profileChanged();
+    void channelsChanged();
+    void joystickChanged();
+    void sendIntervalChanged();
+    void failsafeChanged();
+    void emergencyStopSent();
+
+private:
+    explicit Bridge();
+    ~Bridge();
+    Bridge(Bridge &&) = delete;
+    Bridge(const Bridge &) = delete;
+    Bridge &operator=(Bridge &&) = delete;
+    Bridge &operator=(const Bridge &) = delete;
+
+public:
+    static Bridge &instance();
+
+    int joystick() const;
+    int sendRate() const;
+    bool multiDevice() const;
+    int sendInterval() const;
+    bool failsafe() const;
+    bool inputAttached() const;
+    bool inputLost() const;
+    HAL_Driver *driver() const;
+    QByteArray frame() const;
+    quint64 frameCount() const;
+    quint64 eventCount() const;
+    void encodeFrame(QByteArray &data) const;
+    void computeFrame(QByteArray &data);
+    StopStats stopStats() const;
+    AllocationStats allocationStats() const;
+    const Profile &profile() const;
+    QVector<Channel> channels() const;
+    const TimingStats &stats() const;
+    Realtime::Settings realtime() const;
+
+    void setDriver(HAL_Driver *driver);
+    void setProfile(const Profile &profile);
+    void setChannels(const QVector<Channel> &channels);
+    bool loadProfile(const QString &path, QString *error = nullptr);
+
+public Q_SLOTS:
+    void sendData();
+    void resetStats();
+    void emergencyStop();
+    void setJoystick(const int index);
+    void setSendRate(const int hz);
+    void setSendInterval(const int usec);
+    void setRealtime(const Realtime::Settings &settings);
+    void setFailsafe(const bool active, const int hz);
+
+private Q_SLOTS:
+    void onJoysticksChanged();
+
+private:
+    void joystickEvents(const QJoystickEvent *events, const int count) override;
+    void onAxisEvent(const QJoystickAxisEvent &event);
+    void onButtonEvent(const QJoystickButtonEvent &event, const qint64 timestamp);
+
+private:
+    struct Output
+    {
+        int number;
+        int joystick;
+        bool attached;
+        QString deviceName;
+        const QJoystickDevice *device;
+        Profile profile;
+        QVector<double> values;
+        QVector<double> axes;
+        QVector<double> buttons;
+        QVector<double> registers;
+        QVector<double> memory;
+        QVector<Shaper::State> shaped;
+    };
+
+    static Output createOutput(const Channel &channel);
+    int findDevice(const QList<QJoystickDevice *> &devices, const Output &output) const;
+    void computeOutputs();
+    void checkBandwidth(const HAL_Driver *driver);
+    void replaceOutputs(QVector<Output> &outputs, const bool multiDevice);
+    static int encodeOutput(const Output &output, const bool prefix, char *buffer);
+    static void applyActions(Output &output, const QVector<Profile::Action> &actions);
+    void sendEmergencyStop(const Profile::EmergencyStop &stop, const qint64 timestamp);
+
+private:
+    int m_lost;
+    int m_joystick;
+    quint64 m_events;
+    bool m_multiDevice;
+    QByteArray m_frame;
+    Profile m_profile;
+    StopStats m_stopStats;
+    QByteArray m_failsafeFrame;
+    QVector<Output> m_outputs;
+    QHash<const QJoystickDevice *, int> m_routes;
+
+    mutable QMutex m_mutex;
+    QAtomicInt m_attached;
+    QAtomicInt m_failsafe;
+    QAtomicInt m_overBandwidth;
+    QAtomicInteger<quint64> m_frames;
+    QAtomicPointer<HAL_Driver> m_driver;
+    Scheduler m_scheduler;
+};
@@ -0,0 +1,59 @@
+#-------------------------------------------------------------------------------
+# Nucleo de la aplicacion (entrada, mapeo, envio de tramas & puerto serial)
+#-------------------------------------------------------------------------------
+
+QT += core
+QT += serialport
+
+INCLUDEPATH += $$PWD
+
+# Contar asignaciones de memoria por subsistema (CONFIG+=alloc_tracking)
+alloc_tracking {
+    DEFINES += ALLOC_TRACKING
+}
+
+HEADERS += \
+    $$PWD/AllocTracker.h \
+    $$PWD/BaudProbe.h \
+    $$PWD/Bridge.h \
+    $$PWD/Expression.h \
+    $$PWD/HAL_Driver.h \
+    $$PWD/InputLog.h \
+    $$PWD/InputPlayer.h \
+    $$PWD/InputRecorder.h \
+    $$PWD/LineFramer.h \
+    $$PWD/Mixer.h \
+    $$PWD/Profile.h \
+    $$PWD/ProfileWatcher.h \
+    $$PWD/Realtime.h \
+    $$PWD/ReliableLink.h \
+    $$PWD/Scheduler.h \
+    $$PWD/Serial.h \
+    $$PWD/SerialCapture.h \
+    $$PWD/Shaper.h \
+    $$PWD/Telemetry.h \
+    $$PWD/TelemetryParser.h \
+    $$PWD/TimingStats.h \
+    $$PWD/Watchdog.h
+
+SOURCES += \
+    $$PWD/AllocTracker.cpp \
+    $$PWD/BaudProbe.cpp \
+    $$PWD/Bridge.cpp \
+    $$PWD/Expression.cpp \
+    $$PWD/InputPlayer.cpp \
+    $$PWD/InputRecorder.cpp \
+    $$PWD/LineFramer.cpp \
+    $$PWD/Mixer.cpp \
+    $$PWD/Profile.cpp \
+    $$PWD/ProfileWatcher.cpp \
+    $$PWD/Realtime.cpp \
+    $$PWD/ReliableLink.cpp \
+    $$PWD/Scheduler.cpp \
+    $$PWD/Serial.cpp \
+    $$PWD/SerialCapture.cpp \
+    $$PWD/Shaper.cpp \
+    $$PWD/Telemetry.cpp \
+    $$PWD/TelemetryParser.cpp \
+    $$PWD/TimingStats.cpp \
+    $$PWD/Watchdog.cpp
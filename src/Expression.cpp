@@ -0,0 +1,713 @@
+/*
+ * Copyright (c) 2022 Alex Spataru <https://github.com/alex-spataru>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+#include "Expression.h"
+
+#include <cmath>
+
+//----------------------------------------------------------------------------------------
+// Compiler
+//----------------------------------------------------------------------------------------
+
+/**
+ * @brief The ExpressionCompiler class
+ *
+ * Recursive descent parser that emits the instructions of an expression while parsing
+ * it. Each function returns the register that holds the value of the parsed
+ * sub-expression, or -1 on error.
+ */
+class ExpressionCompiler
+{
+public:
+    ExpressionCompiler(const QString &source, const QStringList &outputs,
+                       Expression &expression);
+
+    bool compile(QString *error);
+
+private:
+    int parseConditional();
+    int parseOr();
+    int parseAnd();
+    int parseEquality();
+    int parseRelational();
+    int parseAdditive();
+    int parseMultiplicative();
+    int parseUnary();
+    int parsePrimary();
+    int parseFunction(const QString &name);
+    int parseVariable(const QString &name);
+
+    int constant(const double value);
+    int append(const int opcode, const int a, const int b = 0, const int c = 0);
+    int fail(const QString &message);
+
+    bool atEnd();
+    bool accept(const char *token);
+    QString identifier();
+
+private:
+    int m_position;
+    QString m_error;
+    const QString &m_source;
+    const QStringList &m_outputs;
+    Expression &m_expression;
+};
+
+/**
+ * Constructor function
+ */
+ExpressionCompiler::ExpressionCompiler(const QString &source, const QStringList &outputs,
+                                       Expression &expression)
+    : m_position(0)
+    , m_source(source)
+    , m_outputs(outputs)
+    , m_expression(expression)
+{
+}
+
+/**
+ * Compiles the whole source, returns @c false & writes the reason to @a error if the
+ * source is not a valid expression.
+ */
+bool ExpressionCompiler::compile(QString *error)
+{
+    const auto result = parseConditional();
+    if (result >= 0 && !atEnd())
+        fail("Unexpected character");
+
+    if (!m_error.isEmpty())
+    {
+        if (error)
+            *error = QString("%1 at position %2").arg(m_error).arg(m_position + 1);
+
+        return false;
+    }
+
+    m_expression.m_result = result;
+    return true;
+}
+
+/**
+ * condition ? value : value
+ */
+int ExpressionCompiler::parseConditional()
+{
+    const auto condition = parseOr();
+    if (condition < 0 || !accept("?"))
+        return condition;
+
+    const auto first = parseConditional();
+    if (first < 0)
+        return -1;
+    if (!accept(":"))
+        return fail("Expected ':'");
+
+    const auto second = parseConditional();
+    if (second < 0)
+        return -1;
+
+    return append(Expression::Select, condition, first, second);
+}
+
+/**
+ * value || value
+ */
+int ExpressionCompiler::parseOr()
+{
+    auto left = parseAnd();
+    while (left >= 0 && accept("||"))
+    {
+        const auto right = parseAnd();
+        left = right < 0 ? -1 : append(Expression::Or, left, right);
+    }
+
+    return left;
+}
+
+/**
+ * value && value
+ */
+int ExpressionCompiler::parseAnd()
+{
+    auto left = parseEquality();
+    while (left >= 0 && accept("&&"))
+    {
+        const auto right = parseEquality();
+        left = right < 0 ? -1 : append(Expression::And, left, right);
+    }
+
+    return left;
+}
+
+/**
+ * value == value, value != value
+ */
+int ExpressionCompiler::parseEquality()
+{
+    auto left = parseRelational();
+    while (left >= 0)
+    {
+        int opcode;
+        if (accept("=="))
+            opcode = Expression::Equal;
+        else if (accept("!="))
+            opcode = Expression::NotEqual;
+        else
+            break;
+
+        const auto right = parseRelational();
+        left = right < 0 ? -1 : append(opcode, left, right);
+    }
+
+    return left;
+}
+
+/**
+ * value < value, value <= value, value > value, value >= value
+ */
+int ExpressionCompiler::parseRelational()
+{
+    auto left = parseAdditive();
+    while (left >= 0)
+    {
+        int opcode;
+        if (accept("<="))
+            opcode = Expression::LessEqual;
+        else if (accept("<"))
+            opcode = Expression::Less;
+        else if (accept(">="))
+            opcode = Expression::GreaterEqual;
+        else if (accept(">"))
+            opcode = Expression::Greater;
+        else
+            break;
+
+        const auto right = parseAdditive();
+        left = right < 0 ? -1 : append(opcode, left, right);
+    }
+
+    return left;
+}
+
+/**
+ * value + value, value - value
+ */
+int ExpressionCompiler::parseAdditive()
+{
+    auto left = parseMultiplicative();
+    while (left >= 0)
+    {
+        int opcode;
+        if (accept("+"))
+            opcode = Expression::Add;
+        else if (accept("-"))
+            opcode = Expression::Subtract;
+        else
+            break;
+
+        const auto right = parseMultiplicative();
+        left = right < 0 ? -1 : append(opcode, left, right);
+    }
+
+    return left;
+}
+
+/**
+ * value * value, value / value, value % value
+ */
+int ExpressionCompiler::parseMultiplicative()
+{
+    auto left = parseUnary();
+    while (left >= 0)
+    {
+        int opcode;
+        if (accept("*"))
+            opcode = Expression::Multiply;
+        else if (accept("/"))
+            opcode = Expression::Divide;
+        else if (accept("%"))
+            opcode = Expression::Modulo;
+        else
+            break;
+
+        const auto right = parseUnary();
+        left = right < 0 ? -1 : append(opcode, left, right);
+    }
+
+    return left;
+}
+
+/**
+ * -value, +value, !value. Negative numbers are folded into a constant.
+ */
+int ExpressionCompiler::parseUnary()
+{
+    if (accept("-"))
+    {
+        const auto operand = parseUnary();
+        if (operand < 0)
+            return -1;
+
+        for (const auto &constant : m_expression.m_constants)
+        {
+            if (constant.target == operand)
+                return this->constant(-constant.value);
+        }
+
+        return append(Expression::Negate, operand);
+    }
+
+    if (accept("+"))
+        return parseUnary();
+
+    if (accept("!"))
+    {
+        const auto operand = parseUnary();
+        return operand < 0 ? -1 : append(Expression::Not, operand);
+    }
+
+    return parsePrimary();
+}
+
+/**
+ * (value), number, variable or function call
+ */
+int ExpressionCompiler::parsePrimary()
+{
+    if (accept("("))
+    {
+        const auto value = parseConditional();
+        if (value < 0)
+            return -1;
+
+        return accept(")") ? value : fail("Expected ')'");
+    }
+
+    if (atEnd())
+        return fail("Unexpected end of expression");
+
+    // Number
+    const auto start = m_position;
+    while (m_position < m_source.length()
+           && (m_source.at(m_position).isDigit() || m_source.at(m_position) == '.'))
+        ++m_position;
+
+    if (m_position > start)
+    {
+        // Exponent
+        if (m_position < m_source.length()
+            && (m_source.at(m_position) == 'e' || m_source.at(m_position) == 'E'))
+        {
+            ++m_position;
+            if (m_position < m_source.length()
+                && (m_source.at(m_position) == '-' || m_source.at(m_position) == '+'))
+                ++m_position;
+            while (m_position < m_source.length() && m_source.at(m_position).isDigit())
+                ++m_position;
+        }
+
+        bool ok;
+        const auto value = m_source.mid(start, m_position - start).toDouble(&ok);
+        return ok ? constant(value) : fail("Invalid number");
+    }
+
+    // Variable or function
+    const auto name = identifier();
+    if (name.isEmpty())
+        return fail("Unexpected character");
+
+    if (accept("("))
+        return parseFunction(name);
+
+    return parseVariable(name);
+}
+
+/**
+ * Arguments of the function with the given @a name, the opening parenthesis has
+ * already been read.
+ */
+int ExpressionCompiler::parseFunction(const QString &name)
+{
+    struct Function
+    {
+        const char *name;
+        int opcode;
+        int arguments;
+    };
+
+    static const Function functions[] = {
+        { "min", Expression::Minimum, 2 },   { "max", Expression::Maximum, 2 },
+        { "clamp", Expression::Clamp, 3 },   { "abs", Expression::Absolute, 1 },
+        { "deadzone", Expression::Deadzone, 2 }, { "rise", Expression::Rise, 1 },
+    };
+
+    const Function *function = nullptr;
+    for (const auto &candidate : functions)
+    {
+        if (name == QLatin1String(candidate.name))
+            function = &candidate;
+    }
+
+    if (!function)
+        return fail(QString("Unknown function \"%1\"").arg(name));
+
+    int arguments[3] = { 0, 0, 0 };
+    for (int i = 0; i < function->arguments; ++i)
+    {
+        if (i > 0 && !accept(","))
+            return fail(QString("%1() expects %2 arguments")
+                            .arg(name)
+                            .arg(function->arguments));
+
+        arguments[i] = parseConditional();
+        if (arguments[i] < 0)
+            return -1;
+    }
+
+    if (!accept(")"))
+        return fail("Expected ')'");
+
+    // Each rise() function remembers the previous value of its argument
+    if (function->opcode == Expression::Rise)
+    {
+        if (m_expression.m_memory >= Expression::MAX_REGISTERS)
+            return fail("Too many rise() functions");
+
+        arguments[2] = m_expression.m_memory++;
+    }
+
+    return append(function->opcode, arguments[0], arguments[1], arguments[2]);
+}
+
+/**
+ * axisN, buttonN or the name of an output
+ */
+int ExpressionCompiler::parseVariable(const QString &name)
+{
+    const auto output = m_outputs.indexOf(name);
+    if (output >= 0)
+    {
+        if (output >= Expression::MAX_REGISTERS)
+            return fail("Too many outputs");
+
+        return append(Expression::LoadOutput, output);
+    }
+
+    const QLatin1String prefixes[] = { QLatin1String("axis"), QLatin1String("button") };
+    const int opcodes[] = { Expression::LoadAxis, Expression::LoadButton };
+    for (int i = 0; i < 2; ++i)
+    {
+        if (!name.startsWith(prefixes[i]))
+            continue;
+
+        bool ok;
+        const auto index = name.mid(prefixes[i].size()).toInt(&ok);
+        if (ok && index >= 0 && index < Expression::MAX_INPUTS)
+            return append(opcodes[i], index);
+    }
+
+    return fail(QString("Unknown variable \"%1\"").arg(name));
+}
+
+/**
+ * Returns the register that holds the given constant @a value
+ */
+int ExpressionCompiler::constant(const double value)
+{
+    for (const auto &constant : m_expression.m_constants)
+    {
+        if (constant.value == value)
+            return constant.target;
+    }
+
+    if (m_expression.m_registers >= Expression::MAX_REGISTERS)
+        return fail("Expression is too long");
+
+    Expression::Constant constant;
+    constant.target = m_expression.m_registers++;
+    constant.value = value;
+    m_expression.m_constants.append(constant);
+    return constant.target;
+}
+
+/**
+ * Appends an instruction that writes its result to a new register, which is returned
+ */
+int ExpressionCompiler::append(const int opcode, const int a, const int b, const int c)
+{
+    if (m_expression.m_registers >= Expression::MAX_REGISTERS)
+        return fail("Expression is too long");
+
+    Expression::Instruction instruction;
+    instruction.opcode = static_cast<quint8>(opcode);
+    instruction.target = static_cast<quint8>(m_expression.m_registers++);
+    instruction.a = static_cast<quint8>(a);
+    instruction.b = static_cast<quint8>(b);
+    instruction.c = static_cast<quint8>(c);
+    m_expression.m_program.append(instruction);
+    return instruction.target;
+}
+
+/**
+ * Records the first error found in the source
+ */
+int ExpressionCompiler::fail(const QString &message)
+{
+    if (m_error.isEmpty())
+        m_error = message;
+
+    return -1;
+}
+
+/**
+ * Skips blanks & returns @c true if the whole source has been read
+ */
+bool ExpressionCompiler::atEnd()
+{
+    while (m_position < m_source.length() && m_source.at(m_position).isSpace())
+        ++m_position;
+
+    return m_position >= m_source.length();
+}
+
+/**
+ * Reads the given @a token if it is next in the source
+ */
+bool ExpressionCompiler::accept(const char *token)
+{
+    if (atEnd())
+        return false;
+
+    int length = 0;
+    for (; token[length]; ++length)
+    {
+        const auto position = m_position + length;
+        if (position >= m_source.length() || m_source.at(position) != token[length])
+            return false;
+    }
+
+    // "<" & ">" must not match the beginning of "<=" & ">=", nor "!" that of "!="
+    const auto next = m_position + length;
+    if (length == 1 && next < m_source.length() && m_source.at(next) == '='
+        && (token[0] == '<' || token[0] == '>' || token[0] == '!'))
+        return false;
+
+    m_position += length;
+    return true;
+}
+
+/**
+ * Reads a name made of letters, digits & underscores
+ */
+QString ExpressionCompiler::identifier()
+{
+    const auto start = m_position;
+    for (; m_position < m_source.length(); ++m_position)
+    {
+        const auto c = m_source.at(m_position);
+        if (!c.isLetterOrNumber() && c != '_')
+            break;
+    }
+
+    return m_source.mid(start, m_position - start);
+}
+
+//----------------------------------------------------------------------------------------
+// Expression
+//----------------------------------------------------------------------------------------
+
+/**
+ * Constructor function, creates an expression that evaluates to 0
+ */
+Expression::Expression()
+    : m_result(0)
+    , m_registers(1)
+    , m_memory(0)
+{
+    Constant zero;
+    zero.target = 0;
+    zero.value = 0;
+    m_constants.append(zero);
+}
+
+/**
+ * Returns the number of registers needed to evaluate the expression
+ */
+int Expression::registerCount() const
+{
+    return m_registers;
+}
+
+/**
+ * Returns the number of values remembered between evaluations (one per rise() call)
+ */
+int Expression::memoryCount() const
+{
+    return m_memory;
+}
+
+/**
+ * Returns the compiled instructions
+ */
+const QVector<Expression::Instruction> &Expression::program() const
+{
+    return m_program;
+}
+
+/**
+ * Compiles the given @a source. The names of the @a outputs of the profile can be
+ * used as variables, in the same order as the values given to @c evaluate(). On
+ * failure, the expression is left untouched & the reason is written to @a error.
+ */
+bool Expression::compile(const QString &source, const QStringList &outputs,
+                         QString *error)
+{
+    Expression result;
+    result.m_constants.clear();
+    result.m_registers = 0;
+
+    ExpressionCompiler compiler(source, outputs, result);
+    if (!compiler.compile(error))
+        return false;
+
+    *this = result;
+    return true;
+}
+
+/**
+ * Loads the constants into the given @a registers & clears the @a memory of the rise()
+ * functions. Must be called once before the first evaluation.
+ */
+void Expression::initialize(double *registers, double *memory) const
+{
+    for (int i = 0; i < m_registers; ++i)
+        registers[i] = 0;
+    for (int i = 0; i < m_memory; ++i)
+        memory[i] = 0;
+    for (const auto &constant : m_constants)
+        registers[constant.target] = constant.value;
+}
+
+/**
+ * Evaluates the expression for the given @a inputs, using the @a registers & @a memory
+ * prepared by @c initialize(). Inputs that are not available evaluate to 0, as do
+ * divisions by zero, so that the result can always be sent.
+ */
+double Expression::evaluate(const Inputs &inputs, double *registers, double *memory) const
+{
+    auto r = registers;
+    const auto end = m_program.constData() + m_program.count();
+    for (auto i = m_program.constData(); i != end; ++i)
+    {
+        auto &target = r[i->target];
+
+        // Operand a is the index of an input for the load instructions
+        switch (i->opcode)
+        {
+            case LoadAxis:
+                target = i->a < inputs.axisCount ? inputs.axes[i->a] : 0;
+                continue;
+            case LoadButton:
+                target = i->a < inputs.buttonCount ? inputs.buttons[i->a] : 0;
+                continue;
+            case LoadOutput:
+                target = i->a < inputs.outputCount ? inputs.outputs[i->a] : 0;
+                continue;
+        }
+
+        const auto a = r[i->a];
+        const auto b = r[i->b];
+        switch (i->opcode)
+        {
+            case Add:
+                target = a + b;
+                break;
+            case Subtract:
+                target = a - b;
+                break;
+            case Multiply:
+                target = a * b;
+                break;
+            case Divide:
+                target = b != 0 ? a / b : 0;
+                break;
+            case Modulo:
+                target = b != 0 ? std::fmod(a, b) : 0;
+                break;
+            case Negate:
+                target = -a;
+                break;
+            case Not:
+                target = a == 0;
+                break;
+            case And:
+                target = a != 0 && b != 0;
+                break;
+            case Or:
+                target = a != 0 || b != 0;
+                break;
+            case Less:
+                target = a < b;
+                break;
+            case LessEqual:
+                target = a <= b;
+                break;
+            case Greater:
+                target = a > b;
+                break;
+            case GreaterEqual:
+                target = a >= b;
+                break;
+            case Equal:
+                target = a == b;
+                break;
+            case NotEqual:
+                target = a != b;
+                break;
+            case Select:
+                target = a != 0 ? b : r[i->c];
+                break;
+            case Minimum:
+                target = qMin(a, b);
+                break;
+            case Maximum:
+                target = qMax(a, b);
+                break;
+            case Clamp:
+                target = qBound(b, a, qMax(b, r[i->c]));
+                break;
+            case Absolute:
+                target = std::fabs(a);
+                break;
+            case Deadzone:
+                target = std::fabs(a) < b ? 0 : a;
+                break;
+            case Rise:
+                target = a != 0 && memory[i->c] == 0;
+                memory[i->c] = a != 0;
+                break;
+        }
+    }
+
+    return r[m_result];
+}
@@ -0,0 +1,133 @@
+/*
+ * Copyright (c) 2022 Alex Spataru <https://github.com/alex-spataru>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <QString>
+#include <QVector>
+#include <QStringList>
+
+/**
+ * @brief The Expression class
+ *
+ * A small expression language used by profiles to compute an output from the state of
+ * the joystick, e.g. "clamp(axis5 * 20 + axis4 * 5, -20, 20)". Expressions can use:
+ *
+ * - Numbers, @c axisN (-1 to 1), @c buttonN (0 or 1) & the names of the outputs of the
+ *   profile (their current value, which allows an output to depend on itself).
+ * - The operators + - * / %, comparisons (< <= > >= == !=), logical operators
+ *   (&& || !) & the conditional operator (c ? a : b). Logical operators & comparisons
+ *   return 1 or 0, any value other than 0 is true.
+ * - The functions min(a, b), max(a, b), clamp(x, min, max), abs(x), deadzone(x, d)
+ *   (0 if |x| < d) & rise(x), which is 1 only when x changes from false to true since
+ *   the previous evaluation (e.g. "rise(button0 && button1) ? 1 - light : light"
+ *   toggles the "light" output when both buttons are pressed).
+ *
+ * The source is compiled once into register-based bytecode: each instruction reads
+ * its operands from registers & writes its result to another register. Constants are
+ * loaded into their registers by @c initialize(), so evaluating an expression is a
+ * single pass over the instructions that does not allocate memory. The registers & the
+ * memory of the rise() functions are owned by the caller, so that the same compiled
+ * expression can be evaluated for several channels.
+ */
+class Expression
+{
+public:
+    static const int MAX_INPUTS = 256;
+    static const int MAX_REGISTERS = 256;
+
+    enum Opcode
+    {
+        LoadAxis,
+        LoadButton,
+        LoadOutput,
+        Add,
+        Subtract,
+        Multiply,
+        Divide,
+        Modulo,
+        Negate,
+        Not,
+        And,
+        Or,
+        Less,
+        LessEqual,
+        Greater,
+        GreaterEqual,
+        Equal,
+        NotEqual,
+        Select,
+        Minimum,
+        Maximum,
+        Clamp,
+        Absolute,
+        Deadzone,
+        Rise
+    };
+
+    struct Instruction
+    {
+        quint8 opcode;
+        quint8 target;
+        quint8 a;
+        quint8 b;
+        quint8 c;
+    };
+
+    struct Inputs
+    {
+        const double *axes;
+        int axisCount;
+        const double *buttons;
+        int buttonCount;
+        const double *outputs;
+        int outputCount;
+    };
+
+    Expression();
+
+    int registerCount() const;
+    int memoryCount() const;
+    const QVector<Instruction> &program() const;
+
+    bool compile(const QString &source, const QStringList &outputs,
+                 QString *error = nullptr);
+
+    void initialize(double *registers, double *memory) const;
+    double evaluate(const Inputs &inputs, double *registers, double *memory) const;
+
+private:
+    friend class ExpressionCompiler;
+
+    struct Constant
+    {
+        int target;
+        double value;
+    };
+
+    int m_result;
+    int m_registers;
+    int m_memory;
+    QVector<Constant> m_constants;
+    QVector<Instruction> m_program;
+};
@@ -51,4 +51,36 @@ public:
     virtual bool configurationOk() const = 0;
     virtual quint64 write(const QByteArray &data) = 0;
     virtual bool open(const QIODevice::OpenMode mode) = 0;
+
+    /**
+     * Writes the given @a data @a repeat times right away, for commands that cannot
+     * wait for the next frame (e.g. an emergency stop), without waiting until it has
+     * been transmitted. Drivers without a transmit queue simply write the data.
+     */
+    virtual quint64 writeUrgent(const QByteArray &data, const int repeat)
+    {
+        quint64 bytes = 0;
+        for (int i = 0; i < repeat; ++i)
+            bytes += write(data);
+
+        return bytes;
+    }
+
+    /**
+     * Returns the number of bytes that the device can send per second, or 0 if the
+     * driver has no such limit. This function may be called from any thread.
+     */
+    virtual qint64 bytesPerSecond() const
+    {
+        return 0;
+    }
+
+    /**
+     * Returns the time, in microseconds, that the device still needs to transmit the
+     * data written so far, or 0 if the driver does not know it.
+     */
+    virtual qint64 transmitDelay()
+    {
+        return 0;
+    }
 };
@@ -0,0 +1,725 @@
+/*
+ * Copyright (c) 2022 Alex Spataru <https://github.com/alex-spataru>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "Headless.h"
+
+#include <cstdio>
+#include <QDebug>
+#include <QSettings>
+#include <QScopedPointer>
+#include <QCoreApplication>
+#include <QCommandLineParser>
+
+#include "Bridge.h"
+#include "Serial.h"
+#include "Realtime.h"
+#include "Watchdog.h"
+#include "ProfileWatcher.h"
+#include "Telemetry.h"
+#include "ReliableLink.h"
+#include "QJoysticks.h"
+
+#include <QJoysticks/Evdev_Joysticks.h>
+
+/**
+ * Constructor function
+ */
+Headless::Headless(QObject *parent)
+    : QObject(parent)
+    , m_echo(false)
+    , m_autoBaud(false)
+    , m_portMissing(false)
+    , m_printStats(false)
+    , m_telemetryRecords(0)
+{
+}
+
+/**
+ * Reads the command line @a arguments and configures the serial port & the bridge
+ * accordingly. Options that are not given in the command line are read from the INI
+ * file passed with @c --config (if any).
+ *
+ * Returns @c false if the configuration is not valid.
+ */
+bool Headless::configure(const QStringList &arguments)
+{
+    // clang-format off
+    QCommandLineOption headlessOpt("headless", "Run without user interface.");
+    QCommandLineOption configOpt(QStringList { "c", "config" }, "Read options from INI <file>.", "file");
+    QCommandLineOption portOpt(QStringList { "p", "port" }, "Serial port <name>, e.g. ttyUSB0.", "name");
+    QCommandLineOption baudOpt(QStringList { "b", "baud" }, "Baud <rate> of the serial port, or auto to detect it.", "rate", "115200");
+    QCommandLineOption baudProbeOpt("baud-probe", "Send <text> at each rate while detecting the baud rate.", "text");
+    QCommandLineOption joystickOpt(QStringList { "j", "joystick" }, "Joystick <index> to read.", "index", "0");
+    QCommandLineOption evdevOpt("evdev", "Read joysticks directly from /dev/input instead of SDL (Linux).");
+    QCommandLineOption profileOpt("profile", "Mapping profile (JSON <file>).", "file");
+    QCommandLineOption channelOpt("channel", "Bind a joystick to an output channel, <spec> is number:joystick[:profile]. Can be repeated.", "spec");
+    QCommandLineOption intervalOpt(QStringList { "i", "interval" }, "Milliseconds between frames.", "msec", "250");
+    QCommandLineOption echoOpt("echo", "Print data received from the serial device.");
+    QCommandLineOption rxTimeoutOpt("rx-timeout", "Send failsafe frames if the device is silent for <msec>.", "msec", "0");
+    QCommandLineOption inputTimeoutOpt("input-timeout", "Send failsafe frames if no input arrives for <msec>.", "msec", "0");
+    QCommandLineOption failsafeRateOpt("failsafe-rate", "Failsafe frames per second (1-1000).", "hz", "50");
+    QCommandLineOption reliableOpt("reliable", "Retransmit critical commands until acknowledged.");
+    QCommandLineOption telemetryOpt("telemetry", "Decode received telemetry in <format> (text or binary).", "format", "text");
+    QCommandLineOption priorityOpt("rt-priority", "Use SCHED_FIFO <priority> (1-99) for input & TX threads.", "priority");
+    QCommandLineOption cpuOpt("rt-cpu", "Run input & TX threads in real-time mode on CPU <core>.", "core");
+    QCommandLineOption rateOpt(QStringList { "r", "rate" }, "Frames per second (1-1000), overrides --interval.", "hz");
+    QCommandLineOption statsOpt("stats", "Print frame timing statistics every <sec> seconds.", "sec");
+    QCommandLineOption histogramOpt("histogram", "Export frame interval histogram to CSV <file>.", "file");
+    QCommandLineOption captureOpt("capture", "Record serial TX/RX traffic to pcap <file>.", "file");
+    QCommandLineOption recordOpt("record", "Record joystick input to <file>.", "file");
+    QCommandLineOption replayOpt("replay", "Replay joystick input from <file> and exit.", "file");
+    QCommandLineOption replayFastOpt("replay-fast", "Replay as fast as possible and report throughput.");
+    // clang-format on
+
+    // Parse command line
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Sends joystick data to a serial device.");
+    parser.addHelpOption();
+    parser.addOption(headlessOpt);
+    parser.addOption(configOpt);
+    parser.addOption(portOpt);
+    parser.addOption(baudOpt);
+    parser.addOption(baudProbeOpt);
+    parser.addOption(joystickOpt);
+    parser.addOption(evdevOpt);
+    parser.addOption(profileOpt);
+    parser.addOption(channelOpt);
+    parser.addOption(intervalOpt);
+    parser.addOption(rateOpt);
+    parser.addOption(echoOpt);
+    parser.addOption(telemetryOpt);
+    parser.addOption(reliableOpt);
+    parser.addOption(rxTimeoutOpt);
+    parser.addOption(inputTimeoutOpt);
+    parser.addOption(failsafeRateOpt);
+    parser.addOption(priorityOpt);
+    parser.addOption(cpuOpt);
+    parser.addOption(statsOpt);
+    parser.addOption(histogramOpt);
+    parser.addOption(captureOpt);
+    parser.addOption(recordOpt);
+    parser.addOption(replayOpt);
+    parser.addOption(replayFastOpt);
+    parser.process(arguments);
+
+    // Open configuration file
+    QScopedPointer<QSettings> config;
+    if (parser.isSet(configOpt))
+        config.reset(new QSettings(parser.value(configOpt), QSettings::IniFormat));
+
+    // Command line options take precedence over the configuration file
+    auto value = [&](const QCommandLineOption &option) -> QString {
+        auto key = option.names().last();
+        if (!parser.isSet(option) && config && config->contains(key))
+            return config->value(key).toString();
+
+        return parser.value(option);
+    };
+
+    // Validate options
+    bool baudOk, joystickOk, intervalOk, rateOk, priorityOk, cpuOk, statsOk;
+    bool rxTimeoutOk, inputTimeoutOk, failsafeRateOk;
+    m_portName = value(portOpt);
+    m_autoBaud = value(baudOpt) == "auto";
+    const auto baud = m_autoBaud ? 115200 : value(baudOpt).toInt(&baudOk);
+    const auto joystick = value(joystickOpt).toInt(&joystickOk);
+    const auto interval = value(intervalOpt).toInt(&intervalOk);
+    const auto rate = value(rateOpt).toInt(&rateOk);
+    const auto profile = value(profileOpt);
+    const auto priority = value(priorityOpt).toInt(&priorityOk);
+    const auto cpu = value(cpuOpt).toInt(&cpuOk);
+    const auto stats = value(statsOpt).toInt(&statsOk);
+    const auto capture = value(captureOpt);
+    const auto record = value(recordOpt);
+    const auto replay = value(replayOpt);
+    const auto telemetry = value(telemetryOpt);
+    const auto rxTimeout = value(rxTimeoutOpt).toInt(&rxTimeoutOk);
+    const auto inputTimeout = value(inputTimeoutOpt).toInt(&inputTimeoutOk);
+    const auto failsafeRate = value(failsafeRateOpt).toInt(&failsafeRateOk);
+    m_echo = parser.isSet(echoOpt) || (config && config->value("echo").toBool());
+    const auto evdevConfig = config && config->value("evdev").toBool();
+    const auto evdev = parser.isSet(evdevOpt) || evdevConfig;
+
+    if (m_portName.isEmpty() && replay.isEmpty())
+    {
+        QStringList ports;
+        Q_FOREACH (QSerialPortInfo info, QSerialPortInfo::availablePorts())
+            ports.append(info.portName());
+
+        qCritical() << "No serial port given, available ports:" << ports;
+        return false;
+    }
+
+    if (!m_autoBaud && (!baudOk || baud <= 10))
+    {
+        qCritical() << "Invalid baud rate:" << value(baudOpt);
+        return false;
+    }
+
+    if (!joystickOk || joystick < 0)
+    {
+        qCritical() << "Invalid joystick index:" << value(joystickOpt);
+        return false;
+    }
+
+    if (evdev && !Evdev_Joysticks::isSupported())
+    {
+        qCritical() << "Reading joysticks with evdev is only supported on Linux";
+        return false;
+    }
+
+    if (!intervalOk || interval <= 0)
+    {
+        qCritical() << "Invalid send interval:" << value(intervalOpt);
+        return false;
+    }
+
+    if (!value(rateOpt).isEmpty() && (!rateOk || rate <= 0 || rate > Scheduler::MAX_RATE))
+    {
+        qCritical() << "Invalid frame rate:" << value(rateOpt);
+        return false;
+    }
+
+    if (!value(priorityOpt).isEmpty() && (!priorityOk || priority < 1 || priority > 99))
+    {
+        qCritical() << "Invalid real-time priority:" << value(priorityOpt);
+        return false;
+    }
+
+    if (!value(cpuOpt).isEmpty() && (!cpuOk || cpu < 0))
+    {
+        qCritical() << "Invalid CPU core:" << value(cpuOpt);
+        return false;
+    }
+
+    if (!value(statsOpt).isEmpty() && (!statsOk || stats <= 0))
+    {
+        qCritical() << "Invalid statistics interval:" << value(statsOpt);
+        return false;
+    }
+
+    if (!rxTimeoutOk || !inputTimeoutOk || rxTimeout < 0 || inputTimeout < 0)
+    {
+        qCritical() << "Invalid watchdog timeout:" << value(rxTimeoutOpt)
+                    << value(inputTimeoutOpt);
+        return false;
+    }
+
+    if (!failsafeRateOk || failsafeRate <= 0 || failsafeRate > Scheduler::MAX_RATE)
+    {
+        qCritical() << "Invalid failsafe rate:" << value(failsafeRateOpt);
+        return false;
+    }
+
+    if (telemetry != "text" && telemetry != "binary")
+    {
+        qCritical() << "Invalid telemetry format:" << telemetry;
+        return false;
+    }
+
+    // Load mapping profile
+    if (!profile.isEmpty())
+    {
+        QString error;
+        if (!Bridge::instance().loadProfile(profile, &error))
+        {
+            qCritical() << "Cannot load profile" << profile << "-" << error;
+            return false;
+        }
+    }
+
+    // Bind each joystick to its own output channel (multi-device mode)
+    auto channels = parser.values(channelOpt);
+    if (!parser.isSet(channelOpt) && config)
+        channels = config->value("channel").toStringList();
+    if (!channels.isEmpty())
+    {
+        QString error;
+        QVector<Bridge::Channel> list;
+        for (const auto &spec : channels)
+        {
+            Bridge::Channel channel;
+            if (!parseChannel(spec, channel, &error))
+            {
+                qCritical() << "Invalid channel" << spec << "-" << error;
+                return false;
+            }
+
+            list.append(channel);
+        }
+
+        Bridge::instance().setChannels(list);
+    }
+
+    // Record serial traffic
+    if (!capture.isEmpty())
+    {
+        QString error;
+        if (!Serial::instance().startCapture(capture, &error))
+        {
+            qCritical() << "Cannot capture to" << capture << "-" << error;
+            return false;
+        }
+
+        connect(qApp, &QCoreApplication::aboutToQuit, this, &Headless::stopCapture);
+    }
+
+    // Record joystick input
+    if (!record.isEmpty())
+    {
+        QString error;
+        if (!m_recorder.start(record, &error))
+        {
+            qCritical() << "Cannot record to" << record << "-" << error;
+            return false;
+        }
+    }
+
+    // Replay joystick input, the replayed joystick is used unless given by the user
+    if (!replay.isEmpty())
+    {
+        QString error;
+        if (!m_player.open(replay, &error))
+        {
+            qCritical() << "Cannot replay" << replay << "-" << error;
+            return false;
+        }
+
+        // Each event goes through the whole frame generation, the buffer is reused
+        if (parser.isSet(replayFastOpt))
+        {
+            QByteArray frame;
+            m_player.setEventHook(
+                [frame]() mutable { Bridge::instance().computeFrame(frame); });
+        }
+
+        connect(&m_player, &InputPlayer::finished, this, &Headless::onReplayFinished);
+    }
+
+    // Configure pipeline
+    Serial::instance().setBaudRate(baud);
+    if (!value(baudProbeOpt).isEmpty())
+        m_baudProbe = value(baudProbeOpt).toUtf8() + "\n";
+    Telemetry::instance().setFormat(telemetry == "binary" ? Telemetry::Binary
+                                                          : Telemetry::Text);
+    Watchdog::instance().setRxTimeout(rxTimeout);
+    Watchdog::instance().setInputTimeout(inputTimeout);
+    Watchdog::instance().setFailsafeRate(failsafeRate);
+    connect(&Watchdog::instance(), &Watchdog::trippedChanged, this,
+            &Headless::onWatchdogChanged);
+
+    // Apply the changes made to the profile files while running
+    connect(&ProfileWatcher::instance(), &ProfileWatcher::profileReloaded, this,
+            &Headless::onProfileReloaded);
+    connect(&ProfileWatcher::instance(), &ProfileWatcher::reloadFailed, this,
+            &Headless::onProfileReloadFailed);
+
+    // Read the joysticks from the kernel, the joystick indexes refer to evdev devices
+    QJoysticks::getInstance()->setEvdevEnabled(evdev);
+
+    const auto reliable = config && config->value("reliable").toBool();
+    ReliableLink::instance().setEnabled(parser.isSet(reliableOpt) || reliable);
+    Bridge::instance().setJoystick(joystick);
+    if (value(rateOpt).isEmpty())
+        Bridge::instance().setSendInterval(interval * 1000);
+    else
+        Bridge::instance().setSendRate(rate);
+
+    // Run the input (main) & TX threads with real-time priority
+    if (!value(priorityOpt).isEmpty() || !value(cpuOpt).isEmpty())
+    {
+        Realtime::Settings realtime;
+        realtime.enabled = true;
+        if (!value(priorityOpt).isEmpty())
+            realtime.priority = priority;
+        if (!value(cpuOpt).isEmpty())
+            realtime.cpu = cpu;
+
+        Realtime::configureThread(realtime, "input");
+        Bridge::instance().setRealtime(realtime);
+    }
+
+    // Print/export timing statistics periodically
+    m_printStats = !value(statsOpt).isEmpty();
+    m_histogramPath = value(histogramOpt);
+    if (m_printStats || !m_histogramPath.isEmpty())
+    {
+        m_allocations = Bridge::instance().allocationStats();
+        connect(&m_statsTimer, &QTimer::timeout, this, &Headless::reportStats);
+        connect(qApp, &QCoreApplication::aboutToQuit, this, &Headless::reportStats);
+        m_statsTimer.start(m_printStats ? stats * 1000 : 10 * 1000);
+    }
+
+    // clang-format off
+    connect(&Serial::instance(), &Serial::dataReceived,
+            this, &Headless::onSerialDataReceived);
+    connect(QJoysticks::getInstance(), &QJoysticks::countChanged,
+            this, &Headless::onJoysticksChanged);
+    // clang-format on
+
+    // Open the serial port now, and try again every second if it's not available. If
+    // the adapter is lost once open, it is reopened as soon as it reappears.
+    if (!m_portName.isEmpty())
+    {
+        Serial::instance().setAutoReconnect(true);
+        connect(&Serial::instance(), &Serial::reconnectingChanged, this,
+                &Headless::onSerialReconnecting);
+        connect(&Serial::instance(), &Serial::reconnected, this,
+                &Headless::onSerialReconnected);
+        connect(&Serial::instance(), &Serial::autoBaudFinished, this,
+                &Headless::onAutoBaudFinished);
+
+        connect(&m_retryTimer, &QTimer::timeout, this, &Headless::connectSerial);
+        m_retryTimer.start(1000);
+        connectSerial();
+    }
+
+    // Start replay
+    if (!replay.isEmpty())
+    {
+        m_player.start(parser.isSet(replayFastOpt));
+
+        auto devices = m_player.devices();
+        if (!parser.isSet(joystickOpt) && !devices.isEmpty())
+            Bridge::instance().setJoystick(devices.first()->id);
+    }
+
+    return true;
+}
+
+/**
+ * Reads a channel specification given by the user, in the form
+ * "number:joystick[:profile]". Channels without a profile use the current profile.
+ */
+bool Headless::parseChannel(const QString &spec, Bridge::Channel &channel, QString *error)
+{
+    // The profile path may contain colons (e.g. on Windows), only split the numbers
+    auto first = spec.indexOf(':');
+    auto second = first >= 0 ? spec.indexOf(':', first + 1) : -1;
+    auto last = second >= 0 ? second : spec.length();
+
+    bool numberOk = false, joystickOk = false;
+    channel.number = spec.left(first).toInt(&numberOk);
+    channel.joystick = spec.mid(first + 1, last - first - 1).toInt(&joystickOk);
+    numberOk = numberOk && first >= 0 && channel.number >= 0;
+    joystickOk = joystickOk && channel.joystick >= 0;
+    if (!numberOk || !joystickOk)
+    {
+        if (error)
+            *error = "expected number:joystick[:profile]";
+
+        return false;
+    }
+
+    channel.profile = Bridge::instance().profile();
+    if (second >= 0)
+        return Profile::load(spec.mid(second + 1), channel.profile, error);
+
+    return true;
+}
+
+/**
+ * Opens the configured serial port if it's not already open
+ */
+void Headless::connectSerial()
+{
+    if (Serial::instance().isOpen() || Serial::instance().isReconnecting())
+        return;
+
+    if (!Serial::instance().setPortName(m_portName))
+    {
+        if (!m_portMissing)
+            qWarning() << "Waiting for serial port" << m_portName;
+
+        m_portMissing = true;
+        return;
+    }
+
+    m_portMissing = false;
+    if (Serial::instance().open(QIODevice::ReadWrite))
+    {
+        if (m_autoBaud && Serial::instance().startAutoBaud(m_baudProbe))
+            qInfo() << "Connected to" << Serial::instance().portName()
+                    << "- detecting baud rate";
+        else
+            qInfo() << "Connected to" << Serial::instance().portName() << "at"
+                    << Serial::instance().baudRate() << "baud";
+    }
+
+    else
+        qWarning() << "Cannot open serial port" << m_portName;
+}
+
+/**
+ * Logs the measured frame period jitter and/or writes the interval histogram to the
+ * CSV file given by the user.
+ */
+void Headless::reportStats()
+{
+    const auto &stats = Bridge::instance().stats();
+    if (m_printStats)
+        qInfo().noquote() << "Timing:" << stats.toString();
+
+    // Heap allocations since the previous report (CONFIG+=alloc_tracking)
+    if (m_printStats && AllocTracker::enabled())
+    {
+        auto current = Bridge::instance().allocationStats();
+        auto frames = current.frames - m_allocations.frames;
+        auto events = current.events - m_allocations.events;
+        auto perFrame = frames ? 1.0 * (current.frameAllocations
+                                        - m_allocations.frameAllocations) / frames : 0;
+        auto perEvent = events ? 1.0 * (current.mappingAllocations
+                                        - m_allocations.mappingAllocations) / events : 0;
+        m_allocations = current;
+
+        qInfo().noquote() << QString("Allocations: %1/frame, %2/event (mapping)")
+                                 .arg(perFrame, 0, 'f', 2)
+                                 .arg(perEvent, 0, 'f', 2);
+    }
+
+    // Telemetry records decoded since the previous report
+    if (m_printStats)
+    {
+        const auto records = Telemetry::instance().recordCount();
+        qInfo().noquote() << QString("Telemetry: %1 records, %2 errors")
+                                 .arg(records - m_telemetryRecords)
+                                 .arg(Telemetry::instance().errorCount());
+        m_telemetryRecords = records;
+    }
+
+    // Failsafe trips & time needed to send the failsafe frame
+    const auto watchdog = Watchdog::instance().stats();
+    if (m_printStats && watchdog.trips > 0)
+    {
+        qInfo().noquote() << QString("Failsafe: %1 trips (%2 input, %3 RX), "
+                                     "last %4 ms, max %5 ms")
+                                 .arg(watchdog.trips)
+                                 .arg(watchdog.inputTrips)
+                                 .arg(watchdog.rxTrips)
+                                 .arg(watchdog.lastLatency / 1000.0, 0, 'f', 3)
+                                 .arg(watchdog.maximumLatency / 1000.0, 0, 'f', 3);
+    }
+
+    // Button-to-wire time of the emergency stops
+    const auto stop = Bridge::instance().stopStats();
+    if (m_printStats && stop.count > 0)
+    {
+        qInfo().noquote() << QString("Emergency stops: %1, last %2 ms, "
+                                     "min %3 ms, max %4 ms")
+                                 .arg(stop.count)
+                                 .arg(stop.last / 1000.0, 0, 'f', 3)
+                                 .arg(stop.minimum / 1000.0, 0, 'f', 3)
+                                 .arg(stop.maximum / 1000.0, 0, 'f', 3);
+    }
+
+    // Delivery of critical commands (reliable mode)
+    if (m_printStats && ReliableLink::instance().enabled())
+    {
+        const auto link = ReliableLink::instance().stats();
+        qInfo().noquote() << QString("Commands: %1 sent, %2 acknowledged, "
+                                     "%3 retransmitted, %4 failed, "
+                                     "RTT %5 ms (avg %6 ms, max %7 ms)")
+                                 .arg(link.sent)
+                                 .arg(link.acknowledged)
+                                 .arg(link.retransmissions)
+                                 .arg(link.failures)
+                                 .arg(link.rtt / 1000.0, 0, 'f', 3)
+                                 .arg(link.smoothedRtt / 1000.0, 0, 'f', 3)
+                                 .arg(link.maximumRtt / 1000.0, 0, 'f', 3);
+    }
+
+    // Frames written to the serial port & frames dropped because the port was full
+    const auto tx = Serial::instance().txStats();
+    if (m_printStats && (tx.frames > 0 || tx.dropped > 0))
+    {
+        qInfo().noquote() << QString("Serial TX: %1 frames, %2 bytes, %3 dropped")
+                                 .arg(tx.frames)
+                                 .arg(tx.bytes)
+                                 .arg(tx.dropped);
+    }
+
+    // Serial adapter losses & time needed to reopen it
+    const auto reconnect = Serial::instance().reconnectStats();
+    if (m_printStats && reconnect.losses > 0)
+    {
+        qInfo().noquote() << QString("Serial port: lost %1 times, %2 reconnected, "
+                                     "last %3 ms, max %4 ms")
+                                 .arg(reconnect.losses)
+                                 .arg(reconnect.reconnects)
+                                 .arg(reconnect.lastRecovery / 1000.0, 0, 'f', 3)
+                                 .arg(reconnect.maximumRecovery / 1000.0, 0, 'f', 3);
+    }
+
+    // Time from the kernel timestamp of each input report until it has been applied
+    const auto evdevJoysticks = QJoysticks::getInstance()->evdevJoysticks();
+    if (m_printStats && evdevJoysticks->isEnabled())
+    {
+        const auto input = evdevJoysticks->stats();
+        qInfo().noquote() << QString("Evdev input: %1 reports, %2 resyncs, "
+                                     "last %3 ms, max %4 ms")
+                                 .arg(input.reports)
+                                 .arg(input.resyncs)
+                                 .arg(input.lastLatency / 1000.0, 0, 'f', 3)
+                                 .arg(input.maximumLatency / 1000.0, 0, 'f', 3);
+    }
+
+    QString error;
+    if (!m_histogramPath.isEmpty() && !stats.exportCsv(m_histogramPath, &error))
+        qWarning() << "Cannot export histogram to" << m_histogramPath << "-" << error;
+}
+
+/**
+ * Writes the pending serial traffic to the capture file & reports lost packets
+ */
+void Headless::stopCapture()
+{
+    Serial::instance().stopCapture();
+
+    const auto dropped = Serial::instance().droppedCapturePackets();
+    if (dropped > 0)
+        qWarning() << "Capture dropped" << dropped << "packets";
+}
+
+/**
+ * Logs when the failsafe frames start & stop being sent
+ */
+void Headless::onWatchdogChanged()
+{
+    const auto &watchdog = Watchdog::instance();
+    if (watchdog.tripped())
+        qWarning() << "Failsafe mode -" << watchdog.reason() << "- frame sent in"
+                   << watchdog.stats().lastLatency << "us";
+    else
+        qInfo() << "Failsafe mode cleared";
+}
+
+/**
+ * Logs the profile file that was applied again after being edited
+ */
+void Headless::onProfileReloaded(const QString &path)
+{
+    qInfo() << "Reloaded profile" << path << "in"
+            << ProfileWatcher::instance().stats().lastReload << "us";
+}
+
+/**
+ * Logs why an edited profile file was not applied
+ */
+void Headless::onProfileReloadFailed(const QString &path, const QString &error)
+{
+    qWarning() << "Cannot reload profile" << path << "-" << error
+               << "- keeping the previous profile";
+}
+
+/**
+ * Logs the detected baud @a rate. Once detected, the same rate is used if the port has
+ * to be opened again.
+ */
+void Headless::onAutoBaudFinished(const qint32 rate)
+{
+    if (rate > 0)
+    {
+        m_autoBaud = false;
+        qInfo() << "Detected baud rate:" << rate;
+    }
+
+    else
+        qWarning() << "No valid data at any baud rate, using"
+                   << Serial::instance().baudRate() << "baud";
+}
+
+/**
+ * Logs when the serial adapter is lost
+ */
+void Headless::onSerialReconnecting()
+{
+    if (Serial::instance().isReconnecting())
+        qWarning() << "Serial port lost, waiting for the adapter to reappear";
+}
+
+/**
+ * Logs the time needed to reopen the serial adapter after it was lost
+ */
+void Headless::onSerialReconnected(const qint64 usec)
+{
+    qInfo().noquote() << QString("Reconnected to %1 in %2 ms")
+                             .arg(Serial::instance().portName())
+                             .arg(usec / 1000.0, 0, 'f', 3);
+}
+
+/**
+ * Logs the replay throughput & quits the application
+ */
+void Headless::onReplayFinished()
+{
+    const auto events = m_player.eventCount();
+    const auto seconds = m_player.elapsedTime() / 1e9;
+    qInfo().noquote() << QString("Replayed %1 events in %2 s (%3 events/s)")
+                             .arg(events)
+                             .arg(seconds, 0, 'f', 3)
+                             .arg(seconds > 0 ? events / seconds : 0, 0, 'f', 0);
+
+    QCoreApplication::quit();
+}
+
+/**
+ * Logs the list of attached joysticks & the ones used to generate frames
+ */
+void Headless::onJoysticksChanged()
+{
+    auto joysticks = QJoysticks::getInstance();
+    qInfo() << "Joysticks:" << joysticks->deviceNames();
+
+    // Report the joystick bound to each channel
+    if (Bridge::instance().multiDevice())
+    {
+        for (const auto &channel : Bridge::instance().channels())
+        {
+            if (joysticks->joystickExists(channel.joystick))
+                qInfo() << "Channel" << channel.number << "- joystick" << channel.joystick
+                        << "-" << joysticks->getName(channel.joystick);
+            else
+                qWarning() << "Channel" << channel.number << "- joystick"
+                           << channel.joystick << "is not attached";
+        }
+
+        return;
+    }
+
+    auto index = Bridge::instance().joystick();
+    if (joysticks->joystickExists(index))
+        qInfo() << "Using joystick" << index << "-" << joysticks->getName(index);
+    else
+        qWarning() << "Joystick" << index << "is not attached";
+}
+
+/**
+ * Prints the data received from the serial device (if enabled by the user)
+ */
+void Headless::onSerialDataReceived(const QByteArray &data)
+{
+    if (m_echo)
+    {
+        fwrite(data.constData(), 1, data.size(), stdout);
+        fflush(stdout);
+    }
+}
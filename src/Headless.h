@@ -0,0 +1,104 @@
+/*
+ * Copyright (c) 2022 Alex Spataru <https://github.com/alex-spataru>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <QTimer>
+#include <QObject>
+#include <QStringList>
+
+#include "Bridge.h"
+#include "InputPlayer.h"
+#include "InputRecorder.h"
+
+/**
+ * @brief The Headless class
+ *
+ * Runs the joystick-to-serial pipeline without any user interface, which is useful for
+ * embedded boards without a display. The serial port, baud rate, joystick & mapping
+ * profile are read from the command line or from an INI configuration file.
+ *
+ * The serial port is opened as soon as it becomes available, and re-opened if the
+ * device is disconnected.
+ *
+ * Several joysticks can be bound to their own output channel & profile (e.g. for rigs
+ * with one controller per operator) with the repeatable @c --channel option.
+ *
+ * Telemetry sent back by the firmware is decoded as text lines or binary frames (see
+ * @c Telemetry) and the decoded record rate is reported with the timing statistics.
+ * Critical commands can be acknowledged & retransmitted with @c --reliable.
+ *
+ * If the joystick is unplugged, or the input or the device go silent for longer than
+ * the deadlines given by the user, neutral failsafe frames are sent instead (see
+ * @c Watchdog).
+ *
+ * The serial traffic can be recorded to a pcap file for protocol debugging.
+ *
+ * Joystick input can be recorded to a binary log, or replayed from a log (with the
+ * original timing or as fast as possible) to reproduce field sessions.
+ *
+ * Optionally, the main thread (which samples the joysticks) and the thread that sends
+ * the frames can run with real-time priority on a given CPU core.
+ */
+class Headless : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit Headless(QObject *parent = nullptr);
+
+    bool configure(const QStringList &arguments);
+
+private:
+    static bool parseChannel(const QString &spec, Bridge::Channel &channel,
+                             QString *error);
+
+private Q_SLOTS:
+    void reportStats();
+    void stopCapture();
+    void connectSerial();
+    void onReplayFinished();
+    void onWatchdogChanged();
+    void onAutoBaudFinished(const qint32 rate);
+    void onProfileReloaded(const QString &path);
+    void onProfileReloadFailed(const QString &path, const QString &error);
+    void onJoysticksChanged();
+    void onSerialReconnecting();
+    void onSerialReconnected(const qint64 usec);
+    void onSerialDataReceived(const QByteArray &data);
+
+private:
+    bool m_echo;
+    bool m_autoBaud;
+    bool m_portMissing;
+    bool m_printStats;
+    QString m_portName;
+    QString m_histogramPath;
+    QByteArray m_baudProbe;
+    QTimer m_retryTimer;
+    QTimer m_statsTimer;
+    quint64 m_telemetryRecords;
+    Bridge::AllocationStats m_allocations;
+
+    InputPlayer m_player;
+    InputRecorder m_recorder;
+};
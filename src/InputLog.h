@@ -0,0 +1,170 @@
+/*
+ * Copyright (c) 2022 Alex Spataru <https://github.com/alex-spataru>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <QtEndian>
+#include <cstring>
+
+/**
+ * Binary format of the joystick input logs written by @c InputRecorder and read by
+ * @c InputPlayer. All integers are little-endian.
+ *
+ * The file starts with a 16-byte @c Header, followed by 16-byte @c Record entries:
+ *
+ * - @c Axis records store the axis value as a 32-bit float in @c value.
+ * - @c Button records store 0 (released) or 1 (pressed) in @c value.
+ * - @c POV records store the hat angle in @c value.
+ * - @c Device records describe the joystick with the given index. The number of axes,
+ *   buttons & POVs is packed in @c value (10 bits each), @c id holds the length of the
+ *   UTF-8 device name, which follows the record padded to a multiple of 16 bytes.
+ *   They are written when recording starts and when the joystick list changes.
+ *
+ * Records are only appended, so a log stays readable if the application is killed.
+ */
+namespace InputLog
+{
+static const char MAGIC[4] = { 'J', '2', 'S', 'I' };
+static const quint16 VERSION = 1;
+
+static const int HEADER_SIZE = 16;
+static const int RECORD_SIZE = 16;
+static const int MAX_COUNT = 0x3FF;
+
+enum RecordType
+{
+    Device = 0,
+    Axis = 1,
+    Button = 2,
+    POV = 3,
+};
+
+struct Header
+{
+    quint16 version;
+    qint64 startTime; /**< Milliseconds since epoch */
+};
+
+struct Record
+{
+    quint64 timestamp; /**< Nanoseconds since the start of the recording */
+    quint8 type;
+    quint8 joystick;
+    quint16 id;
+    quint32 value;
+};
+
+/**
+ * Returns the size of a device name of @a length bytes padded to the record size
+ */
+inline int paddedSize(const int length)
+{
+    return (length + RECORD_SIZE - 1) / RECORD_SIZE * RECORD_SIZE;
+}
+
+/**
+ * Packs the number of @a axes, @a buttons & @a povs of a device record
+ */
+inline quint32 packCounts(const int axes, const int buttons, const int povs)
+{
+    return quint32(qMin(axes, MAX_COUNT)) | quint32(qMin(buttons, MAX_COUNT)) << 10
+           | quint32(qMin(povs, MAX_COUNT)) << 20;
+}
+
+/**
+ * Reads the number of @a axes, @a buttons & @a povs stored in a device record
+ */
+inline void unpackCounts(const quint32 value, int &axes, int &buttons, int &povs)
+{
+    axes = static_cast<int>(value & MAX_COUNT);
+    buttons = static_cast<int>((value >> 10) & MAX_COUNT);
+    povs = static_cast<int>((value >> 20) & MAX_COUNT);
+}
+
+/**
+ * Stores an axis @a value in the @c value field of a record
+ */
+inline quint32 packAxis(const float value)
+{
+    quint32 bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+/**
+ * Reads the axis value stored in the @c value field of a record
+ */
+inline float unpackAxis(const quint32 bits)
+{
+    float value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+/**
+ * Serializes the file @a header into the 16 bytes at @a dst
+ */
+inline void writeHeader(uchar *dst, const Header &header)
+{
+    memcpy(dst, MAGIC, sizeof(MAGIC));
+    qToLittleEndian<quint16>(header.version, dst + 4);
+    qToLittleEndian<quint16>(0, dst + 6);
+    qToLittleEndian<qint64>(header.startTime, dst + 8);
+}
+
+/**
+ * Reads the file header at @a src, returns @c false if it is not a valid input log
+ */
+inline bool readHeader(const uchar *src, Header &header)
+{
+    if (memcmp(src, MAGIC, sizeof(MAGIC)) != 0)
+        return false;
+
+    header.version = qFromLittleEndian<quint16>(src + 4);
+    header.startTime = qFromLittleEndian<qint64>(src + 8);
+    return header.version == VERSION;
+}
+
+/**
+ * Serializes the given @a record into the 16 bytes at @a dst
+ */
+inline void writeRecord(uchar *dst, const Record &record)
+{
+    qToLittleEndian<quint64>(record.timestamp, dst);
+    dst[8] = record.type;
+    dst[9] = record.joystick;
+    qToLittleEndian<quint16>(record.id, dst + 10);
+    qToLittleEndian<quint32>(record.value, dst + 12);
+}
+
+/**
+ * Reads the record stored at @a src
+ */
+inline void readRecord(const uchar *src, Record &record)
+{
+    record.timestamp = qFromLittleEndian<quint64>(src);
+    record.type = src[8];
+    record.joystick = src[9];
+    record.id = qFromLittleEndian<quint16>(src + 10);
+    record.value = qFromLittleEndian<quint32>(src + 12);
+}
+}
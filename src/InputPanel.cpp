@@ -0,0 +1,238 @@
+/*
+ * Copyright (c) 2022 Alex Spataru <https://github.com/alex-spataru>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "InputPanel.h"
+
+#include <QPainter>
+#include <QPaintEvent>
+
+/**
+ * Height of the axis bars & space between each row, in pixels
+ */
+static const int AXIS_HEIGHT = 12;
+static const int SPACING = 6;
+
+/**
+ * Number of columns used to display the buttons
+ */
+static const int COLUMNS = 3;
+
+/**
+ * Constructor function
+ */
+InputPanel::InputPanel(QWidget *parent)
+    : QWidget(parent)
+    , m_joystick(nullptr)
+{
+    setSizePolicy(QSizePolicy::Preferred, QSizePolicy::Fixed);
+    connect(&m_timer, &QTimer::timeout, this, &InputPanel::refresh);
+    setRefreshRate(60);
+}
+
+/**
+ * Returns the number of times per second that the joystick state is read
+ */
+int InputPanel::refreshRate() const
+{
+    return 1000 / qMax(1, m_timer.interval());
+}
+
+/**
+ * Returns the size needed to display every axis & button of the joystick
+ */
+QSize InputPanel::sizeHint() const
+{
+    const int rows = (m_buttons.count() + COLUMNS - 1) / COLUMNS;
+    return QSize(240, buttonsTop() + rows * (buttonHeight() + SPACING));
+}
+
+/**
+ * The panel cannot be smaller than its contents
+ */
+QSize InputPanel::minimumSizeHint() const
+{
+    return QSize(120, sizeHint().height());
+}
+
+/**
+ * Changes the number of times per second that the joystick state is read, which
+ * should not be higher than the refresh rate of the display.
+ */
+void InputPanel::setRefreshRate(const int hz)
+{
+    m_timer.setInterval(1000 / qBound(1, hz, 1000));
+}
+
+/**
+ * Displays the state of the given @a joystick, which must remain valid until another
+ * joystick (or @c nullptr) is set.
+ *
+ * The buffers used to store the state & the button labels only grow, so that switching
+ * between joysticks (or re-connecting one) does not allocate memory once every
+ * joystick has been displayed. The layout is only recalculated if the number of axes
+ * or buttons changes.
+ */
+void InputPanel::setJoystick(const QJoystickDevice *joystick)
+{
+    const auto previousAxes = m_axes.count();
+    const auto previousButtons = m_buttons.count();
+
+    m_joystick = joystick;
+    m_axes.resize(joystick ? joystick->axes.count() : 0);
+    m_buttons.resize(joystick ? joystick->buttons.count() : 0);
+    for (int i = 0; i < m_axes.count(); ++i)
+        m_axes[i] = joystick->axes.at(i);
+    for (int i = 0; i < m_buttons.count(); ++i)
+        m_buttons[i] = joystick->buttons.at(i);
+
+    while (m_labels.count() < m_buttons.count())
+    {
+        QStaticText label(tr("Butón %1").arg(m_labels.count() + 1));
+        label.setTextFormat(Qt::PlainText);
+        m_labels.append(label);
+    }
+
+    if (m_joystick)
+        m_timer.start();
+    else
+        m_timer.stop();
+
+    if (m_axes.count() != previousAxes || m_buttons.count() != previousButtons)
+        updateGeometry();
+
+    update();
+}
+
+/**
+ * Paints the axes & buttons within the region that needs to be updated
+ */
+void InputPanel::paintEvent(QPaintEvent *event)
+{
+    QPainter painter(this);
+    const auto &region = event->rect();
+    const auto pressed = palette().highlight();
+    const auto released = palette().base();
+
+    // Axis bars, filled from the center to the current value
+    for (int i = 0; i < m_axes.count(); ++i)
+    {
+        const auto rect = axisRect(i);
+        if (!rect.intersects(region))
+            continue;
+
+        painter.setPen(palette().color(QPalette::Mid));
+        painter.setBrush(released);
+        painter.drawRect(rect.adjusted(0, 0, -1, -1));
+
+        const auto center = rect.center().x();
+        const auto length = static_cast<int>(m_axes.at(i) * (rect.width() - 2) / 2);
+        QRect bar(QPoint(center, rect.top() + 1), QPoint(center + length, rect.bottom()));
+        painter.fillRect(bar.normalized(), pressed);
+    }
+
+    // Button indicators & names
+    painter.setRenderHint(QPainter::Antialiasing);
+    for (int i = 0; i < m_buttons.count(); ++i)
+    {
+        const auto rect = buttonRect(i);
+        if (!rect.intersects(region))
+            continue;
+
+        const auto size = rect.height() - 6;
+        QRectF indicator(rect.left() + 0.5, rect.top() + 3.5, size, size);
+        painter.setPen(palette().color(QPalette::Mid));
+        painter.setBrush(m_buttons.at(i) ? pressed : released);
+        painter.drawRoundedRect(indicator, 3, 3);
+
+        const auto &label = m_labels.at(i);
+        const auto y = rect.top() + (rect.height() - label.size().height()) / 2;
+        painter.setPen(palette().color(QPalette::Text));
+        painter.drawStaticText(QPointF(rect.left() + size + SPACING, y), label);
+    }
+}
+
+/**
+ * Reads the state of the joystick & schedules a repaint of the axes & buttons that
+ * changed since the previous refresh.
+ */
+void InputPanel::refresh()
+{
+    if (!m_joystick)
+        return;
+
+    const auto axes = qMin(m_axes.count(), m_joystick->axes.count());
+    for (int i = 0; i < axes; ++i)
+    {
+        const auto value = m_joystick->axes.at(i);
+        if (value != m_axes.at(i))
+        {
+            m_axes[i] = value;
+            update(axisRect(i));
+        }
+    }
+
+    const auto buttons = qMin(m_buttons.count(), m_joystick->buttons.count());
+    for (int i = 0; i < buttons; ++i)
+    {
+        const auto value = m_joystick->buttons.at(i);
+        if (value != m_buttons.at(i))
+        {
+            m_buttons[i] = value;
+            update(buttonRect(i));
+        }
+    }
+}
+
+/**
+ * Returns the height of each row of buttons
+ */
+int InputPanel::buttonHeight() const
+{
+    return fontMetrics().height() + 6;
+}
+
+/**
+ * Returns the vertical position of the first row of buttons
+ */
+int InputPanel::buttonsTop() const
+{
+    return m_axes.count() * (AXIS_HEIGHT + SPACING);
+}
+
+/**
+ * Returns the area of the widget used to display the given @a axis
+ */
+QRect InputPanel::axisRect(const int axis) const
+{
+    return QRect(0, axis * (AXIS_HEIGHT + SPACING), width(), AXIS_HEIGHT);
+}
+
+/**
+ * Returns the area of the widget used to display the given @a button
+ */
+QRect InputPanel::buttonRect(const int button) const
+{
+    const auto columnWidth = width() / COLUMNS;
+    const auto x = (button % COLUMNS) * columnWidth;
+    const auto y = buttonsTop() + (button / COLUMNS) * (buttonHeight() + SPACING);
+    return QRect(x, y, columnWidth, buttonHeight());
+}
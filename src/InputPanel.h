@@ -0,0 +1,74 @@
+/*
+ * Copyright (c) 2022 Alex Spataru <https://github.com/alex-spataru>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <QTimer>
+#include <QVector>
+#include <QWidget>
+#include <QStaticText>
+
+#include "QJoysticks.h"
+
+/**
+ * @brief The InputPanel class
+ *
+ * Displays the axes & buttons of a joystick. Instead of reacting to every input event,
+ * the panel reads the state of the joystick at the display refresh rate (60 Hz by
+ * default) and only repaints the axes & buttons whose value changed since the last
+ * refresh. Everything is painted by the panel itself, so that fast input does not
+ * cost one widget update per event.
+ */
+class InputPanel : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit InputPanel(QWidget *parent = nullptr);
+
+    int refreshRate() const;
+    QSize sizeHint() const override;
+    QSize minimumSizeHint() const override;
+
+public Q_SLOTS:
+    void setRefreshRate(const int hz);
+    void setJoystick(const QJoystickDevice *joystick);
+
+protected:
+    void paintEvent(QPaintEvent *event) override;
+
+private Q_SLOTS:
+    void refresh();
+
+private:
+    int buttonHeight() const;
+    int buttonsTop() const;
+    QRect axisRect(const int axis) const;
+    QRect buttonRect(const int button) const;
+
+private:
+    QTimer m_timer;
+    QVector<double> m_axes;
+    QVector<bool> m_buttons;
+    QVector<QStaticText> m_labels;
+    const QJoystickDevice *m_joystick;
+};
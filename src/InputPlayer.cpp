@@ -0,0 +1,353 @@
+/*
+ * Copyright (c) 2022 Alex Spataru <https://github.com/alex-spataru>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "InputPlayer.h"
+
+/**
+ * Number of events emitted in each iteration of the event loop when replaying as fast
+ * as possible, so that the application stays responsive.
+ */
+static const int FAST_BATCH_SIZE = 4096;
+
+/**
+ * Resizes the given @a list to @a count items, new items are set to @a value
+ */
+template<typename T>
+static void resizeList(QList<T> &list, const int count, const T &value)
+{
+    while (list.count() > count)
+        list.removeLast();
+    while (list.count() < count)
+        list.append(value);
+}
+
+/**
+ * Constructor function
+ */
+InputPlayer::InputPlayer(QObject *parent)
+    : QObject(parent)
+    , m_fast(false)
+    , m_playing(false)
+    , m_size(0)
+    , m_offset(0)
+    , m_elapsed(0)
+    , m_events(0)
+    , m_data(nullptr)
+{
+    // clang-format off
+    auto joysticks = QJoysticks::getInstance();
+    connect(this, &InputPlayer::POVEvent, joysticks, &QJoysticks::POVEvent);
+    connect(this, &InputPlayer::axisEvent, joysticks, &QJoysticks::axisEvent);
+    connect(this, &InputPlayer::buttonEvent, joysticks, &QJoysticks::buttonEvent);
+    connect(&m_timer, &QTimer::timeout, this, &InputPlayer::playEvents);
+    // clang-format on
+
+    m_timer.setSingleShot(true);
+    m_timer.setTimerType(Qt::PreciseTimer);
+}
+
+/**
+ * Destructor function, removes the replayed joysticks
+ */
+InputPlayer::~InputPlayer()
+{
+    stop();
+}
+
+/**
+ * Returns @c true while there are events left to replay
+ */
+bool InputPlayer::isPlaying() const
+{
+    return m_playing;
+}
+
+/**
+ * Returns the number of events replayed so far
+ */
+quint64 InputPlayer::eventCount() const
+{
+    return m_events;
+}
+
+/**
+ * Returns the time (in nanoseconds) spent replaying the log
+ */
+qint64 InputPlayer::elapsedTime() const
+{
+    if (m_playing)
+        return m_clock.nsecsElapsed();
+
+    return m_elapsed;
+}
+
+/**
+ * Returns the joysticks registered by the replay, in the order of the log
+ */
+QList<QJoystickDevice *> InputPlayer::devices() const
+{
+    QList<QJoystickDevice *> list;
+    for (int i = 0; i < m_devices.count(); ++i)
+    {
+        if (m_devices.at(i))
+            list.append(m_devices.at(i));
+    }
+
+    return list;
+}
+
+/**
+ * Maps the input log at the given @a path into memory. Returns @c false and writes
+ * the reason to @a error if the file is not a valid input log.
+ */
+bool InputPlayer::open(const QString &path, QString *error)
+{
+    stop();
+    m_file.close();
+    m_data = nullptr;
+
+    // Open & map the log file
+    m_file.setFileName(path);
+    if (m_file.open(QFile::ReadOnly))
+        m_data = m_file.map(0, m_file.size());
+
+    if (!m_data)
+    {
+        if (error)
+            *error = m_file.errorString();
+
+        m_file.close();
+        return false;
+    }
+
+    // Validate header
+    InputLog::Header header;
+    m_size = m_file.size();
+    if (m_size < InputLog::HEADER_SIZE || !InputLog::readHeader(m_data, header))
+    {
+        if (error)
+            *error = "Not a valid input log";
+
+        m_file.unmap(const_cast<uchar *>(m_data));
+        m_file.close();
+        m_data = nullptr;
+        return false;
+    }
+
+    m_offset = InputLog::HEADER_SIZE;
+    return true;
+}
+
+/**
+ * Sets a function that is called after each replayed event, e.g. to benchmark the
+ * generation of command frames.
+ */
+void InputPlayer::setEventHook(const std::function<void()> &hook)
+{
+    m_hook = hook;
+}
+
+/**
+ * Stops the replay & removes the replayed joysticks from @c QJoysticks
+ */
+void InputPlayer::stop()
+{
+    m_timer.stop();
+    if (m_playing)
+    {
+        m_playing = false;
+        m_elapsed = m_clock.nsecsElapsed();
+    }
+
+    auto joysticks = QJoysticks::getInstance();
+    for (int i = 0; i < m_devices.count(); ++i)
+    {
+        if (m_devices.at(i))
+        {
+            joysticks->unregisterDevice(m_devices.at(i));
+            delete m_devices.at(i);
+        }
+    }
+
+    m_devices.clear();
+}
+
+/**
+ * Starts replaying the log from the beginning. If @a fast is set, the events are
+ * emitted as fast as possible, otherwise the recorded timing is reproduced.
+ *
+ * The joysticks described at the beginning of the log are registered before this
+ * function returns.
+ */
+void InputPlayer::start(const bool fast)
+{
+    if (!m_data)
+        return;
+
+    stop();
+    m_fast = fast;
+    m_events = 0;
+    m_elapsed = 0;
+    m_playing = true;
+    m_offset = InputLog::HEADER_SIZE;
+
+    // Register the joysticks that were attached when the recording started
+    InputLog::Record record;
+    while (m_offset + InputLog::RECORD_SIZE <= m_size)
+    {
+        InputLog::readRecord(m_data + m_offset, record);
+        if (record.type != InputLog::Device)
+            break;
+
+        const auto name = m_data + m_offset + InputLog::RECORD_SIZE;
+        m_offset += InputLog::RECORD_SIZE + InputLog::paddedSize(record.id);
+        if (m_offset > m_size)
+            break;
+
+        updateDevice(record, name);
+    }
+
+    // Replay the events
+    m_clock.start();
+    playEvents();
+}
+
+/**
+ * Emits the events whose time has come (or a batch of events in fast mode) and
+ * schedules the next call of this function.
+ */
+void InputPlayer::playEvents()
+{
+    const auto now = static_cast<quint64>(m_clock.nsecsElapsed());
+
+    int batch = 0;
+    InputLog::Record record;
+    while (m_playing && m_offset + InputLog::RECORD_SIZE <= m_size)
+    {
+        // Wait until the event is due
+        InputLog::readRecord(m_data + m_offset, record);
+        if (!m_fast && record.timestamp > now)
+        {
+            const auto delay = (record.timestamp - now + 999999) / 1000000;
+            m_timer.start(static_cast<int>(delay));
+            return;
+        }
+
+        // Yield to the event loop from time to time
+        if (m_fast && batch >= FAST_BATCH_SIZE)
+        {
+            m_timer.start(0);
+            return;
+        }
+
+        // Joystick list changed
+        m_offset += InputLog::RECORD_SIZE;
+        if (record.type == InputLog::Device)
+        {
+            const auto name = m_data + m_offset;
+            m_offset += InputLog::paddedSize(record.id);
+            if (m_offset <= m_size)
+                updateDevice(record, name);
+
+            continue;
+        }
+
+        // Get device
+        auto device = record.joystick < m_devices.count() ? m_devices.at(record.joystick)
+                                                          : nullptr;
+        if (!device)
+            continue;
+
+        // Emit event
+        if (record.type == InputLog::Axis)
+        {
+            QJoystickAxisEvent event;
+            event.axis = record.id;
+            event.value = InputLog::unpackAxis(record.value);
+            event.joystick = device;
+            Q_EMIT axisEvent(event);
+        }
+
+        else if (record.type == InputLog::Button)
+        {
+            QJoystickButtonEvent event;
+            event.button = record.id;
+            event.pressed = record.value != 0;
+            event.joystick = device;
+            Q_EMIT buttonEvent(event);
+        }
+
+        else if (record.type == InputLog::POV)
+        {
+            QJoystickPOVEvent event;
+            event.pov = record.id;
+            event.angle = static_cast<qint32>(record.value);
+            event.joystick = device;
+            Q_EMIT POVEvent(event);
+        }
+
+        ++batch;
+        ++m_events;
+        if (m_hook)
+            m_hook();
+    }
+
+    // End of the log
+    if (m_playing)
+    {
+        m_playing = false;
+        m_elapsed = m_clock.nsecsElapsed();
+        Q_EMIT finished();
+    }
+}
+
+/**
+ * Creates or updates the replayed joystick described by the given device @a record
+ */
+void InputPlayer::updateDevice(const InputLog::Record &record, const uchar *name)
+{
+    if (m_devices.count() <= record.joystick)
+        m_devices.resize(record.joystick + 1);
+
+    auto device = m_devices.at(record.joystick);
+    const bool created = (device == nullptr);
+    if (created)
+    {
+        device = new QJoystickDevice;
+        device->id = -1;
+        device->instanceID = -1;
+        device->blacklisted = false;
+        m_devices[record.joystick] = device;
+    }
+
+    int axes, buttons, povs;
+    InputLog::unpackCounts(record.value, axes, buttons, povs);
+
+    auto text = QString::fromUtf8(reinterpret_cast<const char *>(name), record.id);
+    device->name = QString("Replay: %1").arg(text);
+    resizeList(device->axes, axes, 0.0);
+    resizeList(device->buttons, buttons, false);
+    resizeList(device->povs, povs, 0);
+
+    if (created)
+        QJoysticks::getInstance()->registerDevice(device);
+}
@@ -0,0 +1,96 @@
+/*
+ * Copyright (c) 2022 Alex Spataru <https://github.com/alex-spataru>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <QFile>
+#include <QTimer>
+#include <QObject>
+#include <QVector>
+#include <QElapsedTimer>
+
+#include <functional>
+
+#include "InputLog.h"
+#include "QJoysticks.h"
+
+/**
+ * @brief The InputPlayer class
+ *
+ * Replays an input log written by @c InputRecorder. The file is memory-mapped, so
+ * large logs are not loaded into RAM and reading an event does not copy any data.
+ *
+ * Each recorded joystick is registered with @c QJoysticks as an external device, and
+ * the recorded events are emitted through the @c QJoysticks event signals, so the rest
+ * of the application cannot tell a replay from a real joystick.
+ *
+ * Events are emitted with their original timing, or as fast as possible to measure the
+ * throughput of the input mapping & frame encoding stages.
+ */
+class InputPlayer : public QObject
+{
+    Q_OBJECT
+
+Q_SIGNALS:
+    void finished();
+    void POVEvent(const QJoystickPOVEvent &event);
+    void axisEvent(const QJoystickAxisEvent &event);
+    void buttonEvent(const QJoystickButtonEvent &event);
+
+public:
+    explicit InputPlayer(QObject *parent = nullptr);
+    ~InputPlayer();
+
+    bool isPlaying() const;
+    quint64 eventCount() const;
+    qint64 elapsedTime() const;
+    QList<QJoystickDevice *> devices() const;
+
+    bool open(const QString &path, QString *error = nullptr);
+    void setEventHook(const std::function<void()> &hook);
+
+public Q_SLOTS:
+    void stop();
+    void start(const bool fast = false);
+
+private Q_SLOTS:
+    void playEvents();
+
+private:
+    void updateDevice(const InputLog::Record &record, const uchar *name);
+
+private:
+    QFile m_file;
+    QTimer m_timer;
+    QElapsedTimer m_clock;
+
+    bool m_fast;
+    bool m_playing;
+    qint64 m_size;
+    qint64 m_offset;
+    qint64 m_elapsed;
+    quint64 m_events;
+    const uchar *m_data;
+
+    std::function<void()> m_hook;
+    QVector<QJoystickDevice *> m_devices;
+};
@@ -0,0 +1,221 @@
+/*
+ * Copyright (c) 2022 Alex Spataru <https://github.com/alex-spataru>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "InputRecorder.h"
+#include "QJoysticks.h"
+
+#include <QDateTime>
+
+/**
+ * Size of the write buffer, enough for 4096 events
+ */
+static const int BUFFER_SIZE = 4096 * InputLog::RECORD_SIZE;
+
+/**
+ * Maximum length of the device names stored in the log
+ */
+static const int MAX_NAME_LENGTH = 255;
+
+/**
+ * Constructor function
+ */
+InputRecorder::InputRecorder(QObject *parent)
+    : QObject(parent)
+    , m_used(0)
+    , m_events(0)
+{
+    connect(&m_flushTimer, &QTimer::timeout, this, &InputRecorder::flush);
+}
+
+/**
+ * Destructor function, writes pending events to the log
+ */
+InputRecorder::~InputRecorder()
+{
+    stop();
+}
+
+/**
+ * Returns @c true if input events are being written to a log file
+ */
+bool InputRecorder::isRecording() const
+{
+    return m_file.isOpen();
+}
+
+/**
+ * Returns the number of input events recorded since the log was created
+ */
+quint64 InputRecorder::eventCount() const
+{
+    return m_events;
+}
+
+/**
+ * Creates the log file at the given @a path and starts recording input events.
+ * Returns @c false and writes the reason to @a error if the file cannot be created.
+ */
+bool InputRecorder::start(const QString &path, QString *error)
+{
+    stop();
+
+    // Create log file
+    m_file.setFileName(path);
+    if (!m_file.open(QFile::WriteOnly | QFile::Truncate))
+    {
+        if (error)
+            *error = m_file.errorString();
+
+        return false;
+    }
+
+    // Allocate write buffer
+    m_used = 0;
+    m_events = 0;
+    m_buffer.resize(BUFFER_SIZE);
+
+    // Write file header
+    InputLog::Header header;
+    header.version = InputLog::VERSION;
+    header.startTime = QDateTime::currentMSecsSinceEpoch();
+    InputLog::writeHeader(reinterpret_cast<uchar *>(m_buffer.data()), header);
+    m_used = InputLog::HEADER_SIZE;
+    m_clock.start();
+
+    // clang-format off
+    auto joysticks = QJoysticks::getInstance();
+    connect(joysticks, &QJoysticks::countChanged,
+            this, &InputRecorder::onJoysticksChanged);
+    connect(joysticks, &QJoysticks::povChanged,
+            this, &InputRecorder::onPOVChanged);
+    connect(joysticks, &QJoysticks::axisChanged,
+            this, &InputRecorder::onAxisChanged);
+    connect(joysticks, &QJoysticks::buttonChanged,
+            this, &InputRecorder::onButtonChanged);
+    // clang-format on
+
+    // Describe the joysticks that are already attached
+    onJoysticksChanged();
+    m_flushTimer.start(1000);
+    return true;
+}
+
+/**
+ * Writes pending events & closes the log file
+ */
+void InputRecorder::stop()
+{
+    if (!isRecording())
+        return;
+
+    QJoysticks::getInstance()->disconnect(this);
+    m_flushTimer.stop();
+    flush();
+    m_file.close();
+}
+
+/**
+ * Writes the contents of the buffer to the log file
+ */
+void InputRecorder::flush()
+{
+    if (m_used > 0 && isRecording())
+    {
+        m_file.write(m_buffer.constData(), m_used);
+        m_file.flush();
+    }
+
+    m_used = 0;
+}
+
+/**
+ * Writes a device record (followed by the device name) for each attached joystick
+ */
+void InputRecorder::onJoysticksChanged()
+{
+    auto joysticks = QJoysticks::getInstance();
+    for (int i = 0; i < joysticks->count(); ++i)
+    {
+        auto device = joysticks->getInputDevice(i);
+        auto name = device->name.toUtf8().left(MAX_NAME_LENGTH);
+        auto size = InputLog::RECORD_SIZE + InputLog::paddedSize(name.length());
+        if (m_used + size > m_buffer.size())
+            flush();
+
+        auto counts = InputLog::packCounts(device->axes.count(), device->buttons.count(),
+                                           device->povs.count());
+        append(InputLog::Device, i, name.length(), counts);
+
+        auto data = reinterpret_cast<uchar *>(m_buffer.data()) + m_used;
+        memset(data, 0, InputLog::paddedSize(name.length()));
+        memcpy(data, name.constData(), name.length());
+        m_used += InputLog::paddedSize(name.length());
+    }
+}
+
+/**
+ * Records a POV event
+ */
+void InputRecorder::onPOVChanged(const int js, const int pov, const int angle)
+{
+    append(InputLog::POV, js, pov, static_cast<quint32>(angle));
+    ++m_events;
+}
+
+/**
+ * Records an axis event
+ */
+void InputRecorder::onAxisChanged(const int js, const int axis, const qreal value)
+{
+    append(InputLog::Axis, js, axis, InputLog::packAxis(static_cast<float>(value)));
+    ++m_events;
+}
+
+/**
+ * Records a button event
+ */
+void InputRecorder::onButtonChanged(const int js, const int button, const bool pressed)
+{
+    append(InputLog::Button, js, button, pressed ? 1 : 0);
+    ++m_events;
+}
+
+/**
+ * Serializes a record with the current timestamp into the write buffer, the buffer is
+ * written to the disk if it's full.
+ */
+void InputRecorder::append(const int type, const int js, const int id,
+                           const quint32 value)
+{
+    if (m_used + InputLog::RECORD_SIZE > m_buffer.size())
+        flush();
+
+    InputLog::Record record;
+    record.timestamp = static_cast<quint64>(m_clock.nsecsElapsed());
+    record.type = static_cast<quint8>(type);
+    record.joystick = static_cast<quint8>(js);
+    record.id = static_cast<quint16>(id);
+    record.value = value;
+
+    InputLog::writeRecord(reinterpret_cast<uchar *>(m_buffer.data()) + m_used, record);
+    m_used += InputLog::RECORD_SIZE;
+}
@@ -0,0 +1,78 @@
+/*
+ * Copyright (c) 2022 Alex Spataru <https://github.com/alex-spataru>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <QFile>
+#include <QTimer>
+#include <QObject>
+#include <QByteArray>
+#include <QElapsedTimer>
+
+#include "InputLog.h"
+
+/**
+ * @brief The InputRecorder class
+ *
+ * Appends every axis, button & POV event reported by @c QJoysticks to a binary input
+ * log (see @c InputLog.h), so that field sessions can be replayed later with
+ * @c InputPlayer.
+ *
+ * Records are serialized into a buffer that is allocated when the recording starts,
+ * and written to disk when the buffer is full or every second, so recording does not
+ * allocate memory nor perform a system call for each event.
+ */
+class InputRecorder : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit InputRecorder(QObject *parent = nullptr);
+    ~InputRecorder();
+
+    bool isRecording() const;
+    quint64 eventCount() const;
+
+    bool start(const QString &path, QString *error = nullptr);
+
+public Q_SLOTS:
+    void stop();
+    void flush();
+
+private Q_SLOTS:
+    void onJoysticksChanged();
+    void onPOVChanged(const int js, const int pov, const int angle);
+    void onAxisChanged(const int js, const int axis, const qreal value);
+    void onButtonChanged(const int js, const int button, const bool pressed);
+
+private:
+    void append(const int type, const int js, const int id, const quint32 value);
+
+private:
+    QFile m_file;
+    QTimer m_flushTimer;
+    QElapsedTimer m_clock;
+
+    int m_used;
+    quint64 m_events;
+    QByteArray m_buffer;
+};
@@ -0,0 +1,113 @@
+/*
+ * Copyright (c) 2022 Alex Spataru <https://github.com/alex-spataru>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "LineFramer.h"
+
+#include <cstring>
+
+/**
+ * Constructor function, lines longer than @a maxLineLength bytes are discarded
+ */
+LineFramer::LineFramer(const int maxLineLength)
+    : m_used(0)
+    , m_overflow(false)
+    , m_overflows(0)
+{
+    m_buffer.resize(maxLineLength);
+}
+
+/**
+ * Discards the incomplete line received so far
+ */
+void LineFramer::clear()
+{
+    m_used = 0;
+    m_overflow = false;
+}
+
+/**
+ * Returns the number of lines that were discarded because they were too long
+ */
+quint64 LineFramer::overflows() const
+{
+    return m_overflows;
+}
+
+/**
+ * Processes a chunk of @a length bytes received from the serial device and calls
+ * @a handler for each complete line.
+ */
+void LineFramer::append(const char *data, const int length, const LineHandler &handler)
+{
+    auto begin = data;
+    const auto end = data + length;
+    while (begin < end)
+    {
+        auto newline = static_cast<const char *>(memchr(begin, '\n', end - begin));
+        const int size = static_cast<int>((newline ? newline : end) - begin);
+
+        // Line is too long, discard it up to the next line ending
+        if (m_overflow || m_used + size > m_buffer.size())
+        {
+            if (!m_overflow)
+                ++m_overflows;
+
+            m_used = 0;
+            m_overflow = (newline == nullptr);
+        }
+
+        // Complete line without previous data, pass it without copying it
+        else if (newline && m_used == 0)
+            emitLine(begin, size, handler);
+
+        // Keep the incomplete line, or complete the line received so far
+        else
+        {
+            memcpy(m_buffer.data() + m_used, begin, size);
+            m_used += size;
+
+            if (newline)
+            {
+                emitLine(m_buffer.constData(), m_used, handler);
+                m_used = 0;
+            }
+        }
+
+        if (!newline)
+            break;
+
+        begin = newline + 1;
+    }
+}
+
+/**
+ * Removes the carriage return at the end of the given @a line and passes it to the
+ * @a handler, unless the line is empty.
+ */
+void LineFramer::emitLine(const char *line, int length, const LineHandler &handler)
+{
+    if (length > 0 && line[length - 1] == '\r')
+        --length;
+
+    if (length > 0)
+        handler(line, length);
+}
@@ -0,0 +1,58 @@
+/*
+ * Copyright (c) 2022 Alex Spataru <https://github.com/alex-spataru>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <QByteArray>
+
+#include <functional>
+
+/**
+ * @brief The LineFramer class
+ *
+ * Splits the byte stream received from the serial device into lines. Line endings
+ * ("\n" or "\r\n") are removed and empty lines are ignored.
+ *
+ * Complete lines contained in a received chunk are passed to the caller without being
+ * copied. Only the incomplete line at the end of a chunk is kept, in a buffer with a
+ * fixed capacity; lines that do not fit in the buffer are discarded.
+ */
+class LineFramer
+{
+public:
+    typedef std::function<void(const char *line, const int length)> LineHandler;
+
+    explicit LineFramer(const int maxLineLength = 1024);
+
+    void clear();
+    quint64 overflows() const;
+    void append(const char *data, const int length, const LineHandler &handler);
+
+private:
+    void emitLine(const char *line, int length, const LineHandler &handler);
+
+private:
+    int m_used;
+    bool m_overflow;
+    quint64 m_overflows;
+    QByteArray m_buffer;
+};
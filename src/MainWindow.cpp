@@ -23,60 +23,94 @@
 #include "MainWindow.h"
 #include "ui_MainWindow.h"
 
-#include <QtMath>
+#include <QFileDialog>
 
+#include "Bridge.h"
 #include "Serial.h"
+#include "Watchdog.h"
+#include "ProfileWatcher.h"
+#include "Telemetry.h"
+#include "ReliableLink.h"
 #include "Utilities.h"
 #include "QJoysticks.h"
 
+#include <QJoysticks/Evdev_Joysticks.h>
+
 MainWindow::MainWindow(QWidget *parent)
     : QMainWindow(parent)
     , m_ui(new Ui::MainWindow)
 {
-    m_spd1 = 0;
-    m_spd2 = 0;
-    m_stp1 = 0;
-    m_stp2 = 0;
-
     m_ui->setupUi(this);
-    m_axisLayout = new QVBoxLayout(m_ui->axesContainer);
-    m_buttonsLayout = new QGridLayout(m_ui->buttonsContainer);
-
-    m_axisLayout->setMargin(0);
-    m_axisLayout->setSpacing(6);
-    m_buttonsLayout->setMargin(0);
 
-    m_ui->axesContainer->setLayout(m_axisLayout);
-    m_ui->buttonsContainer->setLayout(m_buttonsLayout);
-
-    connect(&Serial::instance(), &Serial::dataSent, this, &MainWindow::onSerialDataSent);
     connect(&Serial::instance(), &Serial::dataReceived, this,
             &MainWindow::onSerialDataReceived);
     connect(&Serial::instance(), &Serial::availablePortsChanged, this,
             &MainWindow::refreshSerial);
+    connect(&Serial::instance(), &Serial::portChanged, this,
+            &MainWindow::refreshConnectButton);
+    connect(&Serial::instance(), &Serial::reconnectingChanged, this,
+            &MainWindow::refreshConnectButton);
+    connect(&Serial::instance(), &Serial::reconnected, this,
+            &MainWindow::onSerialReconnected);
+    connect(&Serial::instance(), &Serial::autoBaudChanged, this,
+            &MainWindow::refreshConnectButton);
+    connect(&Serial::instance(), &Serial::autoBaudFinished, this,
+            &MainWindow::onAutoBaudFinished);
 
-    connect(QJoysticks::getInstance(), &QJoysticks::axisChanged, this,
-            &MainWindow::onAxisChanged);
-    connect(QJoysticks::getInstance(), &QJoysticks::buttonChanged, this,
-            &MainWindow::onButtonChanged);
     connect(QJoysticks::getInstance(), &QJoysticks::countChanged, this,
             &MainWindow::refreshJoysticks);
 
+    connect(&Telemetry::instance(), &Telemetry::recordReceived, m_ui->telemetryPlot,
+            &TelemetryPlot::append);
+    connect(&Telemetry::instance(), &Telemetry::formatChanged, m_ui->telemetryPlot,
+            &TelemetryPlot::clear);
+
     connect(m_ui->connectButton, &QCheckBox::clicked, this,
             &MainWindow::onConnectButtonChanged);
+    connect(m_ui->autoBaud, &QPushButton::clicked, this, &MainWindow::onAutoBaudClicked);
+    connect(m_ui->loadProfile, &QPushButton::clicked, this,
+            &MainWindow::onLoadProfileClicked);
+    connect(&ProfileWatcher::instance(), &ProfileWatcher::profileReloaded, this,
+            &MainWindow::refreshProfile);
+    connect(&ProfileWatcher::instance(), &ProfileWatcher::reloadFailed, this,
+            &MainWindow::onProfileReloadFailed);
     connect(m_ui->baudRates, SIGNAL(currentIndexChanged(int)), this,
             SLOT(onBaudRateIndexChanged(int)));
     connect(m_ui->serialDevices, SIGNAL(currentIndexChanged(int)), this,
             SLOT(onDeviceIndexChanged(int)));
     connect(m_ui->joystickList, SIGNAL(currentIndexChanged(int)), this,
             SLOT(onJoystickIndexChanged(int)));
+    connect(m_ui->multiDevice, &QCheckBox::clicked, this,
+            &MainWindow::onMultiDeviceChanged);
+    connect(m_ui->evdevInput, &QCheckBox::toggled, QJoysticks::getInstance(),
+            &QJoysticks::setEvdevEnabled);
+    m_ui->evdevInput->setVisible(Evdev_Joysticks::isSupported());
+    connect(m_ui->reliableMode, &QCheckBox::toggled, &ReliableLink::instance(),
+            &ReliableLink::setEnabled);
+    connect(m_ui->autoReconnect, &QCheckBox::toggled, &Serial::instance(),
+            &Serial::setAutoReconnect);
+    Serial::instance().setAutoReconnect(m_ui->autoReconnect->isChecked());
 
     m_ui->baudRates->clear();
     m_ui->baudRates->addItems(Serial::instance().baudRateList());
     m_ui->baudRates->setCurrentIndex(Serial::instance().baudRateList().indexOf("115200"));
 
-    connect(&m_sendTimer, &QTimer::timeout, this, &MainWindow::sendData);
-    m_sendTimer.start(250);
+    connect(m_ui->sendRate, SIGNAL(valueChanged(int)), &Bridge::instance(),
+            SLOT(setSendRate(int)));
+    connect(m_ui->exportHistogram, &QPushButton::clicked, this,
+            &MainWindow::exportHistogram);
+    connect(m_ui->captureTraffic, &QPushButton::clicked, this,
+            &MainWindow::onCaptureButtonChanged);
+    connect(&m_timingTimer, &QTimer::timeout, this, &MainWindow::refreshTiming);
+
+    m_ui->sendRate->setMaximum(Scheduler::MAX_RATE);
+    m_ui->sendRate->setValue(Bridge::instance().sendRate());
+    m_allocations = Bridge::instance().allocationStats();
+    m_telemetryRecords = Telemetry::instance().recordCount();
+
+    // Start monitoring the joystick & the link
+    Watchdog::instance();
+    m_timingTimer.start(1000);
 }
 
 MainWindow::~MainWindow()
@@ -84,25 +118,6 @@ MainWindow::~MainWindow()
     delete m_ui;
 }
 
-void MainWindow::sendData()
-{
-    const int js = m_ui->joystickList->currentIndex();
-
-    if (QJoysticks::getInstance()->joystickExists(js))
-    {
-        const int spd1 = m_spd1 * 20;
-        const int spd2 = m_spd2 * 20;
-        m_stp2 = fmax(0, m_stp2);
-        m_stp2 = fmin(3200, m_stp2);
-        const auto data
-            = QString("%1,%2,%3,%4\n")
-                  .arg(QString::number((int)spd1), QString::number((int)spd2),
-                       QString::number((int)m_stp1), QString::number((int)m_stp2));
-
-        Serial::instance().write(data.toUtf8());
-    }
-}
-
 void MainWindow::refreshSerial()
 {
     auto index = m_ui->serialDevices->currentIndex();
@@ -116,71 +131,340 @@ void MainWindow::refreshSerial()
         m_ui->serialDevices->setCurrentIndex(0);
 }
 
+void MainWindow::refreshTiming()
+{
+    // Telemetry records decoded since the previous refresh (once per second)
+    auto records = Telemetry::instance().recordCount();
+    auto telemetry = tr("Telemetría: %1 registros/s, %2 errores")
+                         .arg(records - m_telemetryRecords)
+                         .arg(Telemetry::instance().errorCount());
+    m_telemetryRecords = records;
+
+    auto stats = Bridge::instance().stats().summary();
+    if (stats.count == 0)
+    {
+        m_ui->timing->setText(tr("Sin datos\n") + telemetry);
+        return;
+    }
+
+    // clang-format off
+    m_ui->timing->setText(tr("Periodo objetivo: %1 ms\n"
+                             "Mín: %2 ms / Prom: %3 ms\n"
+                             "P99: %4 ms / Máx: %5 ms\n"
+                             "Periodos perdidos: %6")
+                          .arg(stats.target / 1000.0, 0, 'f', 3)
+                          .arg(stats.minimum / 1000.0, 0, 'f', 3)
+                          .arg(stats.average / 1000.0, 0, 'f', 3)
+                          .arg(stats.p99 / 1000.0, 0, 'f', 3)
+                          .arg(stats.maximum / 1000.0, 0, 'f', 3)
+                          .arg(stats.overruns)
+                          + "\n" + telemetry);
+    // clang-format on
+
+    // Heap allocations since the previous refresh (CONFIG+=alloc_tracking)
+    if (AllocTracker::enabled())
+    {
+        auto current = Bridge::instance().allocationStats();
+        auto frames = current.frames - m_allocations.frames;
+        auto events = current.events - m_allocations.events;
+        auto perFrame = frames ? 1.0 * (current.frameAllocations
+                                        - m_allocations.frameAllocations) / frames : 0;
+        auto perEvent = events ? 1.0 * (current.mappingAllocations
+                                        - m_allocations.mappingAllocations) / events : 0;
+        m_allocations = current;
+
+        m_ui->timing->setText(m_ui->timing->text()
+                              + tr("\nAsignaciones: %1 por trama / %2 por evento (mapeo)")
+                                    .arg(perFrame, 0, 'f', 2)
+                                    .arg(perEvent, 0, 'f', 2));
+    }
+
+    // Failsafe mode & time needed to send the failsafe frame
+    auto watchdog = Watchdog::instance().stats();
+    if (Watchdog::instance().tripped())
+    {
+        const QString reasons[] = { QString(), tr("control desconectado"),
+                                    tr("sin eventos del control"),
+                                    tr("sin respuesta del dispositivo") };
+        m_ui->timing->setText(m_ui->timing->text()
+                              + tr("\nFAILSAFE: %1 (%2 ms)")
+                                    .arg(reasons[Watchdog::instance().reason()])
+                                    .arg(watchdog.lastLatency / 1000.0, 0, 'f', 3));
+    }
+
+    else if (watchdog.trips > 0)
+    {
+        m_ui->timing->setText(m_ui->timing->text()
+                              + tr("\nFailsafe: %1 veces / máx. %2 ms")
+                                    .arg(watchdog.trips)
+                                    .arg(watchdog.maximumLatency / 1000.0, 0, 'f', 3));
+    }
+
+    // Button-to-wire time of the emergency stops
+    auto stop = Bridge::instance().stopStats();
+    if (stop.count > 0)
+    {
+        m_ui->timing->setText(m_ui->timing->text()
+                              + tr("\nParos: %1 / último %2 ms / máx. %3 ms")
+                                    .arg(stop.count)
+                                    .arg(stop.last / 1000.0, 0, 'f', 3)
+                                    .arg(stop.maximum / 1000.0, 0, 'f', 3));
+    }
+
+    // Delivery of critical commands (reliable mode)
+    if (ReliableLink::instance().enabled())
+    {
+        auto link = ReliableLink::instance().stats();
+        m_ui->timing->setText(m_ui->timing->text()
+                              + tr("\nComandos: %1 confirmados / %2 reenvíos / "
+                                   "%3 fallidos\nRTT: %4 ms (prom. %5 ms, máx. %6 ms)")
+                                    .arg(link.acknowledged)
+                                    .arg(link.retransmissions)
+                                    .arg(link.failures)
+                                    .arg(link.rtt / 1000.0, 0, 'f', 3)
+                                    .arg(link.smoothedRtt / 1000.0, 0, 'f', 3)
+                                    .arg(link.maximumRtt / 1000.0, 0, 'f', 3));
+    }
+
+    // Time from the kernel timestamp of each input report until it has been applied
+    auto evdevJoysticks = QJoysticks::getInstance()->evdevJoysticks();
+    if (evdevJoysticks->isEnabled())
+    {
+        auto input = evdevJoysticks->stats();
+        m_ui->timing->setText(m_ui->timing->text()
+                              + tr("\nEntrada evdev: última %1 ms / máx. %2 ms")
+                                    .arg(input.lastLatency / 1000.0, 0, 'f', 3)
+                                    .arg(input.maximumLatency / 1000.0, 0, 'f', 3));
+    }
+
+    // Frames written to the serial port & frames dropped because the port was full
+    auto tx = Serial::instance().txStats();
+    if (tx.frames > 0 || tx.dropped > 0)
+    {
+        m_ui->timing->setText(m_ui->timing->text()
+                              + tr("\nTX: %1 tramas / %2 bytes / %3 descartadas")
+                                    .arg(tx.frames)
+                                    .arg(tx.bytes)
+                                    .arg(tx.dropped));
+    }
+
+    // Serial adapter losses & time needed to reopen it
+    auto reconnect = Serial::instance().reconnectStats();
+    if (reconnect.losses > 0)
+    {
+        m_ui->timing->setText(m_ui->timing->text()
+                              + tr("\nReconexiones: %1 de %2 / última %3 ms / máx. %4 ms")
+                                    .arg(reconnect.reconnects)
+                                    .arg(reconnect.losses)
+                                    .arg(reconnect.lastRecovery / 1000.0, 0, 'f', 3)
+                                    .arg(reconnect.maximumRecovery / 1000.0, 0, 'f', 3));
+    }
+}
+
+void MainWindow::exportHistogram()
+{
+    auto path = QFileDialog::getSaveFileName(this, tr("Exportar histograma"), QString(),
+                                             tr("Archivos CSV (*.csv)"));
+    if (path.isEmpty())
+        return;
+
+    QString error;
+    if (!Bridge::instance().stats().exportCsv(path, &error))
+        Utilities::showMessageBox("Error al exportar el histograma", error);
+}
+
+void MainWindow::onCaptureButtonChanged()
+{
+    if (Serial::instance().isCapturing())
+    {
+        Serial::instance().stopCapture();
+        m_ui->captureTraffic->setChecked(false);
+        return;
+    }
+
+    auto path = QFileDialog::getSaveFileName(this, tr("Capturar tráfico"), QString(),
+                                             tr("Capturas pcap (*.pcap)"));
+    QString error;
+    if (!path.isEmpty() && !Serial::instance().startCapture(path, &error))
+        Utilities::showMessageBox("Error al crear la captura", error);
+
+    m_ui->captureTraffic->setChecked(Serial::instance().isCapturing());
+}
+
 void MainWindow::refreshJoysticks()
 {
+    // Keep the joystick bound by the bridge selected, wherever it is now in the list.
+    // Nothing is selected if it has been removed, until it is plugged back or the user
+    // selects another joystick (the watchdog keeps the outputs in failsafe meanwhile).
+    const auto index = Bridge::instance().joystick();
+    m_ui->joystickList->blockSignals(true);
     m_ui->joystickList->clear();
     m_ui->joystickList->addItems(QJoysticks::getInstance()->deviceNames());
-    m_ui->joystickList->setCurrentIndex(0);
+    m_ui->joystickList->setCurrentIndex(index);
+    m_ui->joystickList->blockSignals(false);
+    m_ui->inputPanel->setJoystick(QJoysticks::getInstance()->getInputDevice(index));
+
+    if (m_ui->multiDevice->isChecked())
+        addJoystickChannels();
 }
 
-void MainWindow::onConnectButtonChanged()
+void MainWindow::onMultiDeviceChanged()
 {
-    if (Serial::instance().isOpen())
-        disconnectSerial();
-    else
-        connectSerial();
+    QVector<Bridge::Channel> channels;
+    if (m_ui->multiDevice->isChecked())
+    {
+        for (int i = 0; i < QJoysticks::getInstance()->count(); ++i)
+        {
+            Bridge::Channel channel;
+            channel.number = i + 1;
+            channel.joystick = i;
+            channel.profile = Bridge::instance().profile();
+            channels.append(channel);
+        }
+    }
+
+    Bridge::instance().setChannels(channels);
 }
 
-void MainWindow::onJoystickIndexChanged(int index)
+void MainWindow::addJoystickChannels()
 {
-    if (!QJoysticks::getInstance()->joystickExists(index))
+    // New joysticks get their own channel, the others stay bound to theirs
+    auto channels = Bridge::instance().channels();
+    const auto count = QJoysticks::getInstance()->count();
+
+    int number = 0;
+    QVector<bool> bound(count, false);
+    for (const auto &channel : channels)
+    {
+        number = qMax(number, channel.number);
+        if (channel.joystick >= 0 && channel.joystick < count)
+            bound[channel.joystick] = true;
+    }
+
+    const auto size = channels.count();
+    for (int i = 0; i < count; ++i)
+    {
+        if (bound.at(i))
+            continue;
+
+        Bridge::Channel channel;
+        channel.number = ++number;
+        channel.joystick = i;
+        channel.profile = Bridge::instance().profile();
+        channels.append(channel);
+    }
+
+    if (channels.count() != size)
+        Bridge::instance().setChannels(channels);
+}
+
+void MainWindow::onLoadProfileClicked()
+{
+    auto path = QFileDialog::getOpenFileName(this, tr("Cargar perfil"), QString(),
+                                             tr("Perfiles (*.json)"));
+    if (path.isEmpty())
         return;
 
-    for (int i = 0; i < m_axes.count(); ++i)
+    QString error;
+    if (!Bridge::instance().loadProfile(path, &error))
     {
-        m_axisLayout->removeWidget(m_axes.at(i));
-        m_axes.at(i)->deleteLater();
+        Utilities::showMessageBox("Error al cargar el perfil", error);
+        return;
     }
 
-    for (int i = 0; i < m_buttons.count(); ++i)
+    // The channels use a copy of the profile, & keep their joysticks
+    if (m_ui->multiDevice->isChecked())
     {
-        m_buttonsLayout->removeWidget(m_buttons.at(i));
-        m_buttons.at(i)->deleteLater();
+        auto channels = Bridge::instance().channels();
+        for (auto &channel : channels)
+            channel.profile = Bridge::instance().profile();
+
+        Bridge::instance().setChannels(channels);
     }
 
-    m_axes.clear();
-    m_buttons.clear();
+    refreshProfile();
+}
+
+void MainWindow::refreshProfile()
+{
+    const auto &profile = Bridge::instance().profile();
+    m_ui->loadProfile->setText(tr("Perfil: %1").arg(profile.name()));
+    m_ui->loadProfile->setToolTip(profile.path());
+}
 
-    for (int i = 0; i < QJoysticks::getInstance()->getNumAxes(index); ++i)
+void MainWindow::onProfileReloadFailed(const QString &path, const QString &error)
+{
+    // Keep working with the previous profile until the file is fixed
+    m_ui->loadProfile->setText(tr("Perfil: %1 (archivo no válido)")
+                                   .arg(Bridge::instance().profile().name()));
+    m_ui->loadProfile->setToolTip(path + "\n" + error);
+}
+
+void MainWindow::onConnectButtonChanged()
+{
+    if (Serial::instance().isOpen() || Serial::instance().isReconnecting())
+        disconnectSerial();
+    else
+        connectSerial();
+}
+
+void MainWindow::refreshConnectButton()
+{
+    const auto detecting = Serial::instance().isDetectingBaudRate();
+    m_ui->autoBaud->setEnabled(Serial::instance().isOpen() && !detecting);
+    m_ui->autoBaud->setText(detecting ? "Detectando..." : "Detectar velocidad");
+
+    if (Serial::instance().isOpen())
     {
-        auto progress = new QProgressBar(this);
-        progress->setMinimumHeight(12);
-        progress->setMinimum(-100);
-        progress->setMaximum(100);
+        m_ui->connectButton->setChecked(true);
+        m_ui->connectButton->setText("Desconectar");
+    }
 
-        m_axisLayout->addWidget(progress);
-        m_axes.append(progress);
+    else if (Serial::instance().isReconnecting())
+    {
+        m_ui->connectButton->setChecked(true);
+        m_ui->connectButton->setText("Reconectando...");
     }
 
-    int row = 0;
-    int column = 0;
-    for (int i = 0; i < QJoysticks::getInstance()->getNumButtons(index); ++i)
+    else
     {
-        auto button = new QCheckBox(this);
-        button->setText(tr("Butón %1").arg(i + 1));
-        button->setAttribute(Qt::WA_TransparentForMouseEvents);
-        button->setFocusPolicy(Qt::NoFocus);
+        m_ui->connectButton->setChecked(false);
+        m_ui->connectButton->setText("Conectar");
+    }
+}
 
-        m_buttonsLayout->addWidget(button, row, column);
-        m_buttons.append(button);
+void MainWindow::onSerialReconnected()
+{
+    // The adapter may have been listed with a different name or position
+    m_ui->serialDevices->setCurrentIndex(Serial::instance().portIndex());
+    refreshConnectButton();
+}
 
-        ++column;
-        if (column > 2)
-        {
-            column = 0;
-            ++row;
-        }
+void MainWindow::onAutoBaudClicked()
+{
+    Serial::instance().startAutoBaud();
+}
+
+void MainWindow::onAutoBaudFinished(const qint32 rate)
+{
+    if (rate > 0)
+    {
+        auto index = Serial::instance().baudRateList().indexOf(QString::number(rate));
+        m_ui->baudRates->setCurrentIndex(index);
     }
+
+    else if (Serial::instance().isOpen())
+    {
+        Utilities::showMessageBox(
+            "No se detectó la velocidad",
+            "El dispositivo no envió datos válidos a ninguna velocidad");
+    }
+}
+
+void MainWindow::onJoystickIndexChanged(int index)
+{
+    Bridge::instance().setJoystick(index);
+    m_ui->inputPanel->setJoystick(QJoysticks::getInstance()->getInputDevice(index));
 }
 
 void MainWindow::connectSerial()
@@ -218,97 +502,12 @@ void MainWindow::onBaudRateIndexChanged(int index)
     Serial::instance().setBaudRate(baud.toInt());
 }
 
-void MainWindow::onSerialDataSent(const QByteArray &data)
-{
-    // m_ui->console->append("<font color='#f88'><strong>TX:</strong> " +
-    // QString::fromUtf8(data) + "</font>");
-}
-
 void MainWindow::onSerialDataReceived(const QByteArray &data)
 {
-    auto text = QString::fromUtf8(data).replace("\r\n", "\n");
-    m_buffer.append(text);
-
-    while (m_buffer.contains("\n"))
-    {
-        auto currentLine = m_buffer.split("\n").first().replace("\n", "");
-        if (currentLine.isEmpty())
-        {
-            m_buffer.remove(0, 1);
-            continue;
-        }
-
+    m_framer.append(data.constData(), data.size(), [this](const char *line, int length) {
+        auto currentLine = QString::fromUtf8(line, length);
         m_ui->currentLine->setText(currentLine);
         m_ui->console->append("<font color='#88f'><strong>RX:</strong> " + currentLine
                               + "</font>");
-        m_buffer.remove(0, currentLine.length() + 1);
-    }
-}
-
-void MainWindow::onAxisChanged(const int js, const int axis, const qreal value)
-{
-    if (js == m_ui->joystickList->currentIndex())
-    {
-        if (axis < m_axes.count())
-        {
-            m_axes.at(axis)->setValue(value * 100);
-
-            if (axis == 5)
-                m_spd1 = value;
-            else if (axis == 4)
-                m_spd2 = value;
-        }
-    }
-}
-
-void MainWindow::onButtonChanged(const int js, const int button, const bool pressed)
-{
-    if (js == m_ui->joystickList->currentIndex())
-    {
-        if (button < m_buttons.count())
-        {
-            m_buttons.at(button)->setChecked(pressed);
-
-            if (pressed)
-            {
-                if (button == 1)
-                    m_stp1 = 0;
-                else if (button == 3)
-                    m_stp1 = 90;
-                else if (button == 2)
-                    m_stp1 = 180;
-                else if (button == 0)
-                    m_stp1 = 270;
-
-                else if (button == 13)
-                    m_stp2 += 360;
-                else if (button == 14)
-                    m_stp2 -= 360;
-
-                else if (button == 5)
-                {
-                    m_spd1 = 1;
-                    m_spd2 = 0;
-                }
-                else if (button == 4)
-                {
-                    m_spd1 = 0;
-                    m_spd2 = 1;
-                }
-            }
-            else
-            {
-                if (button == 5)
-                {
-                    m_spd1 = 0;
-                    m_spd2 = 0;
-                }
-                else if (button == 4)
-                {
-                    m_spd1 = 0;
-                    m_spd2 = 0;
-                }
-            }
-        }
-    }
+    });
 }
@@ -23,11 +23,10 @@
 #pragma once
 
 #include <QTimer>
-#include <QCheckBox>
 #include <QMainWindow>
-#include <QVBoxLayout>
-#include <QGridLayout>
-#include <QProgressBar>
+
+#include "Bridge.h"
+#include "LineFramer.h"
 
 namespace Ui
 {
@@ -43,36 +42,33 @@ public:
     ~MainWindow();
 
 private slots:
-    void sendData();
     void refreshSerial();
+    void refreshTiming();
+    void exportHistogram();
     void refreshJoysticks();
+    void onCaptureButtonChanged();
+    void onMultiDeviceChanged();
+    void addJoystickChannels();
+    void onLoadProfileClicked();
+    void refreshProfile();
+    void onProfileReloadFailed(const QString &path, const QString &error);
     void onConnectButtonChanged();
+    void refreshConnectButton();
+    void onSerialReconnected();
+    void onAutoBaudClicked();
+    void onAutoBaudFinished(const qint32 rate);
     void onJoystickIndexChanged(int index);
 
     void connectSerial();
     void disconnectSerial();
     void onDeviceIndexChanged(int index);
     void onBaudRateIndexChanged(int index);
-    void onSerialDataSent(const QByteArray &data);
     void onSerialDataReceived(const QByteArray &data);
 
-    void onAxisChanged(const int js, const int axis, const qreal value);
-    void onButtonChanged(const int js, const int button, const bool pressed);
-
 private:
     Ui::MainWindow *m_ui;
-    QString m_buffer;
-
-    QVBoxLayout *m_axisLayout;
-    QGridLayout *m_buttonsLayout;
-
-    QList<QProgressBar *> m_axes;
-    QList<QCheckBox *> m_buttons;
-
-    double m_spd1;
-    double m_spd2;
-    double m_stp1;
-    double m_stp2;
-
-    QTimer m_sendTimer;
+    LineFramer m_framer;
+    QTimer m_timingTimer;
+    quint64 m_telemetryRecords;
+    Bridge::AllocationStats m_allocations;
 };
@@ -0,0 +1,176 @@
+/*
+ * Copyright (c) 2022 Alex Spataru <https://github.com/alex-spataru>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+#include "Mixer.h"
+
+#include <cmath>
+#include <cstring>
+
+/**
+ * Constructor function, creates a mixer without inputs or outputs
+ */
+Mixer::Mixer()
+    : m_inputs(0)
+    , m_outputs(0)
+{
+    memset(m_axes, 0, sizeof(m_axes));
+    memset(m_targets, 0, sizeof(m_targets));
+    memset(m_normalize, 0, sizeof(m_normalize));
+    memset(m_weights, 0, sizeof(m_weights));
+}
+
+/**
+ * Returns @c true if the mixer does not drive any output
+ */
+bool Mixer::isEmpty() const
+{
+    return m_outputs == 0;
+}
+
+/**
+ * Returns the number of axes read by the mixer
+ */
+int Mixer::inputCount() const
+{
+    return m_inputs;
+}
+
+/**
+ * Returns the number of outputs driven by the mixer
+ */
+int Mixer::outputCount() const
+{
+    return m_outputs;
+}
+
+/**
+ * Returns the joystick axis read by the given mixer @a input
+ */
+int Mixer::inputAxis(const int input) const
+{
+    Q_ASSERT(input >= 0 && input < m_inputs);
+    return m_axes[input];
+}
+
+/**
+ * Returns the profile output driven by the given mixer @a output
+ */
+int Mixer::outputTarget(const int output) const
+{
+    Q_ASSERT(output >= 0 && output < m_outputs);
+    return m_targets[output];
+}
+
+/**
+ * Returns the weight of the given @a input in the given @a output
+ */
+float Mixer::weight(const int output, const int input) const
+{
+    Q_ASSERT(output >= 0 && output < m_outputs);
+    Q_ASSERT(input >= 0 && input < m_inputs);
+    return m_weights[input][output];
+}
+
+/**
+ * Returns how the given @a output is limited to -1..1
+ */
+Mixer::Saturation Mixer::saturation(const int output) const
+{
+    Q_ASSERT(output >= 0 && output < m_outputs);
+    return m_normalize[output] != 0 ? Normalize : Clip;
+}
+
+/**
+ * Adds an input that reads the given joystick @a axis, returns the index of the new
+ * input or -1 if the mixer already has @c MAX_INPUTS inputs.
+ */
+int Mixer::addInput(const int axis)
+{
+    if (m_inputs >= MAX_INPUTS)
+        return -1;
+
+    m_axes[m_inputs] = axis;
+    return m_inputs++;
+}
+
+/**
+ * Adds an output that drives the profile output at the index @a target, with every
+ * weight set to zero. Returns the index of the new output or -1 if the mixer already
+ * has @c MAX_OUTPUTS outputs.
+ */
+int Mixer::addOutput(const int target, const Saturation saturation)
+{
+    if (m_outputs >= MAX_OUTPUTS)
+        return -1;
+
+    m_targets[m_outputs] = target;
+    m_normalize[m_outputs] = saturation == Normalize ? 1 : 0;
+    return m_outputs++;
+}
+
+/**
+ * Changes the weight of the given @a input in the given @a output
+ */
+void Mixer::setWeight(const int output, const int input, const float weight)
+{
+    Q_ASSERT(output >= 0 && output < m_outputs);
+    Q_ASSERT(input >= 0 && input < m_inputs);
+    m_weights[input][output] = weight;
+}
+
+/**
+ * Mixes the values of the input axes, read from the array of @a axisCount @a axes,
+ * into @a outputs, which must have room for @c MAX_OUTPUTS values. Axes that are not
+ * available read as 0.
+ */
+void Mixer::mix(const double *axes, const int axisCount, float *outputs) const
+{
+    // Gather the inputs, unused inputs are zero
+    float inputs[MAX_INPUTS] = {};
+    for (int i = 0; i < m_inputs; ++i)
+    {
+        const auto axis = m_axes[i];
+        inputs[i] = axis < axisCount ? static_cast<float>(axes[axis]) : 0;
+    }
+
+    // Dense multiply, one column of weights per input
+    float mixed[MAX_OUTPUTS] = {};
+    for (int i = 0; i < MAX_INPUTS; ++i)
+    {
+        for (int o = 0; o < MAX_OUTPUTS; ++o)
+            mixed[o] += m_weights[i][o] * inputs[i];
+    }
+
+    // Largest normalized output, never less than 1
+    float peak = 1;
+    for (int o = 0; o < MAX_OUTPUTS; ++o)
+        peak = std::fmax(peak, std::fabs(mixed[o]) * m_normalize[o]);
+
+    // Scale normalized outputs & clip the others
+    const auto inverse = 1 / peak;
+    for (int o = 0; o < MAX_OUTPUTS; ++o)
+    {
+        const auto value = mixed[o] * (1 + m_normalize[o] * (inverse - 1));
+        outputs[o] = std::fmin(1.0f, std::fmax(-1.0f, value));
+    }
+}
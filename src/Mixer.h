@@ -0,0 +1,83 @@
+/*
+ * Copyright (c) 2022 Alex Spataru <https://github.com/alex-spataru>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <QtGlobal>
+
+/**
+ * @brief The Mixer class
+ *
+ * Mixes up to @c MAX_INPUTS joystick axes into up to @c MAX_OUTPUTS outputs with a
+ * matrix of weights, e.g. for differential (tank/arcade) or mecanum drives:
+ *
+ *     arcade:  left = throttle + turn, right = throttle - turn
+ *     mecanum: front left = y + x + r, front right = y - x - r,
+ *              rear left = y - x + r, rear right = y + x - r
+ *
+ * The weights are stored in a fixed-size float matrix in which unused inputs and
+ * outputs are zero, so that mixing is always the same dense multiply with constant
+ * loop counts, which the compiler can unroll & vectorize.
+ *
+ * Each output saturates in one of two ways when the mixed value exceeds -1..1:
+ *
+ * - @c Clip limits the output to -1..1, regardless of the other outputs.
+ * - @c Normalize divides every normalized output by the largest of them, so that
+ *   their ratios (e.g. the turn rate of a differential drive) are preserved.
+ */
+class Mixer
+{
+public:
+    static const int MAX_INPUTS = 8;
+    static const int MAX_OUTPUTS = 8;
+
+    enum Saturation
+    {
+        Clip,
+        Normalize
+    };
+
+    Mixer();
+
+    bool isEmpty() const;
+    int inputCount() const;
+    int outputCount() const;
+    int inputAxis(const int input) const;
+    int outputTarget(const int output) const;
+    float weight(const int output, const int input) const;
+    Saturation saturation(const int output) const;
+
+    int addInput(const int axis);
+    int addOutput(const int target, const Saturation saturation);
+    void setWeight(const int output, const int input, const float weight);
+
+    void mix(const double *axes, const int axisCount, float *outputs) const;
+
+private:
+    int m_inputs;
+    int m_outputs;
+    int m_axes[MAX_INPUTS];
+    int m_targets[MAX_OUTPUTS];
+    float m_normalize[MAX_OUTPUTS];
+    float m_weights[MAX_INPUTS][MAX_OUTPUTS];
+};
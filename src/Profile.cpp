@@ -0,0 +1,490 @@
+/*
+ * Copyright (c) 2022 Alex Spataru <https://github.com/alex-spataru>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "Profile.h"
+
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QStringList>
+#include <QJsonDocument>
+
+#include <limits>
+
+/**
+ * Highest axis/button number accepted in a profile, used to reject bogus documents
+ * before they allocate huge lookup tables.
+ */
+static const int MAX_INPUT_ID = 255;
+
+/**
+ * Stores the given @a message in @a error (if set) and returns @c false
+ */
+static bool fail(QString *error, const QString &message)
+{
+    if (error)
+        *error = message;
+
+    return false;
+}
+
+/**
+ * Reads the "set" and "add" groups of the given button @a object and appends the
+ * resulting actions to the @a actions list.
+ */
+static bool parseActions(const QJsonObject &object, const Profile &profile,
+                         QVector<Profile::Action> &actions, QString *error)
+{
+    const QString groups[] = { "set", "add" };
+    const Profile::ActionType types[] = { Profile::SetValue, Profile::AddValue };
+
+    for (int i = 0; i < 2; ++i)
+    {
+        auto group = object.value(groups[i]).toObject();
+        for (auto it = group.constBegin(); it != group.constEnd(); ++it)
+        {
+            auto output = profile.outputIndex(it.key());
+            if (output < 0)
+                return fail(error, QString("Unknown output \"%1\"").arg(it.key()));
+
+            if (!it.value().isDouble())
+                return fail(error,
+                            QString("Invalid value for output \"%1\"").arg(it.key()));
+
+            Profile::Action action;
+            action.type = types[i];
+            action.output = output;
+            action.value = it.value().toDouble();
+            actions.append(action);
+        }
+    }
+
+    return true;
+}
+
+//----------------------------------------------------------------------------------------
+// Constructor & accessors
+//----------------------------------------------------------------------------------------
+
+/**
+ * Constructor function, creates an empty profile without outputs
+ */
+Profile::Profile()
+    : m_registers(0)
+    , m_memory(0)
+{
+    m_emergencyStop.button = -1;
+    m_emergencyStop.repeat = 0;
+}
+
+/**
+ * Returns the display name of the profile
+ */
+QString Profile::name() const
+{
+    return m_name;
+}
+
+/**
+ * Returns the file from which the profile was loaded, or an empty string if the profile
+ * was not loaded with @c load()
+ */
+QString Profile::path() const
+{
+    return m_path;
+}
+
+/**
+ * Returns the number of fields of each command frame
+ */
+int Profile::outputCount() const
+{
+    return m_outputs.count();
+}
+
+/**
+ * Returns the index of the output with the given @a name, or -1 if not found
+ */
+int Profile::outputIndex(const QString &name) const
+{
+    for (int i = 0; i < m_outputs.count(); ++i)
+    {
+        if (m_outputs.at(i).name == name)
+            return i;
+    }
+
+    return -1;
+}
+
+/**
+ * Returns the properties of the output at the given @a index
+ */
+const Profile::Output &Profile::output(const int index) const
+{
+    Q_ASSERT(index >= 0 && index < m_outputs.count());
+    return m_outputs.at(index);
+}
+
+/**
+ * Limits the given @a value to the range allowed by the @a output
+ */
+double Profile::clamp(const int output, const double value) const
+{
+    const auto &out = m_outputs.at(output);
+    return qBound(out.minimum, value, out.maximum);
+}
+
+/**
+ * Returns @c true if the value sent for any output is limited in speed or acceleration
+ */
+bool Profile::hasShaping() const
+{
+    for (const auto &output : m_outputs)
+    {
+        if (Shaper::isLimited(output.shaping))
+            return true;
+    }
+
+    return false;
+}
+
+/**
+ * Returns the outputs driven by the given @a axis
+ */
+const QVector<Profile::AxisBinding> &Profile::axisBindings(const int axis) const
+{
+    static const QVector<AxisBinding> none;
+    if (axis >= 0 && axis < m_axes.count())
+        return m_axes.at(axis);
+
+    return none;
+}
+
+/**
+ * Returns the actions executed when the given @a button is pressed
+ */
+const QVector<Profile::Action> &Profile::pressActions(const int button) const
+{
+    static const QVector<Action> none;
+    if (button >= 0 && button < m_press.count())
+        return m_press.at(button);
+
+    return none;
+}
+
+/**
+ * Returns the actions executed when the given @a button is released
+ */
+const QVector<Profile::Action> &Profile::releaseActions(const int button) const
+{
+    static const QVector<Action> none;
+    if (button >= 0 && button < m_release.count())
+        return m_release.at(button);
+
+    return none;
+}
+
+/**
+ * Returns the emergency stop button & frame, the button is -1 if the profile does not
+ * define an emergency stop.
+ */
+const Profile::EmergencyStop &Profile::emergencyStop() const
+{
+    return m_emergencyStop;
+}
+
+/**
+ * Returns the axis mixing matrix, which is empty if the profile does not mix axes
+ */
+const Mixer &Profile::mixer() const
+{
+    return m_mixer;
+}
+
+/**
+ * Returns the number of registers needed to evaluate every output expression
+ */
+int Profile::registerCount() const
+{
+    return m_registers;
+}
+
+/**
+ * Returns the number of values remembered between the evaluations of the output
+ * expressions (see @c Expression::memoryCount())
+ */
+int Profile::memoryCount() const
+{
+    return m_memory;
+}
+
+/**
+ * Returns the output expressions in evaluation order. Each expression uses the
+ * registers & memory starting at its offsets.
+ */
+const QVector<Profile::Transform> &Profile::transforms() const
+{
+    return m_transforms;
+}
+
+//----------------------------------------------------------------------------------------
+// Profile loading
+//----------------------------------------------------------------------------------------
+
+/**
+ * Returns the built-in profile, which drives the two speed outputs with axes 4 & 5 and
+ * positions the steppers with the face buttons & the D-pad.
+ */
+Profile Profile::defaultProfile()
+{
+    Profile profile;
+    QString error;
+    if (!load(":/profiles/default.json", profile, &error))
+        qFatal("Cannot load built-in profile: %s", qPrintable(error));
+
+    return profile;
+}
+
+/**
+ * Reads the JSON document at the given @a path into @a profile. On failure, @a profile
+ * is left untouched and a description of the problem is written to @a error.
+ */
+bool Profile::load(const QString &path, Profile &profile, QString *error)
+{
+    QFile file(path);
+    if (!file.open(QFile::ReadOnly))
+        return fail(error, file.errorString());
+
+    if (!parse(file.readAll(), profile, error))
+        return false;
+
+    profile.m_path = path;
+    return true;
+}
+
+/**
+ * Validates the given @a json document and compiles it into @a profile. On failure,
+ * @a profile is left untouched and a description of the problem is written to @a error.
+ */
+bool Profile::parse(const QByteArray &json, Profile &profile, QString *error)
+{
+    // Parse JSON document
+    QJsonParseError parseError;
+    auto document = QJsonDocument::fromJson(json, &parseError);
+    if (parseError.error != QJsonParseError::NoError)
+        return fail(error, parseError.errorString());
+    if (!document.isObject())
+        return fail(error, "Profile must be a JSON object");
+
+    // Read profile name
+    Profile result;
+    auto root = document.object();
+    result.m_name = root.value("name").toString();
+
+    // Register outputs (frame fields)
+    auto outputs = root.value("outputs").toArray();
+    if (outputs.isEmpty())
+        return fail(error, "Profile does not define any output");
+
+    for (int i = 0; i < outputs.count(); ++i)
+    {
+        auto object = outputs.at(i).toObject();
+
+        Output output;
+        output.name = object.value("name").toString();
+        output.scale = object.value("scale").toDouble(1);
+        output.minimum = object.value("min").toDouble(-std::numeric_limits<double>::max());
+        output.maximum = object.value("max").toDouble(std::numeric_limits<double>::max());
+        output.failsafe = object.value("failsafe").toDouble(0);
+        output.shaping.rate = object.value("rate").toDouble(0);
+        output.shaping.acceleration = object.value("accel").toDouble(0);
+        output.shaping.jerk = object.value("jerk").toDouble(0);
+
+        if (output.name.isEmpty())
+            return fail(error, QString("Output %1 has no name").arg(i));
+        if (result.outputIndex(output.name) >= 0)
+            return fail(error, QString("Duplicated output \"%1\"").arg(output.name));
+        if (output.minimum > output.maximum)
+            return fail(error, QString("Invalid range for output \"%1\"").arg(output.name));
+
+        const auto &shaping = output.shaping;
+        if (shaping.rate < 0 || shaping.acceleration < 0 || shaping.jerk < 0)
+            return fail(error,
+                        QString("Invalid limits for output \"%1\"").arg(output.name));
+        if (shaping.jerk > 0 && shaping.acceleration <= 0)
+            return fail(error, QString("Output \"%1\" needs an acceleration to limit "
+                                       "the jerk")
+                                   .arg(output.name));
+
+        result.m_outputs.append(output);
+    }
+
+    // Compile axis bindings
+    auto axes = root.value("axes").toArray();
+    for (int i = 0; i < axes.count(); ++i)
+    {
+        auto object = axes.at(i).toObject();
+        auto axis = object.value("axis").toInt(-1);
+        auto name = object.value("output").toString();
+
+        AxisBinding binding;
+        binding.output = result.outputIndex(name);
+        binding.scale = object.value("scale").toDouble(1);
+
+        if (axis < 0 || axis > MAX_INPUT_ID)
+            return fail(error, QString("Invalid axis in binding %1").arg(i));
+        if (binding.output < 0)
+            return fail(error, QString("Unknown output \"%1\"").arg(name));
+
+        if (result.m_axes.count() <= axis)
+            result.m_axes.resize(axis + 1);
+
+        result.m_axes[axis].append(binding);
+    }
+
+    // Compile button actions
+    auto buttons = root.value("buttons").toArray();
+    for (int i = 0; i < buttons.count(); ++i)
+    {
+        auto object = buttons.at(i).toObject();
+        auto button = object.value("button").toInt(-1);
+        if (button < 0 || button > MAX_INPUT_ID)
+            return fail(error, QString("Invalid button in binding %1").arg(i));
+
+        if (result.m_press.count() <= button)
+        {
+            result.m_press.resize(button + 1);
+            result.m_release.resize(button + 1);
+        }
+
+        if (!parseActions(object.value("pressed").toObject(), result,
+                          result.m_press[button], error))
+            return false;
+
+        if (!parseActions(object.value("released").toObject(), result,
+                          result.m_release[button], error))
+            return false;
+    }
+
+    // Read the mixing matrix, one weight per input axis for each mixed output
+    if (root.contains("mixer"))
+    {
+        auto object = root.value("mixer").toObject();
+        auto inputs = object.value("inputs").toArray();
+        auto mixed = object.value("outputs").toArray();
+        if (inputs.isEmpty() || inputs.count() > Mixer::MAX_INPUTS)
+            return fail(error, "Invalid number of mixer inputs");
+        if (mixed.isEmpty() || mixed.count() > Mixer::MAX_OUTPUTS)
+            return fail(error, "Invalid number of mixer outputs");
+
+        for (int i = 0; i < inputs.count(); ++i)
+        {
+            auto axis = inputs.at(i).toInt(-1);
+            if (axis < 0 || axis >= Expression::MAX_INPUTS)
+                return fail(error, QString("Invalid axis in mixer input %1").arg(i));
+
+            result.m_mixer.addInput(axis);
+        }
+
+        for (int i = 0; i < mixed.count(); ++i)
+        {
+            auto row = mixed.at(i).toObject();
+            auto name = row.value("output").toString();
+            auto mode = row.value("saturation").toString("normalize");
+            auto weights = row.value("weights").toArray();
+
+            auto output = result.outputIndex(name);
+            if (output < 0)
+                return fail(error, QString("Unknown output \"%1\"").arg(name));
+            if (mode != "normalize" && mode != "clip")
+                return fail(error, QString("Invalid saturation for output \"%1\"")
+                                       .arg(name));
+            if (weights.count() != inputs.count())
+                return fail(error, QString("Output \"%1\" needs one weight per input")
+                                       .arg(name));
+
+            auto saturation = mode == "clip" ? Mixer::Clip : Mixer::Normalize;
+            auto index = result.m_mixer.addOutput(output, saturation);
+            for (int j = 0; j < weights.count(); ++j)
+            {
+                if (!weights.at(j).isDouble())
+                    return fail(error, QString("Invalid weight for output \"%1\"")
+                                           .arg(name));
+
+                auto weight = static_cast<float>(weights.at(j).toDouble());
+                result.m_mixer.setWeight(index, j, weight);
+            }
+        }
+    }
+
+    // Compile output expressions, which can read any output of the profile
+    QStringList names;
+    for (const auto &output : result.m_outputs)
+        names.append(output.name);
+
+    auto expressions = root.value("expressions").toArray();
+    for (int i = 0; i < expressions.count(); ++i)
+    {
+        auto object = expressions.at(i).toObject();
+        auto name = object.value("output").toString();
+
+        Transform transform;
+        transform.output = result.outputIndex(name);
+        transform.registerOffset = result.m_registers;
+        transform.memoryOffset = result.m_memory;
+        if (transform.output < 0)
+            return fail(error, QString("Unknown output \"%1\"").arg(name));
+
+        QString message;
+        auto source = object.value("expr").toString();
+        if (!transform.expression.compile(source, names, &message))
+            return fail(error, QString("Invalid expression for output \"%1\": %2")
+                                   .arg(name, message));
+
+        result.m_registers += transform.expression.registerCount();
+        result.m_memory += transform.expression.memoryCount();
+        result.m_transforms.append(transform);
+    }
+
+    // Read emergency stop button, the frame is sent once by default
+    if (root.contains("estop"))
+    {
+        auto object = root.value("estop").toObject();
+        auto &estop = result.m_emergencyStop;
+        estop.button = object.value("button").toInt(-1);
+        estop.repeat = object.value("repeat").toInt(1);
+        estop.frame = object.value("frame").toString().toUtf8();
+
+        if (estop.button < 0 || estop.button > MAX_INPUT_ID)
+            return fail(error, "Invalid emergency stop button");
+        if (estop.repeat < 1 || estop.repeat > 100)
+            return fail(error, "Invalid emergency stop repeat count");
+        if (estop.frame.isEmpty())
+            return fail(error, "Emergency stop frame is empty");
+        if (!estop.frame.endsWith('\n'))
+            estop.frame.append('\n');
+    }
+
+    // Profile is valid, update output
+    profile = result;
+    return true;
+}
@@ -0,0 +1,139 @@
+/*
+ * Copyright (c) 2022 Alex Spataru <https://github.com/alex-spataru>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <QString>
+#include <QVector>
+#include <QByteArray>
+
+#include "Mixer.h"
+#include "Shaper.h"
+#include "Expression.h"
+
+/**
+ * @brief The Profile class
+ *
+ * A mapping profile describes how joystick input is turned into the values of the
+ * command frame sent to the serial device. Each frame is a comma-separated list with one
+ * field per output. Axes drive outputs directly, while buttons set or increment output
+ * values when they are pressed or released.
+ *
+ * A profile may designate an emergency stop button, which writes a stop frame to the
+ * serial device as soon as it is pressed instead of waiting for the next command frame
+ * (see @c Bridge::emergencyStop()).
+ *
+ * Before each command frame, outputs may also be computed by mixing several axes
+ * (see @c Mixer) and then with an expression (see @c Expression), which replaces the
+ * value set by the bindings.
+ * Finally, the value sent for each output can be limited in speed, acceleration &
+ * jerk (see @c Shaper).
+ *
+ * Profiles are stored as JSON documents (see @c res/profiles/default.json). Bindings are
+ * compiled into per-axis and per-button lookup tables when the profile is loaded, so
+ * that applying an input event is a simple array access.
+ */
+class Profile
+{
+public:
+    enum ActionType
+    {
+        SetValue,
+        AddValue
+    };
+
+    struct Output
+    {
+        QString name;
+        double scale;
+        double minimum;
+        double maximum;
+        double failsafe;
+        Shaper::Limits shaping;
+    };
+
+    struct AxisBinding
+    {
+        int output;
+        double scale;
+    };
+
+    struct Action
+    {
+        ActionType type;
+        int output;
+        double value;
+    };
+
+    struct EmergencyStop
+    {
+        int button;
+        int repeat;
+        QByteArray frame;
+    };
+
+    struct Transform
+    {
+        int output;
+        int registerOffset;
+        int memoryOffset;
+        Expression expression;
+    };
+
+    Profile();
+
+    QString name() const;
+    QString path() const;
+    int outputCount() const;
+    int outputIndex(const QString &name) const;
+    const Output &output(const int index) const;
+    double clamp(const int output, const double value) const;
+    bool hasShaping() const;
+
+    const QVector<AxisBinding> &axisBindings(const int axis) const;
+    const QVector<Action> &pressActions(const int button) const;
+    const QVector<Action> &releaseActions(const int button) const;
+    const EmergencyStop &emergencyStop() const;
+
+    const Mixer &mixer() const;
+    int registerCount() const;
+    int memoryCount() const;
+    const QVector<Transform> &transforms() const;
+
+    static Profile defaultProfile();
+    static bool load(const QString &path, Profile &profile, QString *error = nullptr);
+    static bool parse(const QByteArray &json, Profile &profile, QString *error = nullptr);
+
+private:
+    QString m_name;
+    QString m_path;
+    QVector<Output> m_outputs;
+    QVector<QVector<AxisBinding>> m_axes;
+    QVector<QVector<Action>> m_press;
+    QVector<QVector<Action>> m_release;
+    EmergencyStop m_emergencyStop;
+
+    Mixer m_mixer;
+    int m_registers;
+    int m_memory;
+    QVector<Transform> m_transforms;
+};
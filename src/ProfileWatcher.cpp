@@ -0,0 +1,235 @@
+/*
+ * Copyright (c) 2022 Alex Spataru <https://github.com/alex-spataru>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+#include "ProfileWatcher.h"
+#include "Bridge.h"
+#include "Profile.h"
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QElapsedTimer>
+#include <QCryptographicHash>
+
+#include <cstring>
+
+/**
+ * Time without changes after which an edited file is reloaded, in milliseconds
+ */
+static const int SETTLE_TIME = 50;
+
+/**
+ * Returns the hash of the contents of the file at the given @a path, or an empty array
+ * if the file cannot be read
+ */
+static QByteArray contentHash(const QString &path)
+{
+    QFile file(path);
+    if (!file.open(QFile::ReadOnly))
+        return QByteArray();
+
+    return QCryptographicHash::hash(file.readAll(), QCryptographicHash::Sha1);
+}
+
+/**
+ * Constructor function, starts watching the files of the profiles used by the bridge
+ */
+ProfileWatcher::ProfileWatcher()
+{
+    memset(&m_stats, 0, sizeof(m_stats));
+
+    m_settleTimer.setSingleShot(true);
+    m_settleTimer.setInterval(SETTLE_TIME);
+
+    // clang-format off
+    connect(&m_settleTimer, &QTimer::timeout,
+            this, &ProfileWatcher::reload);
+    connect(&m_watcher, &QFileSystemWatcher::fileChanged,
+            this, &ProfileWatcher::onFileChanged);
+    connect(&m_watcher, &QFileSystemWatcher::directoryChanged,
+            this, &ProfileWatcher::onDirectoryChanged);
+    connect(&Bridge::instance(), &Bridge::profileChanged,
+            this, &ProfileWatcher::updateFiles);
+    connect(&Bridge::instance(), &Bridge::channelsChanged,
+            this, &ProfileWatcher::updateFiles);
+    // clang-format on
+
+    updateFiles();
+}
+
+/**
+ * Returns the only instance of the class
+ */
+ProfileWatcher &ProfileWatcher::instance()
+{
+    static ProfileWatcher singleton;
+    return singleton;
+}
+
+/**
+ * Returns the number of profiles that were applied again or rejected, and the time (in
+ * microseconds) needed to load & apply the last profile.
+ */
+ProfileWatcher::Stats ProfileWatcher::stats() const
+{
+    return m_stats;
+}
+
+/**
+ * Returns the profile files that are being watched
+ */
+QStringList ProfileWatcher::files() const
+{
+    return m_files;
+}
+
+/**
+ * Loads the files that changed & applies them to the current profile & to the
+ * channels that use them. Files whose contents did not change (e.g. when another file
+ * of the same directory was written) are skipped. The contents are compared instead of
+ * the modification time, which stays the same if the file is saved twice within its
+ * resolution (1 s on some file systems) or by a tool that preserves it.
+ */
+void ProfileWatcher::reload()
+{
+    const auto pending = m_pending;
+    m_pending.clear();
+
+    for (const auto &path : pending)
+    {
+        const auto hash = contentHash(path);
+        if (hash.isEmpty() || hash == m_hashes.value(path))
+            continue;
+
+        QElapsedTimer clock;
+        clock.start();
+
+        QString error;
+        Profile profile;
+        m_hashes.insert(path, hash);
+        if (!Profile::load(path, profile, &error))
+        {
+            ++m_stats.failures;
+            Q_EMIT reloadFailed(path, error);
+            continue;
+        }
+
+        // Multi-device channels
+        auto &bridge = Bridge::instance();
+        auto channels = bridge.channels();
+        bool channelsChanged = false;
+        for (auto &channel : channels)
+        {
+            if (channel.profile.path() == path)
+            {
+                channel.profile = profile;
+                channelsChanged = true;
+            }
+        }
+
+        // The current profile must be updated first, since it is also used by the
+        // channels when leaving the multi-device mode
+        if (bridge.profile().path() == path)
+            bridge.setProfile(profile);
+        if (channelsChanged)
+            bridge.setChannels(channels);
+
+        ++m_stats.reloads;
+        m_stats.lastReload = clock.nsecsElapsed() / 1000;
+        Q_EMIT profileReloaded(path);
+    }
+}
+
+/**
+ * Watches the files of the current profile & of the multi-device channels, along with
+ * their directories. Built-in profiles (resources) cannot change & are not watched.
+ */
+void ProfileWatcher::updateFiles()
+{
+    QStringList files;
+    const auto &bridge = Bridge::instance();
+    if (!bridge.profile().path().isEmpty())
+        files.append(bridge.profile().path());
+
+    for (const auto &channel : bridge.channels())
+    {
+        if (!channel.profile.path().isEmpty())
+            files.append(channel.profile.path());
+    }
+
+    QStringList directories;
+    for (int i = files.count() - 1; i >= 0; --i)
+    {
+        const QFileInfo info(files.at(i));
+        if (files.at(i).startsWith(':') || files.indexOf(files.at(i)) != i)
+        {
+            files.removeAt(i);
+            continue;
+        }
+
+        if (!directories.contains(info.absolutePath()))
+            directories.append(info.absolutePath());
+        if (!m_hashes.contains(files.at(i)))
+            m_hashes.insert(files.at(i), contentHash(files.at(i)));
+    }
+
+    if (files == m_files)
+        return;
+
+    if (!m_watcher.files().isEmpty())
+        m_watcher.removePaths(m_watcher.files());
+    if (!m_watcher.directories().isEmpty())
+        m_watcher.removePaths(m_watcher.directories());
+    if (!files.isEmpty())
+        m_watcher.addPaths(files + directories);
+
+    m_files = files;
+}
+
+/**
+ * Schedules the reload of the given file. A file that was replaced (saved through a
+ * temporary file & renamed) is no longer watched, so it is watched again.
+ */
+void ProfileWatcher::onFileChanged(const QString &path)
+{
+    if (!m_watcher.files().contains(path) && QFileInfo::exists(path))
+        m_watcher.addPath(path);
+
+    if (!m_pending.contains(path))
+        m_pending.append(path);
+
+    m_settleTimer.start();
+}
+
+/**
+ * Schedules the reload of the profiles stored in the given directory, in case one of
+ * them was removed & created again.
+ */
+void ProfileWatcher::onDirectoryChanged(const QString &path)
+{
+    for (const auto &file : m_files)
+    {
+        if (QFileInfo(file).absolutePath() == QDir(path).absolutePath())
+            onFileChanged(file);
+    }
+}
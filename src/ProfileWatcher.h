@@ -0,0 +1,91 @@
+/*
+ * Copyright (c) 2022 Alex Spataru <https://github.com/alex-spataru>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <QHash>
+#include <QTimer>
+#include <QObject>
+#include <QStringList>
+#include <QFileSystemWatcher>
+
+/**
+ * @brief The ProfileWatcher class
+ *
+ * Watches the files of the profiles used by the @c Bridge (the current profile & the
+ * profiles of the multi-device channels) and applies them again when they are edited,
+ * so that the mapping can be tuned on a running machine.
+ *
+ * Editors often save a file in several steps, or replace it with a new file, so the
+ * containing directories are watched as well & a file is only reloaded once it has
+ * not changed for @c SETTLE_TIME milliseconds. A file that is not a valid profile is
+ * reported & ignored, the current profile is kept until the file is fixed.
+ *
+ * Profiles are parsed & compiled in the main thread, the frames sent by the scheduler
+ * thread only wait for the bridge to swap its output channels (see
+ * @c Bridge::setProfile()).
+ */
+class ProfileWatcher : public QObject
+{
+    Q_OBJECT
+
+public:
+    struct Stats
+    {
+        quint64 reloads;
+        quint64 failures;
+        qint64 lastReload;
+    };
+
+Q_SIGNALS:
+    void profileReloaded(const QString &path);
+    void reloadFailed(const QString &path, const QString &error);
+
+private:
+    explicit ProfileWatcher();
+    ProfileWatcher(ProfileWatcher &&) = delete;
+    ProfileWatcher(const ProfileWatcher &) = delete;
+    ProfileWatcher &operator=(ProfileWatcher &&) = delete;
+    ProfileWatcher &operator=(const ProfileWatcher &) = delete;
+
+public:
+    static ProfileWatcher &instance();
+
+    Stats stats() const;
+    QStringList files() const;
+
+private Q_SLOTS:
+    void reload();
+    void updateFiles();
+    void onFileChanged(const QString &path);
+    void onDirectoryChanged(const QString &path);
+
+private:
+    QTimer m_settleTimer;
+    QStringList m_files;
+    QStringList m_pending;
+    QFileSystemWatcher m_watcher;
+    QHash<QString, QByteArray> m_hashes;
+
+    Stats m_stats;
+};
@@ -0,0 +1,182 @@
+/*
+ * Copyright (c) 2022 Alex Spataru <https://github.com/alex-spataru>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "Realtime.h"
+
+#include <QDebug>
+#include <QMutex>
+
+#ifdef Q_OS_LINUX
+#    include <errno.h>
+#    include <sched.h>
+#    include <string.h>
+#    include <pthread.h>
+#    include <sys/mman.h>
+#endif
+
+/**
+ * Stores the given @a message in @a error (if set) and returns @c false
+ */
+static bool fail(QString *error, const QString &message)
+{
+    if (error)
+        *error = message;
+
+    return false;
+}
+
+/**
+ * Default settings: real-time scheduling disabled, priority 50 & no CPU affinity
+ */
+Realtime::Settings::Settings()
+    : enabled(false)
+    , priority(50)
+    , cpu(-1)
+{
+}
+
+/**
+ * Returns @c true if real-time scheduling is implemented for the current platform
+ */
+bool Realtime::supported()
+{
+#ifdef Q_OS_LINUX
+    return true;
+#else
+    return false;
+#endif
+}
+
+/**
+ * Locks all current & future pages of the process in RAM, so that the time-critical
+ * threads never wait for the kernel to page memory back in.
+ */
+bool Realtime::lockMemory(QString *error)
+{
+#ifdef Q_OS_LINUX
+    if (mlockall(MCL_CURRENT | MCL_FUTURE) != 0)
+        return fail(error, QString("mlockall: %1").arg(strerror(errno)));
+
+    return true;
+#else
+    return fail(error, "Memory locking is not supported on this platform");
+#endif
+}
+
+/**
+ * Switches the calling thread to the @c SCHED_FIFO policy with the given @a priority
+ * (1 to 99 on Linux).
+ */
+bool Realtime::setPriority(const int priority, QString *error)
+{
+#ifdef Q_OS_LINUX
+    const int min = sched_get_priority_min(SCHED_FIFO);
+    const int max = sched_get_priority_max(SCHED_FIFO);
+    if (priority < min || priority > max)
+    {
+        auto message = QString("Priority must be between %1 and %2").arg(min).arg(max);
+        return fail(error, message);
+    }
+
+    sched_param param;
+    memset(&param, 0, sizeof(param));
+    param.sched_priority = priority;
+
+    const int ret = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+    if (ret != 0)
+        return fail(error, QString("SCHED_FIFO: %1").arg(strerror(ret)));
+
+    return true;
+#else
+    Q_UNUSED(priority);
+    return fail(error, "Real-time scheduling is not supported on this platform");
+#endif
+}
+
+/**
+ * Restricts the calling thread to run only on the given @a cpu core
+ */
+bool Realtime::setAffinity(const int cpu, QString *error)
+{
+#ifdef Q_OS_LINUX
+    if (cpu < 0 || cpu >= CPU_SETSIZE)
+        return fail(error, QString("Invalid CPU core %1").arg(cpu));
+
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+
+    const int ret = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+    if (ret != 0)
+        return fail(error, QString("CPU %1: %2").arg(cpu).arg(strerror(ret)));
+
+    return true;
+#else
+    Q_UNUSED(cpu);
+    return fail(error, "CPU affinity is not supported on this platform");
+#endif
+}
+
+/**
+ * Applies the given real-time @a settings to the calling thread. The memory of the
+ * process is locked the first time that this function is called.
+ *
+ * Failures are not fatal: a warning that mentions the thread @a name is logged and the
+ * thread keeps running with the default scheduling policy.
+ */
+void Realtime::configureThread(const Settings &settings, const char *name)
+{
+    if (!settings.enabled)
+        return;
+
+    QString error;
+
+    // Lock process memory only once
+    static QMutex mutex;
+    static bool memoryLocked = false;
+    {
+        QMutexLocker locker(&mutex);
+        if (!memoryLocked)
+        {
+            memoryLocked = true;
+            if (!lockMemory(&error))
+                qWarning() << "Cannot lock process memory, continuing without it -"
+                           << error;
+        }
+    }
+
+    // Pin the thread to the given CPU core
+    if (settings.cpu >= 0)
+    {
+        if (!setAffinity(settings.cpu, &error))
+            qWarning() << "Cannot pin" << name << "thread, continuing without it -"
+                       << error;
+    }
+
+    // Change scheduling policy
+    if (setPriority(settings.priority, &error))
+        qInfo() << "Running" << name << "thread with SCHED_FIFO priority"
+                << settings.priority;
+    else
+        qWarning() << "Cannot use real-time scheduling for" << name
+                   << "thread, falling back to the default scheduler -" << error;
+}
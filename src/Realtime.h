@@ -0,0 +1,58 @@
+/*
+ * Copyright (c) 2022 Alex Spataru <https://github.com/alex-spataru>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <QString>
+
+/**
+ * @brief The Realtime class
+ *
+ * Helper functions to run time-critical threads (input sampling & command frame
+ * transmission) with a real-time scheduling policy, pinned to a single CPU core and
+ * without page faults caused by swapped-out memory.
+ *
+ * These features require elevated privileges (e.g. root or @c CAP_SYS_NICE and
+ * @c CAP_IPC_LOCK on Linux). If they are not available, a warning is logged and the
+ * thread keeps running with the default scheduler.
+ */
+class Realtime
+{
+public:
+    struct Settings
+    {
+        Settings();
+
+        bool enabled;
+        int priority;
+        int cpu;
+    };
+
+    static bool supported();
+    static bool lockMemory(QString *error = nullptr);
+    static bool setPriority(const int priority, QString *error = nullptr);
+    static bool setAffinity(const int cpu, QString *error = nullptr);
+    static void configureThread(const Settings &settings, const char *name);
+
+private:
+    Realtime() = delete;
+};
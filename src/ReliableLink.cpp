@@ -0,0 +1,384 @@
+/*
+ * Copyright (c) 2022 Alex Spataru <https://github.com/alex-spataru>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "ReliableLink.h"
+#include "Serial.h"
+
+#include <cstdio>
+#include <cstring>
+
+/**
+ * Limits & initial value of the retransmission timeout, in microseconds
+ */
+static const qint64 MIN_TIMEOUT = 10 * 1000;
+static const qint64 MAX_TIMEOUT = 2000 * 1000;
+static const qint64 INITIAL_TIMEOUT = 100 * 1000;
+
+/**
+ * States of the detection of replies in the received bytes
+ */
+enum ReplyState
+{
+    SkipLine,
+    LineStart,
+    ReplyType,
+    ReplySequence
+};
+
+/**
+ * Hexadecimal digits used to write the checksum of the commands
+ */
+static const char HEX_DIGITS[] = "0123456789ABCDEF";
+
+//----------------------------------------------------------------------------------------
+// Constructor & singleton access functions
+//----------------------------------------------------------------------------------------
+
+/**
+ * Constructor function, commands are written to the serial port by default
+ */
+ReliableLink::ReliableLink()
+    : m_enabled(false)
+    , m_sequence(0)
+    , m_driver(nullptr)
+    , m_replyState(LineStart)
+    , m_replyAck(false)
+    , m_replySequence(-1)
+{
+    for (auto &pending : m_pending)
+    {
+        pending.active = false;
+        pending.frame.reserve(64);
+    }
+
+    m_timer.setTimerType(Qt::PreciseTimer);
+    m_timer.setInterval(2);
+    connect(&m_timer, &QTimer::timeout, this, &ReliableLink::retransmit);
+
+    m_clock.start();
+    reset();
+    setDriver(&Serial::instance());
+}
+
+/**
+ * Returns the only instance of the class
+ */
+ReliableLink &ReliableLink::instance()
+{
+    static ReliableLink singleton;
+    return singleton;
+}
+
+//----------------------------------------------------------------------------------------
+// Member access functions
+//----------------------------------------------------------------------------------------
+
+/**
+ * Returns @c true if critical commands are sent with acknowledgement
+ */
+bool ReliableLink::enabled() const
+{
+    return m_enabled;
+}
+
+/**
+ * Returns the delivery counters & the round-trip time measurements (in microseconds)
+ */
+ReliableLink::Stats ReliableLink::stats() const
+{
+    return m_stats;
+}
+
+/**
+ * Returns the driver used to send the commands & receive the replies
+ */
+HAL_Driver *ReliableLink::driver() const
+{
+    return m_driver;
+}
+
+//----------------------------------------------------------------------------------------
+// Command delivery
+//----------------------------------------------------------------------------------------
+
+/**
+ * Sends a critical @a command (without line ending) & retransmits it until it is
+ * acknowledged by the firmware.
+ *
+ * Returns the sequence number of the command, or -1 if the reliable mode is disabled
+ * or too many commands are waiting for an acknowledgement.
+ */
+int ReliableLink::send(const QByteArray &command)
+{
+    if (!m_enabled || !m_driver)
+        return -1;
+
+    Pending *slot = nullptr;
+    for (auto &pending : m_pending)
+    {
+        if (!pending.active)
+        {
+            slot = &pending;
+            break;
+        }
+    }
+
+    if (!slot)
+        return -1;
+
+    m_sequence = m_sequence % 65535 + 1;
+
+    // Build the frame in the buffer of the slot, which keeps its capacity
+    auto &frame = slot->frame;
+    frame.resize(0);
+    char digits[8];
+    const auto length = snprintf(digits, sizeof(digits), "%d", m_sequence);
+    frame.append('@');
+    frame.append(digits, length);
+    frame.append(':');
+    frame.append(command);
+
+    quint8 checksum = 0;
+    for (int i = 1; i < frame.size(); ++i)
+        checksum ^= static_cast<quint8>(frame.at(i));
+
+    frame.append('*');
+    frame.append(HEX_DIGITS[checksum >> 4]);
+    frame.append(HEX_DIGITS[checksum & 0x0F]);
+    frame.append('\n');
+
+    slot->active = true;
+    slot->attempts = 0;
+    slot->sequence = m_sequence;
+    ++m_stats.sent;
+    ++m_stats.pending;
+    transmit(*slot);
+
+    return m_sequence;
+}
+
+/**
+ * Changes the driver used to send the commands & receive the replies, pending
+ * commands are discarded.
+ */
+void ReliableLink::setDriver(HAL_Driver *driver)
+{
+    if (m_driver == driver)
+        return;
+
+    if (m_driver)
+        disconnect(m_driver, &HAL_Driver::dataReceived, this,
+                   &ReliableLink::onDataReceived);
+
+    m_driver = driver;
+    if (m_driver)
+        connect(m_driver, &HAL_Driver::dataReceived, this,
+                &ReliableLink::onDataReceived);
+
+    reset();
+}
+
+/**
+ * Discards the pending commands & resets the counters and the round-trip time
+ * measurements.
+ */
+void ReliableLink::reset()
+{
+    m_timer.stop();
+    for (auto &pending : m_pending)
+        pending.active = false;
+
+    memset(&m_stats, 0, sizeof(m_stats));
+    m_stats.timeout = INITIAL_TIMEOUT;
+    m_rttVariation = 0;
+    m_replyState = LineStart;
+}
+
+/**
+ * Enables or disables the acknowledged delivery of critical commands
+ */
+void ReliableLink::setEnabled(const bool enabled)
+{
+    if (m_enabled != enabled)
+    {
+        m_enabled = enabled;
+        reset();
+        Q_EMIT enabledChanged();
+    }
+}
+
+/**
+ * Sends the commands whose acknowledgement timed out again, or gives up on them after
+ * @c MAX_ATTEMPTS transmissions.
+ */
+void ReliableLink::retransmit()
+{
+    const auto time = now();
+    for (auto &pending : m_pending)
+    {
+        if (!pending.active || pending.deadline > time)
+            continue;
+
+        if (pending.attempts >= MAX_ATTEMPTS)
+        {
+            pending.active = false;
+            --m_stats.pending;
+            ++m_stats.failures;
+            Q_EMIT commandFailed(pending.sequence);
+        }
+
+        else
+        {
+            ++m_stats.retransmissions;
+            transmit(pending);
+        }
+    }
+
+    if (m_stats.pending == 0)
+        m_timer.stop();
+}
+
+/**
+ * Looks for "#A<seq>" & "#N<seq>" lines in the data received from the device. The
+ * state of the search is kept between calls, so replies may be split across chunks.
+ */
+void ReliableLink::onDataReceived(const QByteArray &data)
+{
+    if (!m_enabled)
+        return;
+
+    const auto end = data.constData() + data.size();
+    for (auto c = data.constData(); c < end; ++c)
+    {
+        if (*c == '\n' || *c == '\r')
+        {
+            if (m_replyState == ReplySequence && m_replySequence >= 0)
+                onReply(m_replyAck, m_replySequence);
+
+            m_replyState = LineStart;
+            continue;
+        }
+
+        switch (m_replyState)
+        {
+            case LineStart:
+                m_replyState = (*c == '#') ? ReplyType : SkipLine;
+                break;
+            case ReplyType:
+                m_replyAck = (*c == 'A');
+                m_replySequence = -1;
+                m_replyState = (*c == 'A' || *c == 'N') ? ReplySequence : SkipLine;
+                break;
+            case ReplySequence:
+                if (*c >= '0' && *c <= '9' && m_replySequence < 65535)
+                    m_replySequence = qMax(0, m_replySequence) * 10 + (*c - '0');
+                else
+                    m_replyState = SkipLine;
+                break;
+            default:
+                break;
+        }
+    }
+}
+
+/**
+ * Returns the time elapsed since the link was created, in microseconds
+ */
+qint64 ReliableLink::now() const
+{
+    return m_clock.nsecsElapsed() / 1000;
+}
+
+/**
+ * Writes the frame of the given @a pending command & schedules its retransmission,
+ * with the timeout doubled for each previous attempt.
+ */
+void ReliableLink::transmit(Pending &pending)
+{
+    const auto timeout = qMin(MAX_TIMEOUT, m_stats.timeout << pending.attempts);
+
+    ++pending.attempts;
+    pending.sentAt = now();
+    pending.deadline = pending.sentAt + timeout;
+    m_driver->write(pending.frame);
+
+    if (!m_timer.isActive())
+        m_timer.start();
+}
+
+/**
+ * Completes the command with the given @a sequence number if it was @a acknowledged,
+ * or sends it again right away if the firmware rejected it.
+ */
+void ReliableLink::onReply(const bool acknowledged, const int sequence)
+{
+    for (auto &pending : m_pending)
+    {
+        if (!pending.active || pending.sequence != sequence)
+            continue;
+
+        if (!acknowledged)
+        {
+            ++m_stats.rejected;
+            pending.deadline = now();
+            retransmit();
+            return;
+        }
+
+        const auto rtt = now() - pending.sentAt;
+        if (pending.attempts == 1)
+            updateTimeout(rtt);
+
+        pending.active = false;
+        --m_stats.pending;
+        ++m_stats.acknowledged;
+        Q_EMIT commandAcknowledged(sequence, rtt);
+        return;
+    }
+}
+
+/**
+ * Updates the round-trip time statistics with a new @a rtt sample & recalculates the
+ * retransmission timeout (RFC 6298).
+ */
+void ReliableLink::updateTimeout(const qint64 rtt)
+{
+    if (m_stats.smoothedRtt == 0)
+    {
+        m_stats.smoothedRtt = rtt;
+        m_rttVariation = rtt / 2;
+        m_stats.minimumRtt = rtt;
+        m_stats.maximumRtt = rtt;
+    }
+
+    else
+    {
+        m_rttVariation = (3 * m_rttVariation + qAbs(m_stats.smoothedRtt - rtt)) / 4;
+        m_stats.smoothedRtt = (7 * m_stats.smoothedRtt + rtt) / 8;
+        m_stats.minimumRtt = qMin(m_stats.minimumRtt, rtt);
+        m_stats.maximumRtt = qMax(m_stats.maximumRtt, rtt);
+    }
+
+    m_stats.rtt = rtt;
+    m_stats.timeout = qBound(MIN_TIMEOUT, m_stats.smoothedRtt + 4 * m_rttVariation,
+                             MAX_TIMEOUT);
+}
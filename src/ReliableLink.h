@@ -0,0 +1,141 @@
+/*
+ * Copyright (c) 2022 Alex Spataru <https://github.com/alex-spataru>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <QTimer>
+#include <QObject>
+#include <QByteArray>
+#include <QElapsedTimer>
+
+#include "HAL_Driver.h"
+
+/**
+ * @brief The ReliableLink class
+ *
+ * Optional acknowledged delivery for critical commands (e.g. stop), on top of the
+ * regular command frames, which are idempotent & keep being sent without any
+ * acknowledgement so that throughput is not affected.
+ *
+ * Each critical command is sent as a line with a sequence number & a checksum:
+ *
+ *     @<seq>:<command>*<XX>\n
+ *
+ * where @c XX is the XOR of every byte between '@' and '*' in two hexadecimal digits.
+ * The firmware replies with "#A<seq>" once the command has been executed (or when it
+ * receives a duplicate), or with "#N<seq>" if the checksum is not valid, on a line of
+ * its own. Replies are detected directly in the received bytes, next to the telemetry.
+ *
+ * Commands that are not acknowledged within the retransmission timeout are sent again
+ * (only those commands, not every pending one), up to @c MAX_ATTEMPTS times. The
+ * timeout follows the measured round-trip time, as in TCP (RFC 6298): the smoothed RTT
+ * plus four times its variation, doubled after each retransmission. RTT samples of
+ * retransmitted commands are discarded, since the reply cannot be matched to a
+ * specific transmission.
+ *
+ * This class lives in the main thread.
+ */
+class ReliableLink : public QObject
+{
+    Q_OBJECT
+
+public:
+    static const int MAX_PENDING = 16;
+    static const int MAX_ATTEMPTS = 5;
+
+    struct Stats
+    {
+        quint64 sent;
+        quint64 acknowledged;
+        quint64 retransmissions;
+        quint64 rejected;
+        quint64 failures;
+        int pending;
+        qint64 rtt;
+        qint64 smoothedRtt;
+        qint64 minimumRtt;
+        qint64 maximumRtt;
+        qint64 timeout;
+    };
+
+Q_SIGNALS:
+    void enabledChanged();
+    void commandFailed(const int sequence);
+    void commandAcknowledged(const int sequence, const qint64 rtt);
+
+private:
+    explicit ReliableLink();
+    ReliableLink(ReliableLink &&) = delete;
+    ReliableLink(const ReliableLink &) = delete;
+    ReliableLink &operator=(ReliableLink &&) = delete;
+    ReliableLink &operator=(const ReliableLink &) = delete;
+
+public:
+    static ReliableLink &instance();
+
+    bool enabled() const;
+    Stats stats() const;
+    HAL_Driver *driver() const;
+
+    int send(const QByteArray &command);
+    void setDriver(HAL_Driver *driver);
+
+public Q_SLOTS:
+    void reset();
+    void setEnabled(const bool enabled);
+
+private Q_SLOTS:
+    void retransmit();
+    void onDataReceived(const QByteArray &data);
+
+private:
+    struct Pending
+    {
+        bool active;
+        int sequence;
+        int attempts;
+        qint64 sentAt;
+        qint64 deadline;
+        QByteArray frame;
+    };
+
+    qint64 now() const;
+    void transmit(Pending &pending);
+    void onReply(const bool acknowledged, const int sequence);
+    void updateTimeout(const qint64 rtt);
+
+private:
+    bool m_enabled;
+    int m_sequence;
+    HAL_Driver *m_driver;
+
+    int m_replyState;
+    bool m_replyAck;
+    int m_replySequence;
+
+    Stats m_stats;
+    qint64 m_rttVariation;
+
+    QTimer m_timer;
+    QElapsedTimer m_clock;
+    Pending m_pending[MAX_PENDING];
+};
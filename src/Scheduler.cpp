@@ -0,0 +1,235 @@
+/*
+ * Copyright (c) 2022 Alex Spataru <https://github.com/alex-spataru>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "Scheduler.h"
+
+#include <QElapsedTimer>
+
+#ifdef Q_OS_LINUX
+#    include <time.h>
+#    include <errno.h>
+#endif
+
+/**
+ * Returns the current time of the monotonic clock in nanoseconds
+ */
+static qint64 monotonicTime()
+{
+#ifdef Q_OS_LINUX
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<qint64>(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+#else
+    static QElapsedTimer clock;
+    static bool started = false;
+    if (!started)
+    {
+        clock.start();
+        started = true;
+    }
+
+    return clock.nsecsElapsed();
+#endif
+}
+
+/**
+ * Blocks the calling thread until the monotonic clock reaches the given @a deadline
+ * (in nanoseconds).
+ */
+static void sleepUntil(const qint64 deadline)
+{
+#ifdef Q_OS_LINUX
+    timespec ts;
+    ts.tv_sec = deadline / 1000000000;
+    ts.tv_nsec = deadline % 1000000000;
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr) == EINTR)
+        continue;
+#else
+    const auto remaining = (deadline - monotonicTime()) / 1000;
+    if (remaining > 0)
+        QThread::usleep(static_cast<unsigned long>(remaining));
+#endif
+}
+
+/**
+ * Constructor function, the given @a task is executed every 250 milliseconds once the
+ * thread is started.
+ */
+Scheduler::Scheduler(const std::function<void()> &task, QObject *parent)
+    : QThread(parent)
+    , m_task(task)
+    , m_interval(250000)
+    , m_maxInterval(0)
+{
+    m_stats.reset(m_interval.load());
+}
+
+/**
+ * Destructor function, waits for the thread to finish
+ */
+Scheduler::~Scheduler()
+{
+    stop();
+}
+
+/**
+ * Returns the number of times that the task is executed per second (rounded)
+ */
+int Scheduler::rate() const
+{
+    return qRound(1e6 / m_interval.load());
+}
+
+/**
+ * Returns the time (in microseconds) between each execution of the task
+ */
+int Scheduler::interval() const
+{
+    return m_interval.load();
+}
+
+/**
+ * Returns the real-time settings applied to the thread when it starts
+ */
+Realtime::Settings Scheduler::realtime() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_realtime;
+}
+
+/**
+ * Returns the measured intervals between each execution of the task
+ */
+const TimingStats &Scheduler::stats() const
+{
+    return m_stats;
+}
+
+/**
+ * Stops the thread after the current period ends
+ */
+void Scheduler::stop()
+{
+    requestInterruption();
+    wait();
+}
+
+/**
+ * Clears the interval statistics
+ */
+void Scheduler::resetStats()
+{
+    m_stats.reset(m_interval.load());
+}
+
+/**
+ * Changes the number of times that the task is executed per second, up to
+ * @c MAX_RATE times.
+ */
+void Scheduler::setRate(const int hz)
+{
+    Q_ASSERT(hz > 0 && hz <= MAX_RATE);
+    setInterval(1000000 / hz);
+}
+
+/**
+ * Changes the time (in microseconds) between each execution of the task, the new
+ * interval is used after the current period ends.
+ */
+void Scheduler::setInterval(const int usec)
+{
+    Q_ASSERT(usec >= 1000000 / MAX_RATE);
+
+    if (m_interval.fetchAndStoreOrdered(usec) != usec)
+    {
+        resetStats();
+        Q_EMIT intervalChanged();
+    }
+}
+
+/**
+ * Makes the task run at least @a hz times per second, even if the interval is longer,
+ * until it is called again with 0 (e.g. while sending failsafe frames). Unlike
+ * @c setInterval(), this does not change the interval nor clear the statistics.
+ */
+void Scheduler::setMinimumRate(const int hz)
+{
+    m_maxInterval.store(hz > 0 ? 1000000 / qMin(hz, int(MAX_RATE)) : 0);
+}
+
+/**
+ * Changes the real-time @a settings of the thread, the thread is restarted if it is
+ * already running.
+ */
+void Scheduler::setRealtime(const Realtime::Settings &settings)
+{
+    {
+        QMutexLocker locker(&m_mutex);
+        m_realtime = settings;
+    }
+
+    if (isRunning())
+    {
+        stop();
+        resetStats();
+        start();
+    }
+}
+
+/**
+ * Thread loop, executes the task at fixed deadlines & records the time elapsed since
+ * the previous execution until @c stop() is called.
+ */
+void Scheduler::run()
+{
+    Realtime::configureThread(realtime(), "TX");
+
+    qint64 last = -1;
+    qint64 deadline = monotonicTime();
+    while (!isInterruptionRequested())
+    {
+        // Measure the actual interval
+        const auto now = monotonicTime();
+        if (last >= 0)
+            m_stats.addSample((now - last) / 1000);
+
+        // Run the task
+        last = now;
+        m_task();
+
+        // Calculate next deadline, skip the ones that we missed
+        auto interval = m_interval.load();
+        const auto maxInterval = m_maxInterval.load();
+        if (maxInterval > 0)
+            interval = qMin(interval, maxInterval);
+
+        const qint64 period = interval * Q_INT64_C(1000);
+        deadline += period;
+        if (monotonicTime() - deadline > period)
+        {
+            m_stats.addOverrun();
+            deadline = monotonicTime();
+        }
+
+        sleepUntil(deadline);
+    }
+}
@@ -0,0 +1,87 @@
+/*
+ * Copyright (c) 2022 Alex Spataru <https://github.com/alex-spataru>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <QMutex>
+#include <QThread>
+#include <QAtomicInt>
+
+#include <functional>
+
+#include "Realtime.h"
+#include "TimingStats.h"
+
+/**
+ * @brief The Scheduler class
+ *
+ * Dedicated thread that runs a task (e.g. sending a command frame) periodically, so
+ * that the timing of the serial output does not depend on the load of the event loop.
+ * The thread can optionally be given real-time priority (see @c Realtime).
+ *
+ * Each execution is scheduled at an absolute deadline (start time + n * interval), so
+ * the time spent by the task & wake-up latencies do not accumulate into drift. If the
+ * thread falls behind by more than one period, the missed deadlines are skipped instead
+ * of sending a burst of frames.
+ *
+ * The actual interval between each execution of the task is recorded in a
+ * @c TimingStats object.
+ */
+class Scheduler : public QThread
+{
+    Q_OBJECT
+
+Q_SIGNALS:
+    void intervalChanged();
+
+public:
+    static const int MAX_RATE = 1000;
+
+    explicit Scheduler(const std::function<void()> &task, QObject *parent = nullptr);
+    ~Scheduler();
+
+    int rate() const;
+    int interval() const;
+    Realtime::Settings realtime() const;
+    const TimingStats &stats() const;
+
+public Q_SLOTS:
+    void stop();
+    void resetStats();
+    void setRate(const int hz);
+    void setInterval(const int usec);
+    void setMinimumRate(const int hz);
+    void setRealtime(const Realtime::Settings &settings);
+
+protected:
+    void run() override;
+
+private:
+    std::function<void()> m_task;
+
+    QAtomicInt m_interval;
+    QAtomicInt m_maxInterval;
+    TimingStats m_stats;
+
+    mutable QMutex m_mutex;
+    Realtime::Settings m_realtime;
+};
@@ -21,20 +21,115 @@
  */
 
 #include "Serial.h"
+#include "AllocTracker.h"
+
+#include <QThread>
+#include <QMetaMethod>
+#include <QFileInfo>
+
+#include <algorithm>
+#include <functional>
+
+#ifdef Q_OS_UNIX
+#    include <cerrno>
+#    include <poll.h>
+#    include <sys/ioctl.h>
+#    include <termios.h>
+#    include <unistd.h>
+#endif
 
 //----------------------------------------------------------------------------------------
 // Constructor/destructor & singleton access functions
 //----------------------------------------------------------------------------------------
 
+/**
+ * Delay before the first reconnection attempt & maximum delay between attempts, in
+ * milliseconds. The delay doubles after each failed attempt.
+ */
+static const int MIN_RECONNECT_DELAY = 5;
+static const int MAX_RECONNECT_DELAY = 100;
+
+/**
+ * Time spent listening at each candidate rate during baud rate detection: a fixed
+ * time for the device to send (or answer) plus the time needed to receive
+ * @c PROBE_BYTES bytes at that rate.
+ */
+static const int PROBE_TIME = 150;
+static const int PROBE_BYTES = 192;
+
+/**
+ * Maximum time spent waiting for room in the output queue of the OS driver when
+ * writing a frame, in milliseconds
+ */
+static const int WRITE_TIMEOUT = 10;
+
+#ifdef Q_OS_UNIX
+/**
+ * Writes the @a length bytes of @a data to the non-blocking file descriptor @a fd,
+ * waiting (up to @c WRITE_TIMEOUT in total) while the output queue is full. Returns
+ * the number of bytes written.
+ */
+static qint64 writeAll(const int fd, const char *data, const qint64 length)
+{
+    QElapsedTimer clock;
+    clock.start();
+
+    qint64 written = 0;
+    while (written < length)
+    {
+        const auto size = static_cast<size_t>(length - written);
+        const auto bytes = ::write(fd, data + written, size);
+        if (bytes > 0)
+        {
+            written += bytes;
+            continue;
+        }
+
+        if (bytes < 0 && errno == EINTR)
+            continue;
+
+        if (bytes < 0 && errno != EAGAIN && errno != EWOULDBLOCK)
+            break;
+
+        const auto remaining = WRITE_TIMEOUT - clock.elapsed();
+        if (remaining <= 0)
+            break;
+
+        struct pollfd pfd;
+        pfd.fd = fd;
+        pfd.events = POLLOUT;
+        pfd.revents = 0;
+        if (poll(&pfd, 1, static_cast<int>(remaining)) < 0 && errno != EINTR)
+            break;
+    }
+
+    return written;
+}
+#endif
+
 /**
  * Constructor function
  */
 Serial::Serial()
     : m_port(Q_NULLPTR)
+    , m_handle(-1)
+    , m_torn(false)
+    , m_txFrames(0)
+    , m_txBytes(0)
+    , m_txDropped(0)
+    , m_bytesPerSecond(0)
     , m_autoReconnect(false)
-    , m_lastSerialDeviceIndex(0)
+    , m_reconnecting(false)
+    , m_reconnectDelay(MIN_RECONNECT_DELAY)
+    , m_openMode(QIODevice::ReadWrite)
+    , m_reconnectStats()
+    , m_autoBaud(false)
+    , m_autoBaudIndex(0)
     , m_portIndex(0)
 {
+    // No device has been opened yet
+    m_identity.hasIds = false;
+
     // Read settings
     readSettings();
 
@@ -45,6 +140,7 @@ Serial::Serial()
     setStopBits(stopBitsList().indexOf("1"));
     setParity(parityList().indexOf(tr("None")));
     setFlowControl(flowControlList().indexOf(tr("None")));
+    updateBytesPerSecond();
 
     // clang-format off
 
@@ -52,6 +148,21 @@ Serial::Serial()
     connect(&m_refreshTimer, &QTimer::timeout, this, &Serial::refreshSerialDevices);
     m_refreshTimer.start(1000);
 
+    // Look for the lost device again after each backoff delay
+    m_reconnectTimer.setSingleShot(true);
+    m_reconnectTimer.setTimerType(Qt::PreciseTimer);
+    connect(&m_reconnectTimer, &QTimer::timeout, this, &Serial::tryReconnect);
+
+    // Try the next rate when the device did not answer at the current one
+    m_autoBaudTimer.setSingleShot(true);
+    connect(&m_autoBaudTimer, &QTimer::timeout, this, &Serial::nextAutoBaudRate);
+
+    // Recompute the number of bytes that can be sent per second
+    connect(this, &Serial::baudRateChanged, this, &Serial::updateBytesPerSecond);
+    connect(this, &Serial::parityChanged, this, &Serial::updateBytesPerSecond);
+    connect(this, &Serial::dataBitsChanged, this, &Serial::updateBytesPerSecond);
+    connect(this, &Serial::stopBitsChanged, this, &Serial::updateBytesPerSecond);
+
     // Update connect button status when user selects a serial device
     connect(this, &Serial::portIndexChanged,
             this, &Serial::configurationChanged);
@@ -66,6 +177,7 @@ Serial::Serial()
 Serial::~Serial()
 {
     writeSettings();
+    stopCapture();
 
     if (port())
         disconnectDevice();
@@ -85,10 +197,18 @@ Serial &Serial::instance()
 //----------------------------------------------------------------------------------------
 
 /**
- * Closes the current serial port connection
+ * Closes the current serial port connection, the device is not reopened automatically
  */
 void Serial::close()
 {
+    stopReconnect();
+
+    // Stop writes from other threads before the descriptor is released
+    {
+        QMutexLocker locker(&m_handleMutex);
+        m_handle = -1;
+    }
+
     if (isOpen())
         port()->close();
 }
@@ -136,18 +256,142 @@ bool Serial::configurationOk() const
 }
 
 /**
- * Writes the given @a data to the serial device and returns the number of bytes written
+ * Writes the given @a data to the serial device and returns the number of bytes written.
+ * This function may be called from any thread.
+ *
+ * On Unix, every frame is written directly to the file descriptor of the port (see
+ * @c writeFrame()), so the frames written from the main thread & from the scheduler
+ * thread are never interleaved. On other platforms, the data is written through
+ * @c QSerialPort in the thread that owns the port.
  */
 quint64 Serial::write(const QByteArray &data)
 {
+#ifdef Q_OS_UNIX
+    return writeFrame(data);
+#else
+    if (QThread::currentThread() != thread())
+    {
+        QMetaObject::invokeMethod(this, [=]() { write(data); }, Qt::QueuedConnection);
+        return data.size();
+    }
+
+    // Do not send frames at a rate that the device may not be using
+    if (m_autoBaud)
+        return -1;
+
     if (isWritable())
     {
         auto bytes = port()->write(data);
-        Q_EMIT dataSent(data.chopped(data.length() - bytes));
+        if (bytes < data.length())
+        {
+            m_txDropped.fetchAndAddRelaxed(1);
+            return -1;
+        }
+
+        m_txFrames.fetchAndAddRelaxed(1);
+        m_txBytes.fetchAndAddRelaxed(static_cast<quint64>(bytes));
+        m_capture.append(SerialCapture::TX, data.constData(), static_cast<int>(bytes));
+        notifySent(data);
         return bytes;
     }
 
     return -1;
+#endif
+}
+
+/**
+ * Priority lane for commands that cannot wait for the next frame (e.g. an emergency
+ * stop). The @a data is written @a repeat times right away, after a line break so that
+ * it starts on a new line even if a frame is being transmitted. The data that was
+ * already queued is not discarded, since it could end in the middle of a frame, and
+ * the function does not wait for the transmission (see @c transmitDelay()). Returns
+ * the number of bytes written.
+ *
+ * A baud rate detection in progress is cancelled first, so that the data is sent at
+ * the configured rate. If the detection cannot be cancelled from the calling thread,
+ * the data is written once the thread that owns the port has cancelled it.
+ *
+ * On Unix, the data is written directly to the file descriptor of the port from the
+ * calling thread. On other platforms, this function must be called from the thread
+ * that owns the serial port.
+ */
+quint64 Serial::writeUrgent(const QByteArray &data, const int repeat)
+{
+    if (QThread::currentThread() == thread())
+        stopAutoBaud();
+
+#ifdef Q_OS_UNIX
+    QMutexLocker locker(&m_handleMutex);
+    if (m_autoBaud)
+    {
+        locker.unlock();
+        QMetaObject::invokeMethod(this, [=]() { writeUrgent(data, repeat); },
+                                  Qt::QueuedConnection);
+        return data.size() * repeat;
+    }
+
+    if (m_handle < 0)
+        return -1;
+
+    const auto fd = static_cast<int>(m_handle);
+    quint64 written = 0;
+    if (writeAll(fd, "\n", 1) == 1)
+    {
+        ++written;
+        m_torn = false;
+        m_capture.append(SerialCapture::TX, "\n", 1);
+    }
+
+    int sent = 0;
+    for (; sent < repeat; ++sent)
+    {
+        const auto bytes = writeAll(fd, data.constData(), data.size());
+        if (bytes > 0)
+        {
+            written += bytes;
+            m_capture.append(SerialCapture::TX, data.constData(), static_cast<int>(bytes));
+        }
+
+        if (bytes < data.size())
+        {
+            m_torn = bytes > 0;
+            break;
+        }
+    }
+
+    locker.unlock();
+    for (int i = 0; i < sent; ++i)
+        notifySent(data);
+
+    return written;
+#else
+    if (QThread::currentThread() != thread() || !isWritable())
+        return -1;
+
+    quint64 written = 0;
+    if (port()->write("\n", 1) == 1)
+    {
+        ++written;
+        m_capture.append(SerialCapture::TX, "\n", 1);
+    }
+
+    int sent = 0;
+    for (; sent < repeat; ++sent)
+    {
+        auto bytes = port()->write(data);
+        if (bytes < 0)
+            break;
+
+        written += bytes;
+        m_capture.append(SerialCapture::TX, data.constData(), static_cast<int>(bytes));
+    }
+
+    port()->flush();
+    for (int i = 0; i < sent; ++i)
+        notifySent(data);
+
+    return written;
+#endif
 }
 
 /**
@@ -155,6 +399,9 @@ quint64 Serial::write(const QByteArray &data)
  */
 bool Serial::open(const QIODevice::OpenMode mode)
 {
+    // Opening a port cancels the reconnection to the previous one
+    stopReconnect();
+
     // Ignore the first item of the list (Select Port)
     auto ports = validPorts();
     auto portId = portIndex() - 1;
@@ -163,7 +410,6 @@ bool Serial::open(const QIODevice::OpenMode mode)
         // Update port index variable & disconnect from current serial port
         disconnectDevice();
         m_portIndex = portId + 1;
-        m_lastSerialDeviceIndex = m_portIndex;
         Q_EMIT portIndexChanged();
 
         // Create new serial port handler
@@ -184,6 +430,15 @@ bool Serial::open(const QIODevice::OpenMode mode)
         if (port()->open(mode))
         {
             connect(port(), &QIODevice::readyRead, this, &Serial::onReadyRead);
+
+            // Remember the adapter, in case it has to be reopened
+            m_openMode = mode;
+            m_identity = identify(ports.at(portId));
+
+            QMutexLocker locker(&m_handleMutex);
+            if (mode & QIODevice::WriteOnly)
+                m_handle = port()->handle();
+
             return true;
         }
     }
@@ -197,6 +452,79 @@ bool Serial::open(const QIODevice::OpenMode mode)
 // Driver specifics
 //----------------------------------------------------------------------------------------
 
+/**
+ * Returns the number of frames & bytes written since the application started, and the
+ * number of frames that have been dropped because they could not be written completely.
+ * This function may be called from any thread.
+ */
+Serial::TxStats Serial::txStats() const
+{
+    TxStats stats;
+    stats.frames = m_txFrames.load();
+    stats.bytes = m_txBytes.load();
+    stats.dropped = m_txDropped.load();
+    return stats;
+}
+
+/**
+ * Returns the number of bytes that can be sent per second with the current baud rate,
+ * parity, data & stop bits. This function may be called from any thread.
+ */
+qint64 Serial::bytesPerSecond() const
+{
+    return m_bytesPerSecond.load();
+}
+
+/**
+ * Returns the time, in microseconds, needed to transmit the bytes that are still in
+ * the output queue of the OS driver (on Unix) or of @c QSerialPort (on other
+ * platforms, only from the thread that owns the port) at the current rate.
+ */
+qint64 Serial::transmitDelay()
+{
+    qint64 queued = 0;
+#ifdef Q_OS_UNIX
+    {
+        int bytes = 0;
+        QMutexLocker locker(&m_handleMutex);
+        if (m_handle >= 0 && ioctl(static_cast<int>(m_handle), TIOCOUTQ, &bytes) == 0)
+            queued = bytes;
+    }
+#else
+    if (QThread::currentThread() == thread() && isOpen())
+        queued = port()->bytesToWrite();
+#endif
+
+    return queued * 1000000 / qMax<qint64>(1, bytesPerSecond());
+}
+
+/**
+ * Returns @c true if the serial traffic is being recorded to a capture file
+ */
+bool Serial::isCapturing() const
+{
+    return m_capture.isCapturing();
+}
+
+/**
+ * Returns the number of packets that were not recorded because the capture file could
+ * not be written fast enough.
+ */
+quint64 Serial::droppedCapturePackets() const
+{
+    return m_capture.droppedPackets();
+}
+
+/**
+ * Starts recording every chunk of data sent to or received from the serial device to
+ * a pcap file at the given @a path (see @c SerialCapture). Returns @c false and writes
+ * the reason to @a error if the file cannot be created.
+ */
+bool Serial::startCapture(const QString &path, QString *error)
+{
+    return m_capture.open(path, error);
+}
+
 /**
  * Returns the name of the current serial port device
  */
@@ -224,6 +552,31 @@ bool Serial::autoReconnect() const
     return m_autoReconnect;
 }
 
+/**
+ * Returns @c true if the driver is waiting for the lost device to reappear
+ */
+bool Serial::isReconnecting() const
+{
+    return m_reconnecting;
+}
+
+/**
+ * Returns the number of times that the device was lost & reopened, and the time (in
+ * microseconds) from the loss of the device until it was reopened.
+ */
+Serial::ReconnectStats Serial::reconnectStats() const
+{
+    return m_reconnectStats;
+}
+
+/**
+ * Returns @c true while the baud rate of the device is being detected
+ */
+bool Serial::isDetectingBaudRate() const
+{
+    return m_autoBaud;
+}
+
 /**
  * Returns the index of the current serial device selected by the program.
  */
@@ -381,11 +734,25 @@ QSerialPort::FlowControl Serial::flowControl() const
     return m_flowControl;
 }
 
+/**
+ * Stops recording serial traffic & writes the pending packets to the capture file
+ */
+void Serial::stopCapture()
+{
+    m_capture.close();
+}
+
 /**
  * Disconnects from the current serial device and clears temp. data
  */
 void Serial::disconnectDevice()
 {
+    // Stop writes from other threads
+    {
+        QMutexLocker locker(&m_handleMutex);
+        m_handle = -1;
+    }
+
     // Check if serial port pointer is valid
     if (port() != Q_NULLPTR)
     {
@@ -402,6 +769,9 @@ void Serial::disconnectDevice()
     m_port = Q_NULLPTR;
     Q_EMIT portChanged();
     Q_EMIT availablePortsChanged();
+
+    // Baud rate detection needs an open port
+    stopAutoBaud();
 }
 
 /**
@@ -438,6 +808,26 @@ void Serial::setPortIndex(const quint8 portIndex)
     Q_EMIT portIndexChanged();
 }
 
+/**
+ * Selects the serial device with the given port @a name (e.g. "ttyUSB0") or system
+ * location (e.g. "/dev/ttyUSB0"). Returns @c false if the device is not available.
+ */
+bool Serial::setPortName(const QString &name)
+{
+    auto ports = validPorts();
+    for (int i = 0; i < ports.count(); ++i)
+    {
+        auto info = ports.at(i);
+        if (info.portName() == name || info.systemLocation() == name)
+        {
+            setPortIndex(i + 1);
+            return true;
+        }
+    }
+
+    return false;
+}
+
 /**
  * @brief Serial::setParity
  * @param parityIndex
@@ -572,6 +962,9 @@ void Serial::setStopBits(const quint8 stopBitsIndex)
 void Serial::setAutoReconnect(const bool autoreconnect)
 {
     m_autoReconnect = autoreconnect;
+    if (!autoreconnect)
+        stopReconnect();
+
     Q_EMIT autoReconnectChanged();
 }
 
@@ -651,14 +1044,9 @@ void Serial::refreshSerialDevices()
             }
         }
 
-        // Auto reconnect
-        if (autoReconnect() && m_lastSerialDeviceIndex > 0)
-        {
-            if (m_lastSerialDeviceIndex < portList().count())
-            {
-                setPortIndex(m_lastSerialDeviceIndex);
-            }
-        }
+        // The lost device may have reappeared, do not wait for the backoff delay
+        if (m_reconnecting)
+            tryReconnect();
 
         // Update UI
         Q_EMIT availablePortsChanged();
@@ -674,7 +1062,12 @@ void Serial::handleError(QSerialPort::SerialPortError error)
     if (error != QSerialPort::NoError)
     {
         qDebug() << error;
+
+        // Device was removed while open (e.g. USB glitch)
+        const auto lost = isOpen() && error == QSerialPort::ResourceError;
         disconnectDevice();
+        if (lost && autoReconnect())
+            startReconnect();
     }
 }
 
@@ -684,7 +1077,336 @@ void Serial::handleError(QSerialPort::SerialPortError error)
 void Serial::onReadyRead()
 {
     if (isOpen())
-        Q_EMIT dataReceived(port()->readAll());
+    {
+        QByteArray data;
+        {
+            ALLOC_SCOPE(AllocTracker::Receive);
+            data = port()->readAll();
+            m_capture.append(SerialCapture::RX, data.constData(), data.size());
+        }
+
+        // Lock onto the current candidate rate as soon as the device answers
+        if (m_autoBaud)
+        {
+            m_baudProbe.append(data.constData(), data.size());
+            if (m_baudProbe.accepted())
+                finishAutoBaud(m_autoBaudRates.at(m_autoBaudIndex));
+
+            return;
+        }
+
+        Q_EMIT dataReceived(data);
+    }
+}
+
+/**
+ * Starts detecting the baud rate of the device connected to the open port. Each rate
+ * of @c baudRateList() is tried from the fastest to the slowest: the port is switched
+ * to the rate, @a probe is sent (if not empty, for devices that only answer to a
+ * request) and the received bytes are scored with @c BaudProbe. The first rate at
+ * which the device sends valid telemetry is kept, so the link runs at the fastest
+ * rate supported by the device.
+ *
+ * Outgoing frames are held back & received data is not forwarded until the detection
+ * ends. @c autoBaudFinished() is emitted with the detected rate, or with 0 (and the
+ * previous rate restored) if the device did not answer at any rate.
+ */
+bool Serial::startAutoBaud(const QByteArray &probe)
+{
+    if (!isOpen() || m_autoBaud)
+        return false;
+
+    m_autoBaudRates.clear();
+    for (int i = 0; i < m_baudRateList.count(); ++i)
+    {
+        const auto rate = m_baudRateList.at(i).toInt();
+        if (rate > 10)
+            m_autoBaudRates.append(rate);
+    }
+
+    std::sort(m_autoBaudRates.begin(), m_autoBaudRates.end(), std::greater<qint32>());
+    if (m_autoBaudRates.isEmpty())
+        return false;
+
+    {
+        QMutexLocker locker(&m_handleMutex);
+        m_autoBaud = true;
+    }
+
+    m_autoBaudIndex = -1;
+    m_autoBaudProbe = probe;
+    Q_EMIT autoBaudChanged();
+
+    nextAutoBaudRate();
+    return true;
+}
+
+/**
+ * Cancels the baud rate detection & restores the previous rate
+ */
+void Serial::stopAutoBaud()
+{
+    if (m_autoBaud)
+        finishAutoBaud(0);
+}
+
+/**
+ * Switches the port to the next candidate rate, or ends the detection if every rate
+ * has been tried.
+ */
+void Serial::nextAutoBaudRate()
+{
+    if (!m_autoBaud)
+        return;
+
+    if (++m_autoBaudIndex >= m_autoBaudRates.count())
+    {
+        finishAutoBaud(0);
+        return;
+    }
+
+    // Discard the bytes received at the previous rate
+    const auto rate = m_autoBaudRates.at(m_autoBaudIndex);
+    port()->setBaudRate(rate);
+    port()->clear(QSerialPort::Input);
+    m_baudProbe.clear();
+
+    if (!m_autoBaudProbe.isEmpty())
+    {
+        const auto bytes = port()->write(m_autoBaudProbe);
+        m_capture.append(SerialCapture::TX, m_autoBaudProbe.constData(),
+                         static_cast<int>(bytes));
+    }
+
+    const auto bits = static_cast<qint64>(PROBE_BYTES) * 10 * 1000;
+    m_autoBaudTimer.start(PROBE_TIME + static_cast<int>(bits / rate));
+}
+
+/**
+ * Ends the baud rate detection, keeping the detected @a rate, or restoring the
+ * previous rate if @a rate is 0.
+ */
+void Serial::finishAutoBaud(const qint32 rate)
+{
+    m_autoBaudTimer.stop();
+    {
+        QMutexLocker locker(&m_handleMutex);
+        m_autoBaud = false;
+    }
+
+    if (rate > 0)
+        setBaudRate(rate);
+    else if (port())
+        port()->setBaudRate(baudRate());
+
+    Q_EMIT autoBaudChanged();
+    Q_EMIT autoBaudFinished(rate);
+}
+
+/**
+ * Looks for the lost device & reopens it. If the device is not available (or cannot be
+ * opened yet), a new attempt is scheduled after twice the previous delay, up to
+ * @c MAX_RECONNECT_DELAY.
+ */
+void Serial::tryReconnect()
+{
+    if (!m_reconnecting)
+        return;
+
+    const auto ports = validPorts();
+    const auto index = findPort(ports);
+    if (index >= 0)
+    {
+        // Clear the flag, so that open() does not report a cancelled reconnection
+        m_reconnecting = false;
+        m_portIndex = index + 1;
+        if (open(m_openMode))
+        {
+            const auto elapsed = m_lossClock.nsecsElapsed() / 1000;
+            ++m_reconnectStats.reconnects;
+            m_reconnectStats.lastRecovery = elapsed;
+            m_reconnectStats.maximumRecovery
+                = qMax(m_reconnectStats.maximumRecovery, elapsed);
+
+            Q_EMIT reconnectingChanged();
+            Q_EMIT reconnected(elapsed);
+            return;
+        }
+
+        // The device is listed, but cannot be opened yet
+        m_reconnecting = true;
+    }
+
+    m_reconnectTimer.start(m_reconnectDelay);
+    m_reconnectDelay = qMin(m_reconnectDelay * 2, MAX_RECONNECT_DELAY);
+}
+
+/**
+ * Starts looking for the device that was just lost
+ */
+void Serial::startReconnect()
+{
+    ++m_reconnectStats.losses;
+    m_lossClock.start();
+    m_reconnecting = true;
+    m_reconnectDelay = MIN_RECONNECT_DELAY;
+    Q_EMIT reconnectingChanged();
+
+    tryReconnect();
+}
+
+/**
+ * Stops looking for the lost device
+ */
+void Serial::stopReconnect()
+{
+    m_reconnectTimer.stop();
+    if (m_reconnecting)
+    {
+        m_reconnecting = false;
+        Q_EMIT reconnectingChanged();
+    }
+}
+
+/**
+ * Returns the index (in @a ports) of the device that was open before being lost, or
+ * -1 if it is not available. USB adapters are matched by vendor & product IDs, then by
+ * serial number or physical USB port; an adapter without serial number that is not in
+ * the same USB port is only accepted if it is the only one with the same IDs. Other
+ * devices are matched by port name.
+ */
+int Serial::findPort(const QVector<QSerialPortInfo> &ports) const
+{
+    int candidate = -1;
+    int candidates = 0;
+    for (int i = 0; i < ports.count(); ++i)
+    {
+        const auto identity = identify(ports.at(i));
+        if (!m_identity.hasIds)
+        {
+            if (identity.portName == m_identity.portName)
+                return i;
+
+            continue;
+        }
+
+        if (!identity.hasIds || identity.vendorId != m_identity.vendorId
+            || identity.productId != m_identity.productId)
+            continue;
+
+        if (!m_identity.serialNumber.isEmpty())
+        {
+            if (identity.serialNumber == m_identity.serialNumber)
+                return i;
+
+            continue;
+        }
+
+        if (!m_identity.physicalPath.isEmpty()
+            && identity.physicalPath == m_identity.physicalPath)
+            return i;
+
+        candidate = i;
+        ++candidates;
+    }
+
+    return candidates == 1 ? candidate : -1;
+}
+
+/**
+ * Returns the identity of the given serial device. The physical path is the sysfs
+ * path of the USB interface (e.g. ".../usb1/1-2/1-2:1.0"), which only depends on the
+ * USB port the adapter is plugged into; it is only available on Linux.
+ */
+Serial::PortIdentity Serial::identify(const QSerialPortInfo &info)
+{
+    PortIdentity identity;
+    identity.hasIds = info.hasVendorIdentifier() && info.hasProductIdentifier();
+    identity.vendorId = info.vendorIdentifier();
+    identity.productId = info.productIdentifier();
+    identity.portName = info.portName();
+    identity.serialNumber = info.serialNumber();
+
+#ifdef Q_OS_LINUX
+    const auto link = QString("/sys/class/tty/%1/device").arg(info.portName());
+    identity.physicalPath = QFileInfo(link).canonicalFilePath();
+    if (identity.physicalPath.endsWith("/" + info.portName()))
+        identity.physicalPath.chop(info.portName().length() + 1);
+#endif
+
+    return identity;
+}
+
+#ifdef Q_OS_UNIX
+/**
+ * Writes the whole @a data to the file descriptor of the port, waiting up to
+ * @c WRITE_TIMEOUT milliseconds for room in the output queue of the OS driver. If the
+ * frame cannot be written completely, it is dropped & counted, and the next frame is
+ * preceded by a line break so that the device discards the incomplete line.
+ */
+quint64 Serial::writeFrame(const QByteArray &data)
+{
+    QMutexLocker locker(&m_handleMutex);
+    if (m_handle < 0 || m_autoBaud)
+        return -1;
+
+    const auto fd = static_cast<int>(m_handle);
+    if (m_torn)
+    {
+        if (writeAll(fd, "\n", 1) < 1)
+        {
+            m_txDropped.fetchAndAddRelaxed(1);
+            return -1;
+        }
+
+        m_torn = false;
+        m_capture.append(SerialCapture::TX, "\n", 1);
+    }
+
+    const auto bytes = writeAll(fd, data.constData(), data.size());
+    if (bytes > 0)
+        m_capture.append(SerialCapture::TX, data.constData(), static_cast<int>(bytes));
+
+    if (bytes < data.size())
+    {
+        m_torn = bytes > 0;
+        m_txDropped.fetchAndAddRelaxed(1);
+        return -1;
+    }
+
+    locker.unlock();
+    m_txFrames.fetchAndAddRelaxed(1);
+    m_txBytes.fetchAndAddRelaxed(static_cast<quint64>(bytes));
+    notifySent(data);
+    return bytes;
+}
+#endif
+
+/**
+ * Emits @c dataSent() with the given @a data, only if a receiver is connected. The
+ * signal is queued to the main thread when a frame is sent from the scheduler thread,
+ * which allocates memory, so frames are not sent through it unless needed (the TX
+ * counters are available through @c txStats()).
+ */
+void Serial::notifySent(const QByteArray &data)
+{
+    static const auto signal = QMetaMethod::fromSignal(&HAL_Driver::dataSent);
+    if (isSignalConnected(signal))
+        Q_EMIT dataSent(data);
+}
+
+/**
+ * Recomputes the number of bytes that can be sent per second, counting the start bit,
+ * the data bits, the parity bit & the stop bits of each byte.
+ */
+void Serial::updateBytesPerSecond()
+{
+    auto bits = 1 + static_cast<int>(dataBits());
+    if (parity() != QSerialPort::NoParity)
+        ++bits;
+
+    bits += stopBits() == QSerialPort::OneStop ? 1 : 2;
+    m_bytesPerSecond.store(baudRate() / bits);
 }
 
 /**
@@ -22,16 +22,32 @@
 
 #pragma once
 
+#include "BaudProbe.h"
 #include "HAL_Driver.h"
+#include "SerialCapture.h"
 
+#include <QMutex>
+#include <QAtomicInteger>
 #include <QObject>
 #include <QString>
 #include <QSettings>
 #include <QByteArray>
+#include <QElapsedTimer>
 #include <QtSerialPort>
 /**
  * @brief The Serial class
  * Serial Studio driver class to interact with serial port devices.
+ *
+ * When auto-reconnect is enabled and the open device disappears (e.g. a USB glitch),
+ * the driver looks for the same adapter, identified by its USB vendor & product IDs,
+ * serial number and physical USB port, with a bounded exponential backoff, and reopens
+ * it as soon as it is available again, even if it got a different port name.
+ *
+ * The baud rate can also be detected automatically, see @c startAutoBaud().
+ *
+ * On Unix, frames are written as a whole to the file descriptor of the port, from any
+ * thread. A frame that cannot be written completely is dropped & counted (see
+ * @c txStats()) instead of being sent partially.
  */
 class Serial : public HAL_Driver
 {
@@ -50,6 +66,10 @@ Q_SIGNALS:
     void baudRateIndexChanged();
     void availablePortsChanged();
     void connectionError(const QString &name);
+    void reconnectingChanged();
+    void reconnected(const qint64 usec);
+    void autoBaudChanged();
+    void autoBaudFinished(const qint32 rate);
 
 private:
     explicit Serial();
@@ -61,6 +81,21 @@ private:
     ~Serial();
 
 public:
+    struct TxStats
+    {
+        quint64 frames;
+        quint64 bytes;
+        quint64 dropped;
+    };
+
+    struct ReconnectStats
+    {
+        quint64 losses;
+        quint64 reconnects;
+        qint64 lastRecovery;
+        qint64 maximumRecovery;
+    };
+
     static Serial &instance();
 
     //
@@ -73,10 +108,17 @@ public:
     bool configurationOk() const override;
     quint64 write(const QByteArray &data) override;
     bool open(const QIODevice::OpenMode mode) override;
+    quint64 writeUrgent(const QByteArray &data, const int repeat) override;
+    qint64 bytesPerSecond() const override;
+    qint64 transmitDelay() override;
 
     QString portName() const;
     QSerialPort *port() const;
     bool autoReconnect() const;
+    bool isReconnecting() const;
+    bool isDetectingBaudRate() const;
+    ReconnectStats reconnectStats() const;
+    TxStats txStats() const;
 
     quint8 portIndex() const;
     quint8 parityIndex() const;
@@ -98,7 +140,17 @@ public:
     QSerialPort::StopBits stopBits() const;
     QSerialPort::FlowControl flowControl() const;
 
+    bool setPortName(const QString &name);
+
+    bool isCapturing() const;
+    quint64 droppedCapturePackets() const;
+    bool startCapture(const QString &path, QString *error = nullptr);
+
+    bool startAutoBaud(const QByteArray &probe = QByteArray());
+
 public Q_SLOTS:
+    void stopAutoBaud();
+    void stopCapture();
     void disconnectDevice();
     void setBaudRate(const qint32 rate);
     void setParity(const quint8 parityIndex);
@@ -111,20 +163,65 @@ public Q_SLOTS:
 
 private Q_SLOTS:
     void onReadyRead();
+    void tryReconnect();
+    void nextAutoBaudRate();
     void readSettings();
     void writeSettings();
+    void updateBytesPerSecond();
     void refreshSerialDevices();
     void handleError(QSerialPort::SerialPortError error);
 
 private:
+    struct PortIdentity
+    {
+        bool hasIds;
+        quint16 vendorId;
+        quint16 productId;
+        QString portName;
+        QString serialNumber;
+        QString physicalPath;
+    };
+
+    void finishAutoBaud(const qint32 rate);
+
+    void startReconnect();
+    void stopReconnect();
+    int findPort(const QVector<QSerialPortInfo> &ports) const;
+    static PortIdentity identify(const QSerialPortInfo &info);
+
+#ifdef Q_OS_UNIX
+    quint64 writeFrame(const QByteArray &data);
+#endif
+    void notifySent(const QByteArray &data);
     QVector<QSerialPortInfo> validPorts() const;
 
 private:
     QSerialPort *m_port;
+    QMutex m_handleMutex;
+    qintptr m_handle;
+    bool m_torn;
+    QAtomicInteger<quint64> m_txFrames;
+    QAtomicInteger<quint64> m_txBytes;
+    QAtomicInteger<quint64> m_txDropped;
+    QAtomicInteger<qint64> m_bytesPerSecond;
     QTimer m_refreshTimer;
+    SerialCapture m_capture;
 
     bool m_autoReconnect;
-    int m_lastSerialDeviceIndex;
+    bool m_reconnecting;
+    int m_reconnectDelay;
+    QTimer m_reconnectTimer;
+    QElapsedTimer m_lossClock;
+    PortIdentity m_identity;
+    QIODevice::OpenMode m_openMode;
+    ReconnectStats m_reconnectStats;
+
+    bool m_autoBaud;
+    int m_autoBaudIndex;
+    QByteArray m_autoBaudProbe;
+    QVector<qint32> m_autoBaudRates;
+    QTimer m_autoBaudTimer;
+    BaudProbe m_baudProbe;
 
     qint32 m_baudRate;
     QSettings m_settings;
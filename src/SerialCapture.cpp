@@ -0,0 +1,247 @@
+/*
+ * Copyright (c) 2022 Alex Spataru <https://github.com/alex-spataru>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "SerialCapture.h"
+
+#include <QtEndian>
+#include <QDateTime>
+
+#ifdef Q_OS_UNIX
+#    include <time.h>
+#endif
+
+/**
+ * Size of each capture buffer
+ */
+static const int BUFFER_SIZE = 256 * 1024;
+
+/**
+ * pcap constants: nanosecond-resolution magic number, file format version, maximum
+ * packet size & link type reserved for private use.
+ */
+static const quint32 PCAP_MAGIC = 0xa1b23c4d;
+static const quint16 PCAP_VERSION_MAJOR = 2;
+static const quint16 PCAP_VERSION_MINOR = 4;
+static const quint32 PCAP_SNAPLEN = 65535;
+static const quint32 LINKTYPE_USER0 = 147;
+
+/**
+ * Size of the header of each packet & of the direction byte
+ */
+static const int PACKET_HEADER_SIZE = 16 + 1;
+
+/**
+ * Returns the current time in nanoseconds since epoch
+ */
+static quint64 wallClockTime()
+{
+#ifdef Q_OS_UNIX
+    timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return static_cast<quint64>(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+#else
+    return static_cast<quint64>(QDateTime::currentMSecsSinceEpoch()) * 1000000;
+#endif
+}
+
+/**
+ * Constructor function
+ */
+SerialCapture::SerialCapture(QObject *parent)
+    : QThread(parent)
+    , m_capturing(0)
+    , m_stop(false)
+    , m_pending(false)
+    , m_front(0)
+    , m_dropped(0)
+{
+    m_used[0] = 0;
+    m_used[1] = 0;
+}
+
+/**
+ * Destructor function, writes the pending packets & closes the capture file
+ */
+SerialCapture::~SerialCapture()
+{
+    close();
+}
+
+/**
+ * Returns @c true if serial traffic is being recorded
+ */
+bool SerialCapture::isCapturing() const
+{
+    return m_capturing.load() != 0;
+}
+
+/**
+ * Returns the number of packets that could not be captured because the disk was not
+ * fast enough.
+ */
+quint64 SerialCapture::droppedPackets() const
+{
+    QMutexLocker locker(const_cast<QMutex *>(&m_mutex));
+    return m_dropped;
+}
+
+/**
+ * Creates the capture file at the given @a path & starts recording serial traffic.
+ * Returns @c false and writes the reason to @a error if the file cannot be created.
+ */
+bool SerialCapture::open(const QString &path, QString *error)
+{
+    close();
+
+    // Create capture file
+    m_file.setFileName(path);
+    if (!m_file.open(QFile::WriteOnly | QFile::Truncate))
+    {
+        if (error)
+            *error = m_file.errorString();
+
+        return false;
+    }
+
+    // Write pcap global header
+    uchar header[24];
+    qToLittleEndian<quint32>(PCAP_MAGIC, header);
+    qToLittleEndian<quint16>(PCAP_VERSION_MAJOR, header + 4);
+    qToLittleEndian<quint16>(PCAP_VERSION_MINOR, header + 6);
+    qToLittleEndian<qint32>(0, header + 8);
+    qToLittleEndian<quint32>(0, header + 12);
+    qToLittleEndian<quint32>(PCAP_SNAPLEN, header + 16);
+    qToLittleEndian<quint32>(LINKTYPE_USER0, header + 20);
+    m_file.write(reinterpret_cast<const char *>(header), sizeof(header));
+
+    // Allocate buffers
+    m_buffers[0].resize(BUFFER_SIZE);
+    m_buffers[1].resize(BUFFER_SIZE);
+    m_used[0] = 0;
+    m_used[1] = 0;
+    m_front = 0;
+    m_dropped = 0;
+    m_stop = false;
+    m_pending = false;
+
+    // Start writer thread
+    m_capturing.store(1);
+    start();
+    return true;
+}
+
+/**
+ * Stops recording, writes the pending packets & closes the capture file
+ */
+void SerialCapture::close()
+{
+    if (!isCapturing())
+        return;
+
+    m_capturing.store(0);
+    {
+        QMutexLocker locker(&m_mutex);
+        m_stop = true;
+        m_condition.wakeOne();
+    }
+
+    wait();
+    m_file.close();
+}
+
+/**
+ * Registers a chunk of @a length bytes sent or received through the serial port. The
+ * data is copied into the current buffer, this function never waits for the disk.
+ */
+void SerialCapture::append(const Direction direction, const char *data, const int length)
+{
+    if (!isCapturing() || length <= 0)
+        return;
+
+    const auto timestamp = wallClockTime();
+    const auto captured = qMin(length, static_cast<int>(PCAP_SNAPLEN) - 1);
+    const auto size = PACKET_HEADER_SIZE + captured;
+
+    QMutexLocker locker(&m_mutex);
+
+    // Current buffer is full, hand it to the writer thread
+    if (m_used[m_front] + size > BUFFER_SIZE)
+    {
+        if (m_pending)
+        {
+            ++m_dropped;
+            return;
+        }
+
+        m_pending = true;
+        m_front ^= 1;
+        m_condition.wakeOne();
+    }
+
+    // Write packet header, direction & data
+    auto dst = reinterpret_cast<uchar *>(m_buffers[m_front].data()) + m_used[m_front];
+    qToLittleEndian<quint32>(static_cast<quint32>(timestamp / 1000000000), dst);
+    qToLittleEndian<quint32>(static_cast<quint32>(timestamp % 1000000000), dst + 4);
+    qToLittleEndian<quint32>(static_cast<quint32>(captured + 1), dst + 8);
+    qToLittleEndian<quint32>(static_cast<quint32>(length + 1), dst + 12);
+    dst[16] = static_cast<uchar>(direction);
+    memcpy(dst + PACKET_HEADER_SIZE, data, captured);
+    m_used[m_front] += size;
+}
+
+/**
+ * Writer thread, writes full buffers as soon as they are handed over & the partially
+ * filled buffer every half second, so that long captures are streamed to the disk.
+ */
+void SerialCapture::run()
+{
+    QMutexLocker locker(&m_mutex);
+    while (true)
+    {
+        if (!m_pending && !m_stop)
+            m_condition.wait(&m_mutex, 500);
+
+        // Hand over the partially filled buffer
+        if (!m_pending && m_used[m_front] > 0)
+        {
+            m_pending = true;
+            m_front ^= 1;
+        }
+
+        // Write the back buffer without blocking the producers
+        if (m_pending)
+        {
+            const int back = m_front ^ 1;
+            locker.unlock();
+            m_file.write(m_buffers[back].constData(), m_used[back]);
+            m_file.flush();
+            locker.relock();
+
+            m_used[back] = 0;
+            m_pending = false;
+        }
+
+        // Exit once everything has been written
+        if (m_stop && !m_pending && m_used[m_front] == 0)
+            break;
+    }
+}
@@ -0,0 +1,81 @@
+/*
+ * Copyright (c) 2022 Alex Spataru <https://github.com/alex-spataru>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <QFile>
+#include <QMutex>
+#include <QThread>
+#include <QAtomicInt>
+#include <QByteArray>
+#include <QWaitCondition>
+
+/**
+ * @brief The SerialCapture class
+ *
+ * Records every chunk of data sent to or received from the serial device in a pcap
+ * file (nanosecond timestamps, link type @c LINKTYPE_USER0). The first byte of each
+ * packet indicates the direction of the data (0 = TX, 1 = RX), followed by the raw
+ * bytes. Captures can be opened with Wireshark or any pcap-compatible tool.
+ *
+ * Packets are copied into one of two buffers that are allocated when the capture
+ * starts, while a background thread writes the other buffer to the disk. The I/O path
+ * never waits for the disk: if both buffers are full, the packet is dropped & counted.
+ */
+class SerialCapture : public QThread
+{
+    Q_OBJECT
+
+public:
+    enum Direction
+    {
+        TX = 0,
+        RX = 1,
+    };
+
+    explicit SerialCapture(QObject *parent = nullptr);
+    ~SerialCapture();
+
+    bool isCapturing() const;
+    quint64 droppedPackets() const;
+
+    bool open(const QString &path, QString *error = nullptr);
+    void close();
+
+    void append(const Direction direction, const char *data, const int length);
+
+protected:
+    void run() override;
+
+private:
+    QFile m_file;
+    QMutex m_mutex;
+    QWaitCondition m_condition;
+    QAtomicInt m_capturing;
+
+    bool m_stop;
+    bool m_pending;
+    int m_front;
+    int m_used[2];
+    QByteArray m_buffers[2];
+    quint64 m_dropped;
+};
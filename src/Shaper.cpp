@@ -0,0 +1,130 @@
+/*
+ * Copyright (c) 2022 Alex Spataru <https://github.com/alex-spataru>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+#include "Shaper.h"
+
+#include <cmath>
+
+/**
+ * Returns @c true if the given @a limits shape the value in any way
+ */
+bool Shaper::isLimited(const Limits &limits)
+{
+    return limits.rate > 0 || limits.acceleration > 0;
+}
+
+/**
+ * Moves the output to the given @a value right away & stops it there
+ */
+void Shaper::reset(State &state, const double value)
+{
+    state.value = value;
+    state.position = value;
+    state.velocity = 0;
+    state.sum = value;
+    state.head = 0;
+    state.window = 1;
+    state.steady = 0;
+    for (int i = 0; i < MAX_WINDOW; ++i)
+        state.history[i] = value;
+}
+
+/**
+ * Moves the output towards the given @a target during one frame of @a dt seconds,
+ * without exceeding the given @a limits. The value to send is stored in @c state.value.
+ */
+void Shaper::step(State &state, const double target, const Limits &limits,
+                  const double dt)
+{
+    const auto previous = state.position;
+    const auto distance = target - state.position;
+
+    // No acceleration limit, move at the maximum rate (if any)
+    if (limits.acceleration <= 0)
+    {
+        const auto range = limits.rate > 0 ? limits.rate * dt : std::fabs(distance);
+        const auto move = qBound(-range, distance, range);
+        state.position += move;
+        state.velocity = move == distance ? 0 : move / dt;
+    }
+
+    // Trapezoidal profile, the speed is limited to the highest speed from which the
+    // output can still stop at the target with the given acceleration
+    else
+    {
+        const auto change = limits.acceleration * dt;
+        auto speed = change * (std::sqrt(0.25 + 2 * std::fabs(distance) / (change * dt))
+                               - 0.5);
+        if (limits.rate > 0)
+            speed = qMin(speed, limits.rate);
+
+        const auto desired = distance < 0 ? -speed : speed;
+        state.velocity += qBound(-change, desired - state.velocity, change);
+
+        // Stop at the target once it can be reached during this frame
+        const auto move = state.velocity * dt;
+        if (std::fabs(move) >= std::fabs(distance)
+            && std::fabs(state.velocity) <= change * 1.5)
+        {
+            state.position = target;
+            state.velocity = 0;
+        }
+
+        else
+            state.position += move;
+    }
+
+    // Length of the S-curve average, in frames
+    int window = 1;
+    if (limits.jerk > 0 && limits.acceleration > 0)
+    {
+        const auto frames = std::round(2 * limits.acceleration / limits.jerk / dt);
+        window = static_cast<int>(qBound(1.0, frames, double(MAX_WINDOW)));
+    }
+
+    // Sum of the last positions within the window, recalculated if the window changes
+    const auto mask = MAX_WINDOW - 1;
+    if (window != state.window)
+    {
+        state.sum = 0;
+        state.window = window;
+        for (int i = 1; i <= window; ++i)
+            state.sum += state.history[(state.head - i) & mask];
+    }
+
+    state.sum += state.position - state.history[(state.head - window) & mask];
+    state.history[state.head] = state.position;
+    state.head = (state.head + 1) & mask;
+
+    // Once the position has not changed for a whole window, send it exactly
+    const auto steady = qMin(state.steady + 1, int(MAX_WINDOW));
+    state.steady = state.position == previous ? steady : 0;
+    if (state.steady >= window)
+    {
+        state.value = state.position;
+        state.sum = state.position * window;
+    }
+
+    else
+        state.value = state.sum / window;
+}
@@ -0,0 +1,75 @@
+/*
+ * Copyright (c) 2022 Alex Spataru <https://github.com/alex-spataru>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <QtGlobal>
+
+/**
+ * @brief The Shaper class
+ *
+ * Limits how fast the value sent for an output follows the value requested by the
+ * bindings, so that a button that sets a speed from 0 to 1, or adds 360 steps to a
+ * stepper target, produces a smooth motion instead of a jump. The value is shaped on
+ * the host at frame rate, so the firmware does not need to change. Depending on the
+ * limits of the output:
+ *
+ * - @c rate only: the value moves at a constant speed (slew-rate limit).
+ * - @c acceleration: the value follows a trapezoidal profile, it accelerates up to
+ *   @c rate (if set) and decelerates so that it stops exactly at the target.
+ * - @c jerk (with @c acceleration): the trapezoidal profile is averaged over the time
+ *   needed to reach the acceleration at that jerk, which turns it into an S-curve
+ *   without overshooting the target.
+ *
+ * Limits are expressed in output units per second (before the output scale), a limit
+ * of zero means no limit. Each shaped output keeps a @c State, allocated once.
+ */
+class Shaper
+{
+public:
+    static const int MAX_WINDOW = 256;
+
+    struct Limits
+    {
+        double rate;
+        double acceleration;
+        double jerk;
+    };
+
+    struct State
+    {
+        double value;
+        double position;
+        double velocity;
+        double sum;
+        int head;
+        int window;
+        int steady;
+        double history[MAX_WINDOW];
+    };
+
+    static bool isLimited(const Limits &limits);
+    static void reset(State &state, const double value);
+    static void step(State &state, const double target, const Limits &limits,
+                     const double dt);
+};
@@ -0,0 +1,131 @@
+/*
+ * Copyright (c) 2022 Alex Spataru <https://github.com/alex-spataru>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "Telemetry.h"
+#include "Serial.h"
+
+/**
+ * Constructor function, decodes the data received from the serial device
+ */
+Telemetry::Telemetry()
+    : m_format(Text)
+    , m_records(0)
+    , m_timestamp(0)
+{
+    // Create the handlers once, instead of for each received chunk
+    m_recordHandler = [this](const TelemetryParser::Record &record) { onRecord(record); };
+    m_lineHandler = [this](const char *line, const int length) {
+        if (m_parser.parseLine(line, length, m_timestamp))
+            onRecord(m_parser.record());
+    };
+
+    m_clock.start();
+    connect(&Serial::instance(), &Serial::dataReceived, this, &Telemetry::append);
+}
+
+/**
+ * Returns the only instance of the class
+ */
+Telemetry &Telemetry::instance()
+{
+    static Telemetry singleton;
+    return singleton;
+}
+
+/**
+ * Returns the format of the telemetry sent by the firmware
+ */
+Telemetry::Format Telemetry::format() const
+{
+    return m_format;
+}
+
+/**
+ * Returns the number of lines or frames that could not be decoded
+ */
+quint64 Telemetry::errorCount() const
+{
+    return m_parser.errors();
+}
+
+/**
+ * Returns the number of records decoded since the telemetry was cleared
+ */
+quint64 Telemetry::recordCount() const
+{
+    return m_records;
+}
+
+/**
+ * Returns the last decoded record
+ */
+const TelemetryParser::Record &Telemetry::record() const
+{
+    return m_parser.record();
+}
+
+/**
+ * Resets the record & the counters, and discards any incomplete line or frame
+ */
+void Telemetry::clear()
+{
+    m_records = 0;
+    m_framer.clear();
+    m_parser.clear();
+    m_clock.restart();
+}
+
+/**
+ * Changes the format of the telemetry sent by the firmware
+ */
+void Telemetry::setFormat(const Format format)
+{
+    if (m_format != format)
+    {
+        m_format = format;
+        clear();
+        Q_EMIT formatChanged();
+    }
+}
+
+/**
+ * Decodes a chunk of data received from the serial device. All the records contained
+ * in the chunk share the same timestamp.
+ */
+void Telemetry::append(const QByteArray &data)
+{
+    m_timestamp = m_clock.nsecsElapsed();
+    if (m_format == Binary)
+        m_parser.appendBinary(data.constData(), data.size(), m_timestamp,
+                              m_recordHandler);
+    else
+        m_framer.append(data.constData(), data.size(), m_lineHandler);
+}
+
+/**
+ * Counts & reports a decoded record
+ */
+void Telemetry::onRecord(const TelemetryParser::Record &record)
+{
+    ++m_records;
+    Q_EMIT recordReceived(record);
+}
@@ -0,0 +1,92 @@
+/*
+ * Copyright (c) 2022 Alex Spataru <https://github.com/alex-spataru>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <QObject>
+#include <QByteArray>
+#include <QElapsedTimer>
+
+#include "LineFramer.h"
+#include "TelemetryParser.h"
+
+/**
+ * @brief The Telemetry class
+ *
+ * Decodes the telemetry received from the serial device as it arrives, straight from
+ * the received bytes, so that the feedback of the firmware can be plotted or acted upon
+ * at the full link rate. See @c TelemetryParser for the supported formats.
+ *
+ * Every decoded record is reported with the @c recordReceived() signal. The record is
+ * reused for each line or frame, so it must be processed (or copied) by slots that are
+ * connected directly. Timestamps are in nanoseconds since the telemetry was cleared.
+ */
+class Telemetry : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum Format
+    {
+        Text,
+        Binary
+    };
+    Q_ENUM(Format)
+
+Q_SIGNALS:
+    void formatChanged();
+    void recordReceived(const TelemetryParser::Record &record);
+
+private:
+    explicit Telemetry();
+    Telemetry(Telemetry &&) = delete;
+    Telemetry(const Telemetry &) = delete;
+    Telemetry &operator=(Telemetry &&) = delete;
+    Telemetry &operator=(const Telemetry &) = delete;
+
+public:
+    static Telemetry &instance();
+
+    Format format() const;
+    quint64 errorCount() const;
+    quint64 recordCount() const;
+    const TelemetryParser::Record &record() const;
+
+public Q_SLOTS:
+    void clear();
+    void setFormat(const Format format);
+    void append(const QByteArray &data);
+
+private:
+    void onRecord(const TelemetryParser::Record &record);
+
+private:
+    Format m_format;
+    quint64 m_records;
+    qint64 m_timestamp;
+    QElapsedTimer m_clock;
+
+    LineFramer m_framer;
+    TelemetryParser m_parser;
+    LineFramer::LineHandler m_lineHandler;
+    TelemetryParser::RecordHandler m_recordHandler;
+};
@@ -0,0 +1,306 @@
+/*
+ * Copyright (c) 2022 Alex Spataru <https://github.com/alex-spataru>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "TelemetryParser.h"
+
+#include <QtEndian>
+
+#include <cstring>
+
+/**
+ * Sync bytes at the beginning of each binary frame
+ */
+static const quint8 SYNC_1 = 0xA5;
+static const quint8 SYNC_2 = 0x5A;
+
+/**
+ * Returns @c true if @a c separates two fields of a text line
+ */
+static inline bool isSeparator(const char c)
+{
+    return c == ',' || c == ';';
+}
+
+/**
+ * Returns @c true if @a c is a space or a tab
+ */
+static inline bool isBlank(const char c)
+{
+    return c == ' ' || c == '\t';
+}
+
+/**
+ * Constructor function
+ */
+TelemetryParser::TelemetryParser()
+{
+    clear();
+}
+
+/**
+ * Resets every field & discards the binary frame received so far
+ */
+void TelemetryParser::clear()
+{
+    memset(&m_record, 0, sizeof(m_record));
+    m_errors = 0;
+    m_binaryUsed = 0;
+}
+
+/**
+ * Returns the number of lines or frames that could not be decoded
+ */
+quint64 TelemetryParser::errors() const
+{
+    return m_errors;
+}
+
+/**
+ * Returns the last decoded record
+ */
+const TelemetryParser::Record &TelemetryParser::record() const
+{
+    return m_record;
+}
+
+/**
+ * Decodes the fields of a text @a line (without line ending) received at the given
+ * @a timestamp. Returns @c false if the line contains a field that is not a number, or
+ * if it is a control line. The record is only updated once the whole line is valid.
+ */
+bool TelemetryParser::parseLine(const char *line, const int length,
+                                const qint64 timestamp)
+{
+    // Control lines (e.g. acknowledgements) are not telemetry
+    if (length > 0 && line[0] == '#')
+        return false;
+
+    // Decode the line aside, a rejected line must not change any field
+    double values[MAX_FIELDS];
+    bool present[MAX_FIELDS];
+
+    int index = 0;
+    int decoded = 0;
+    const auto end = line + length;
+    auto position = line;
+
+    while (position < end && index < MAX_FIELDS)
+    {
+        // Find the beginning & end of the field
+        while (position < end && isBlank(*position))
+            ++position;
+
+        const auto begin = position;
+        while (position < end && !isSeparator(*position) && !isBlank(*position))
+            ++position;
+
+        const auto fieldEnd = position;
+        while (position < end && isBlank(*position))
+            ++position;
+
+        if (position < end && isSeparator(*position))
+            ++position;
+
+        // Empty fields keep their previous value
+        present[index] = begin != fieldEnd;
+        if (present[index])
+        {
+            if (!parseNumber(begin, fieldEnd, values[index]))
+            {
+                ++m_errors;
+                return false;
+            }
+
+            ++decoded;
+        }
+
+        ++index;
+    }
+
+    if (decoded == 0)
+    {
+        ++m_errors;
+        return false;
+    }
+
+    for (int i = 0; i < index; ++i)
+    {
+        if (present[i])
+        {
+            m_record.fields[i].value = values[i];
+            m_record.fields[i].timestamp = timestamp;
+        }
+    }
+
+    m_record.count = index;
+    m_record.timestamp = timestamp;
+    ++m_record.sequence;
+    return true;
+}
+
+/**
+ * Decodes the binary frames contained in a chunk of @a length bytes received at the
+ * given @a timestamp, calling @a handler for each complete frame. Frames may be split
+ * across several chunks.
+ */
+void TelemetryParser::appendBinary(const char *data, const int length,
+                                   const qint64 timestamp, const RecordHandler &handler)
+{
+    auto bytes = reinterpret_cast<const quint8 *>(data);
+
+    int i = 0;
+    while (i < length)
+    {
+        // Look for the sync bytes
+        if (m_binaryUsed < 2)
+        {
+            const auto byte = bytes[i++];
+            if (m_binaryUsed == 0 && byte == SYNC_1)
+                m_binary[m_binaryUsed++] = byte;
+            else if (m_binaryUsed == 1 && byte == SYNC_2)
+                m_binary[m_binaryUsed++] = byte;
+            else if (byte != SYNC_1)
+                m_binaryUsed = 0;
+
+            continue;
+        }
+
+        // Validate the number of fields
+        if (m_binaryUsed == 2)
+        {
+            const auto count = bytes[i++];
+            if (count == 0 || count > MAX_FIELDS)
+            {
+                ++m_errors;
+                m_binaryUsed = 0;
+                continue;
+            }
+
+            m_binary[m_binaryUsed++] = count;
+        }
+
+        // Copy as much of the fields & checksum as possible
+        const int size = 4 + m_binary[2] * 4;
+        const int chunk = qMin(size - m_binaryUsed, length - i);
+        memcpy(m_binary + m_binaryUsed, bytes + i, chunk);
+        m_binaryUsed += chunk;
+        i += chunk;
+
+        if (m_binaryUsed == size)
+        {
+            m_binaryUsed = 0;
+            if (decodeBinary(timestamp))
+                handler(m_record);
+            else
+                ++m_errors;
+        }
+    }
+}
+
+/**
+ * Verifies the checksum of the binary frame that has been received & copies its fields
+ * to the record.
+ */
+bool TelemetryParser::decodeBinary(const qint64 timestamp)
+{
+    const int count = m_binary[2];
+    const int size = 4 + count * 4;
+
+    quint8 checksum = 0;
+    for (int i = 2; i < size - 1; ++i)
+        checksum ^= m_binary[i];
+
+    if (checksum != m_binary[size - 1])
+        return false;
+
+    for (int i = 0; i < count; ++i)
+    {
+        float value;
+        const auto raw = qFromLittleEndian<quint32>(m_binary + 3 + i * 4);
+        memcpy(&value, &raw, sizeof(value));
+
+        m_record.fields[i].value = value;
+        m_record.fields[i].timestamp = timestamp;
+    }
+
+    m_record.count = count;
+    m_record.timestamp = timestamp;
+    ++m_record.sequence;
+    return true;
+}
+
+/**
+ * Converts the decimal number between @a begin and @a end (e.g. "-12.5" or "3e-2") to
+ * a double, independently of the locale. Returns @c false if the text is not a number.
+ */
+bool TelemetryParser::parseNumber(const char *begin, const char *end, double &value)
+{
+    auto c = begin;
+    bool negative = false;
+    if (c < end && (*c == '-' || *c == '+'))
+        negative = (*c++ == '-');
+
+    // Integer & fractional parts
+    int digits = 0;
+    double result = 0;
+    for (; c < end && *c >= '0' && *c <= '9'; ++c, ++digits)
+        result = result * 10 + (*c - '0');
+
+    if (c < end && *c == '.')
+    {
+        double scale = 0.1;
+        for (++c; c < end && *c >= '0' && *c <= '9'; ++c, ++digits)
+        {
+            result += (*c - '0') * scale;
+            scale /= 10;
+        }
+    }
+
+    if (digits == 0)
+        return false;
+
+    // Exponent
+    if (c < end && (*c == 'e' || *c == 'E'))
+    {
+        ++c;
+        bool negativeExponent = false;
+        if (c < end && (*c == '-' || *c == '+'))
+            negativeExponent = (*c++ == '-');
+
+        int exponent = 0;
+        const auto exponentBegin = c;
+        for (; c < end && *c >= '0' && *c <= '9' && exponent < 400; ++c)
+            exponent = exponent * 10 + (*c - '0');
+
+        if (c == exponentBegin)
+            return false;
+
+        for (; exponent > 0; --exponent)
+            result = negativeExponent ? result / 10 : result * 10;
+    }
+
+    if (c != end)
+        return false;
+
+    value = negative ? -result : result;
+    return true;
+}
@@ -0,0 +1,87 @@
+/*
+ * Copyright (c) 2022 Alex Spataru <https://github.com/alex-spataru>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <QtGlobal>
+
+#include <functional>
+
+/**
+ * @brief The TelemetryParser class
+ *
+ * Decodes the telemetry sent back by the firmware into a typed record, directly from
+ * the received bytes and without any intermediate string. Two formats are supported:
+ *
+ * - Text: lines with numeric fields separated by commas, semicolons, tabs or spaces,
+ *   e.g. "1523,-20,90.5,3240". Lines must be split beforehand (see @c LineFramer).
+ *   Lines starting with '#' are control lines (see @c ReliableLink) and are skipped.
+ * - Binary: frames made of the sync bytes 0xA5 0x5A, the number of fields (1 byte),
+ *   the fields as little-endian 32-bit floats and the XOR of the count & field bytes.
+ *
+ * The record is allocated once with room for @c MAX_FIELDS fields. Each field keeps
+ * the time at which it was last received, fields that are missing from a line keep
+ * their previous value & timestamp. Lines & frames that are not valid do not change
+ * the record at all.
+ */
+class TelemetryParser
+{
+public:
+    static const int MAX_FIELDS = 32;
+
+    struct Field
+    {
+        double value;
+        qint64 timestamp;
+    };
+
+    struct Record
+    {
+        int count;
+        qint64 timestamp;
+        quint64 sequence;
+        Field fields[MAX_FIELDS];
+    };
+
+    typedef std::function<void(const Record &record)> RecordHandler;
+
+    TelemetryParser();
+
+    void clear();
+    quint64 errors() const;
+    const Record &record() const;
+
+    bool parseLine(const char *line, const int length, const qint64 timestamp);
+    void appendBinary(const char *data, const int length, const qint64 timestamp,
+                      const RecordHandler &handler);
+
+private:
+    bool decodeBinary(const qint64 timestamp);
+    static bool parseNumber(const char *begin, const char *end, double &value);
+
+private:
+    Record m_record;
+    quint64 m_errors;
+
+    int m_binaryUsed;
+    quint8 m_binary[4 + MAX_FIELDS * 4];
+};
@@ -0,0 +1,325 @@
+/*
+ * Copyright (c) 2022 Alex Spataru <https://github.com/alex-spataru>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "TelemetryPlot.h"
+
+#include <QPainter>
+#include <QPaintEvent>
+
+#include <limits>
+
+/**
+ * Space between the lanes & around the plotted values, in pixels
+ */
+static const int MARGIN = 4;
+
+/**
+ * Color of the plot of each field
+ */
+static const QRgb COLORS[TelemetryPlot::MAX_CHANNELS]
+    = { 0x2e86de, 0xe84118, 0x44bd32, 0xfbc531, 0x8c7ae6, 0x00a8ff, 0xe1b12c, 0x7f8fa6 };
+
+/**
+ * Value of empty buckets, so that any sample replaces both limits
+ */
+static const double EMPTY = std::numeric_limits<double>::infinity();
+
+/**
+ * Constructor function
+ */
+TelemetryPlot::TelemetryPlot(QWidget *parent)
+    : QWidget(parent)
+    , m_dirty(false)
+    , m_window(0)
+    , m_channels(0)
+    , m_head(-1)
+    , m_offset(0)
+    , m_bucketDuration(1)
+{
+    m_lines.reserve(4096);
+    m_buckets.resize(MAX_CHANNELS * BUCKETS);
+
+    connect(&m_timer, &QTimer::timeout, this, &TelemetryPlot::refresh);
+    setRefreshRate(30);
+    setWindow(10 * 1000);
+    m_clock.start();
+    m_timer.start();
+}
+
+/**
+ * Returns the time span of the plot, in milliseconds
+ */
+int TelemetryPlot::window() const
+{
+    return m_window;
+}
+
+/**
+ * Returns the number of times per second that the plot is moved to the current time &
+ * repainted
+ */
+int TelemetryPlot::refreshRate() const
+{
+    return 1000 / qMax(1, m_timer.interval());
+}
+
+/**
+ * Returns the preferred size of the plot
+ */
+QSize TelemetryPlot::sizeHint() const
+{
+    return QSize(640, 240);
+}
+
+/**
+ * Removes every plotted value
+ */
+void TelemetryPlot::clear()
+{
+    m_head = -1;
+    m_channels = 0;
+    m_dirty = false;
+    for (auto &value : m_values)
+        value = 0;
+
+    for (auto &bucket : m_buckets)
+    {
+        bucket.minimum = EMPTY;
+        bucket.maximum = -EMPTY;
+    }
+
+    update();
+}
+
+/**
+ * Changes the time span of the plot & removes the plotted values
+ */
+void TelemetryPlot::setWindow(const int msec)
+{
+    m_window = qMax(1, msec);
+    m_bucketDuration = qMax(qint64(1), qint64(m_window) * 1000 * 1000 / BUCKETS);
+    clear();
+}
+
+/**
+ * Changes the number of times per second that the plot is moved to the current time &
+ * repainted
+ */
+void TelemetryPlot::setRefreshRate(const int hz)
+{
+    m_timer.setInterval(1000 / qBound(1, hz, 1000));
+}
+
+/**
+ * Adds the fields received in the given telemetry @a record to the bucket of its time
+ * slice. Fields that were not updated by the record are ignored.
+ */
+void TelemetryPlot::append(const TelemetryParser::Record &record)
+{
+    const auto index = record.timestamp / m_bucketDuration;
+
+    // Telemetry was restarted or is too old to be displayed
+    if (index <= m_head - BUCKETS)
+        clear();
+
+    // Relate the clock of the telemetry to ours, to keep moving between records
+    m_offset = record.timestamp - m_clock.nsecsElapsed();
+    advance(index);
+
+    const auto channels = qMin(record.count, int(MAX_CHANNELS));
+    for (int i = 0; i < channels; ++i)
+    {
+        const auto &field = record.fields[i];
+        if (field.timestamp != record.timestamp)
+            continue;
+
+        auto &slice = bucket(i, index);
+        slice.minimum = qMin(slice.minimum, field.value);
+        slice.maximum = qMax(slice.maximum, field.value);
+        m_values[i] = field.value;
+    }
+
+    m_channels = qMax(m_channels, channels);
+    m_dirty = true;
+}
+
+/**
+ * Paints each field in its own lane, with one vertical line per pixel column spanning
+ * the values received during the time represented by the column.
+ */
+void TelemetryPlot::paintEvent(QPaintEvent *event)
+{
+    Q_UNUSED(event);
+
+    QPainter painter(this);
+    painter.fillRect(rect(), palette().base());
+    if (m_head < 0 || m_channels == 0)
+    {
+        painter.setPen(palette().color(QPalette::PlaceholderText));
+        painter.drawText(rect(), Qt::AlignCenter, tr("Sin telemetría"));
+        return;
+    }
+
+    const auto columns = qMax(1, width());
+    const auto oldest = m_head - BUCKETS + 1;
+    const auto laneHeight = height() / m_channels;
+    for (int channel = 0; channel < m_channels; ++channel)
+    {
+        // Vertical scale of the lane
+        auto low = EMPTY;
+        auto high = -EMPTY;
+        for (int i = 0; i < BUCKETS; ++i)
+        {
+            const auto &slice = bucket(channel, oldest + i);
+            low = qMin(low, slice.minimum);
+            high = qMax(high, slice.maximum);
+        }
+
+        if (low > high)
+            continue;
+
+        if (high - low < 1e-9)
+        {
+            low -= 1;
+            high += 1;
+        }
+
+        const auto top = channel * laneHeight + MARGIN;
+        const auto scale = (laneHeight - 2 * MARGIN) / (high - low);
+
+        // Reduce the buckets to one line per column, joined with the previous column
+        bool previous = false;
+        double previousLow = 0, previousHigh = 0;
+        m_lines.resize(0);
+        for (int x = 0; x < columns; ++x)
+        {
+            const int first = x * BUCKETS / columns;
+            const int last = qMax(first + 1, (x + 1) * BUCKETS / columns);
+
+            auto minimum = EMPTY;
+            auto maximum = -EMPTY;
+            for (int i = first; i < last; ++i)
+            {
+                const auto &slice = bucket(channel, oldest + i);
+                minimum = qMin(minimum, slice.minimum);
+                maximum = qMax(maximum, slice.maximum);
+            }
+
+            if (minimum > maximum)
+            {
+                previous = false;
+                continue;
+            }
+
+            auto from = minimum;
+            auto to = maximum;
+            if (previous)
+            {
+                from = qMin(from, previousHigh);
+                to = qMax(to, previousLow);
+            }
+
+            m_lines.append(QLineF(x + 0.5, top + (high - from) * scale, x + 0.5,
+                                  top + (high - to) * scale));
+
+            previous = true;
+            previousLow = minimum;
+            previousHigh = maximum;
+        }
+
+        painter.setPen(QColor(COLORS[channel]));
+        painter.drawLines(m_lines);
+
+        // Field number & last value
+        painter.setPen(palette().color(QPalette::Text));
+        painter.drawText(MARGIN, top + fontMetrics().ascent(),
+                         tr("Campo %1: %2").arg(channel + 1).arg(m_values[channel]));
+    }
+}
+
+/**
+ * Moves the plot to the current time of the telemetry, even if no record was received
+ * since the last refresh, and repaints it if it changed
+ */
+void TelemetryPlot::refresh()
+{
+    if (m_head < 0)
+        return;
+
+    const auto head = m_head;
+    advance((m_clock.nsecsElapsed() + m_offset) / m_bucketDuration);
+
+    if ((m_dirty || m_head != head) && isVisible())
+    {
+        m_dirty = false;
+        update();
+    }
+}
+
+/**
+ * Starts the time slices that elapsed up to the one with the given @a index, reusing
+ * the buckets of the time slices that are now out of the window
+ */
+void TelemetryPlot::advance(const qint64 index)
+{
+    if (index <= m_head)
+        return;
+
+    for (auto i = qMax(m_head + 1, index - BUCKETS + 1); i <= index; ++i)
+        clearBucket(i);
+
+    m_head = index;
+}
+
+/**
+ * Empties the buckets of every field for the time slice with the given @a index
+ */
+void TelemetryPlot::clearBucket(const qint64 index)
+{
+    for (int i = 0; i < MAX_CHANNELS; ++i)
+    {
+        auto &slice = bucket(i, index);
+        slice.minimum = EMPTY;
+        slice.maximum = -EMPTY;
+    }
+}
+
+/**
+ * Returns the bucket of the given @a channel for the time slice with the given
+ * @a index, buckets are reused once the time slice is out of the window.
+ */
+TelemetryPlot::Bucket &TelemetryPlot::bucket(const int channel, const qint64 index)
+{
+    const auto slot = int(((index % BUCKETS) + BUCKETS) % BUCKETS);
+    return m_buckets[channel * BUCKETS + slot];
+}
+
+/**
+ * Returns the bucket of the given @a channel for the time slice with the given
+ * @a index (read-only)
+ */
+const TelemetryPlot::Bucket &TelemetryPlot::bucket(const int channel,
+                                                   const qint64 index) const
+{
+    const auto slot = int(((index % BUCKETS) + BUCKETS) % BUCKETS);
+    return m_buckets[channel * BUCKETS + slot];
+}
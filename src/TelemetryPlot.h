@@ -0,0 +1,100 @@
+/*
+ * Copyright (c) 2022 Alex Spataru <https://github.com/alex-spataru>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <QTimer>
+#include <QLineF>
+#include <QElapsedTimer>
+#include <QVector>
+#include <QWidget>
+
+#include "TelemetryParser.h"
+
+/**
+ * @brief The TelemetryPlot class
+ *
+ * Plots the first fields of the telemetry record over a sliding time window, each
+ * field in its own lane with its own vertical scale.
+ *
+ * Samples are not stored individually: the window is split into a fixed number of
+ * time buckets per field, kept in a ring buffer, and each bucket only keeps the
+ * minimum & maximum value received during its time slice. Painting then reduces the
+ * buckets to one vertical line per pixel column. Memory usage is therefore bounded
+ * regardless of the session length, and both memory & painting cost are the same for
+ * 10 Hz or 10 kHz telemetry, without hiding short spikes.
+ *
+ * The window keeps moving with the clock of the telemetry between records, so that
+ * a stalled device shows up as an empty gap at the right of the plot.
+ */
+class TelemetryPlot : public QWidget
+{
+    Q_OBJECT
+
+public:
+    static const int BUCKETS = 1024;
+    static const int MAX_CHANNELS = 8;
+
+    explicit TelemetryPlot(QWidget *parent = nullptr);
+
+    int window() const;
+    int refreshRate() const;
+    QSize sizeHint() const override;
+
+public Q_SLOTS:
+    void clear();
+    void setWindow(const int msec);
+    void setRefreshRate(const int hz);
+    void append(const TelemetryParser::Record &record);
+
+protected:
+    void paintEvent(QPaintEvent *event) override;
+
+private Q_SLOTS:
+    void refresh();
+
+private:
+    struct Bucket
+    {
+        double minimum;
+        double maximum;
+    };
+
+    void advance(const qint64 index);
+    void clearBucket(const qint64 index);
+    Bucket &bucket(const int channel, const qint64 index);
+    const Bucket &bucket(const int channel, const qint64 index) const;
+
+private:
+    bool m_dirty;
+    int m_window;
+    int m_channels;
+    qint64 m_head;
+    qint64 m_offset;
+    qint64 m_bucketDuration;
+    double m_values[MAX_CHANNELS];
+
+    QTimer m_timer;
+    QElapsedTimer m_clock;
+    QVector<QLineF> m_lines;
+    QVector<Bucket> m_buckets;
+};
@@ -0,0 +1,271 @@
+/*
+ * Copyright (c) 2022 Alex Spataru <https://github.com/alex-spataru>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "TimingStats.h"
+
+#include <QFile>
+#include <QTextStream>
+#include <QtAlgorithms>
+
+#include <limits>
+
+/**
+ * Deviations below this limit get one bucket each, larger deviations are grouped in
+ * @c SUB_BUCKETS buckets per power of two (about 6% resolution).
+ */
+static const int SUB_BUCKET_BITS = 4;
+static const int SUB_BUCKETS = 1 << SUB_BUCKET_BITS;
+static const int LINEAR_BUCKETS = 2 * SUB_BUCKETS;
+
+/**
+ * Largest deviation that can be recorded (about 35 minutes), larger values are clamped
+ */
+static const qint64 MAX_VALUE = (Q_INT64_C(1) << 31) - 1;
+
+/**
+ * Number of buckets needed to cover deviations up to @c MAX_VALUE, the histogram uses
+ * one set of buckets for early frames and another one for late frames.
+ */
+static const int HALF_BUCKETS = LINEAR_BUCKETS + (31 - SUB_BUCKET_BITS - 1) * SUB_BUCKETS;
+static const int BUCKET_COUNT = 2 * HALF_BUCKETS;
+
+/**
+ * Returns the bucket that stores the given (positive) deviation @a value
+ */
+static int magnitudeIndex(const qint64 value)
+{
+    if (value < LINEAR_BUCKETS)
+        return static_cast<int>(value);
+
+    const int msb = 63 - qCountLeadingZeroBits(static_cast<quint64>(value));
+    const int sub = (value >> (msb - SUB_BUCKET_BITS)) & (SUB_BUCKETS - 1);
+    return LINEAR_BUCKETS + (msb - SUB_BUCKET_BITS - 1) * SUB_BUCKETS + sub;
+}
+
+/**
+ * Returns the smallest deviation stored in the bucket with the given @a index
+ */
+static qint64 magnitudeLowerBound(const int index)
+{
+    if (index < LINEAR_BUCKETS)
+        return index;
+
+    const int msb = (index - LINEAR_BUCKETS) / SUB_BUCKETS + SUB_BUCKET_BITS + 1;
+    const int sub = (index - LINEAR_BUCKETS) % SUB_BUCKETS;
+    return static_cast<qint64>(SUB_BUCKETS + sub) << (msb - SUB_BUCKET_BITS);
+}
+
+/**
+ * Returns the largest deviation stored in the bucket with the given @a index
+ */
+static qint64 magnitudeUpperBound(const int index)
+{
+    if (index < LINEAR_BUCKETS)
+        return index;
+
+    return magnitudeLowerBound(index + 1) - 1;
+}
+
+/**
+ * Constructor function
+ */
+TimingStats::TimingStats()
+{
+    m_buckets.resize(BUCKET_COUNT);
+    reset(0);
+}
+
+/**
+ * Returns the min/avg/p99/max intervals recorded since the last call to @c reset()
+ */
+TimingStats::Summary TimingStats::summary() const
+{
+    QMutexLocker locker(&m_mutex);
+
+    Summary summary;
+    summary.count = m_count;
+    summary.target = m_target;
+    summary.minimum = m_count > 0 ? m_minimum : 0;
+    summary.maximum = m_maximum;
+    summary.average = m_count > 0 ? m_sum / m_count : 0;
+    summary.p99 = 0;
+    summary.overruns = m_overruns;
+
+    // Find the bucket that contains the 99th percentile
+    const quint64 rank = m_count - m_count / 100;
+    quint64 seen = 0;
+    for (int i = 0; i < m_buckets.count() && m_count > 0; ++i)
+    {
+        seen += m_buckets.at(i);
+        if (seen >= rank)
+        {
+            summary.p99 = qMin(m_target + bucketUpperBound(i), m_maximum);
+            break;
+        }
+    }
+
+    return summary;
+}
+
+/**
+ * Returns a human-readable summary, e.g.
+ * "period 250.00 ms: min 249.91 / avg 250.00 / p99 250.13 / max 251.02 ms (1200 frames)"
+ */
+QString TimingStats::toString() const
+{
+    const auto s = summary();
+    if (s.count == 0)
+        return QString("period %1 ms: no frames sent").arg(s.target / 1000.0, 0, 'f', 2);
+
+    // clang-format off
+    return QString("period %1 ms: min %2 / avg %3 / p99 %4 / max %5 ms "
+                   "(%6 frames, %7 overruns)")
+        .arg(s.target / 1000.0, 0, 'f', 3)
+        .arg(s.minimum / 1000.0, 0, 'f', 3)
+        .arg(s.average / 1000.0, 0, 'f', 3)
+        .arg(s.p99 / 1000.0, 0, 'f', 3)
+        .arg(s.maximum / 1000.0, 0, 'f', 3)
+        .arg(s.count)
+        .arg(s.overruns);
+    // clang-format on
+}
+
+/**
+ * Returns the non-empty buckets of the histogram, sorted from the shortest to the
+ * longest intervals. Bucket limits are given in microseconds.
+ */
+QVector<TimingStats::Bucket> TimingStats::histogram() const
+{
+    QMutexLocker locker(&m_mutex);
+
+    QVector<Bucket> buckets;
+    for (int i = 0; i < m_buckets.count(); ++i)
+    {
+        if (m_buckets.at(i) == 0)
+            continue;
+
+        Bucket bucket;
+        bucket.minimum = i > 0 ? m_target + bucketUpperBound(i - 1) + 1 : 0;
+        bucket.minimum = qMax<qint64>(0, bucket.minimum);
+        bucket.maximum = m_target + bucketUpperBound(i);
+        bucket.count = m_buckets.at(i);
+        buckets.append(bucket);
+    }
+
+    return buckets;
+}
+
+/**
+ * Writes the histogram to the CSV file at the given @a path, with one line per
+ * non-empty bucket ("min_us,max_us,count").
+ */
+bool TimingStats::exportCsv(const QString &path, QString *error) const
+{
+    QFile file(path);
+    if (!file.open(QFile::WriteOnly | QFile::Truncate | QFile::Text))
+    {
+        if (error)
+            *error = file.errorString();
+
+        return false;
+    }
+
+    const auto s = summary();
+    const auto buckets = histogram();
+
+    QTextStream stream(&file);
+    stream << "# " << toString() << "\n";
+    stream << "min_us,max_us,count\n";
+    for (int i = 0; i < buckets.count(); ++i)
+    {
+        const auto &bucket = buckets.at(i);
+        const auto minimum = qMax(bucket.minimum, s.minimum);
+        const auto maximum = qMin(bucket.maximum, s.maximum);
+        stream << minimum << ',' << maximum << ',' << bucket.count << '\n';
+    }
+
+    return true;
+}
+
+/**
+ * Clears all samples and sets the expected interval to @a targetUs microseconds
+ */
+void TimingStats::reset(const qint64 targetUs)
+{
+    QMutexLocker locker(&m_mutex);
+
+    m_count = 0;
+    m_overruns = 0;
+    m_sum = 0;
+    m_minimum = std::numeric_limits<qint64>::max();
+    m_maximum = 0;
+    m_target = targetUs;
+    m_buckets.fill(0);
+}
+
+/**
+ * Registers a period in which the deadline was missed by more than one interval
+ */
+void TimingStats::addOverrun()
+{
+    QMutexLocker locker(&m_mutex);
+    ++m_overruns;
+}
+
+/**
+ * Registers the time (in microseconds) elapsed between two consecutive frames
+ */
+void TimingStats::addSample(const qint64 intervalUs)
+{
+    QMutexLocker locker(&m_mutex);
+
+    const auto deviation = qBound(-MAX_VALUE, intervalUs - m_target, MAX_VALUE);
+    ++m_buckets[bucketIndex(deviation)];
+
+    ++m_count;
+    m_sum += intervalUs;
+    m_minimum = qMin(m_minimum, intervalUs);
+    m_maximum = qMax(m_maximum, intervalUs);
+}
+
+/**
+ * Returns the histogram bucket for the given deviation from the target interval,
+ * buckets are sorted from the earliest to the latest frames.
+ */
+int TimingStats::bucketIndex(const qint64 deviation)
+{
+    if (deviation < 0)
+        return HALF_BUCKETS - magnitudeIndex(-deviation);
+
+    return HALF_BUCKETS + magnitudeIndex(deviation);
+}
+
+/**
+ * Returns the largest deviation that is stored in the bucket with the given @a index
+ */
+qint64 TimingStats::bucketUpperBound(const int index)
+{
+    if (index < HALF_BUCKETS)
+        return -magnitudeLowerBound(HALF_BUCKETS - index);
+
+    return magnitudeUpperBound(index - HALF_BUCKETS);
+}
@@ -0,0 +1,89 @@
+/*
+ * Copyright (c) 2022 Alex Spataru <https://github.com/alex-spataru>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <QMutex>
+#include <QString>
+#include <QVector>
+
+/**
+ * @brief The TimingStats class
+ *
+ * Collects the intervals (in microseconds) between consecutive command frames and
+ * summarizes them as min/avg/p99/max values, so that the period jitter of the send
+ * loop can be verified while the application runs. The full histogram can be queried
+ * or exported to a CSV file.
+ *
+ * Each sample is stored as its deviation from the target interval in a fixed
+ * log-linear histogram (16 buckets per power of two, for early & late frames), so
+ * adding a sample never allocates memory and the resolution of the percentiles scales
+ * with the jitter itself (about 6%). All functions are thread-safe.
+ */
+class TimingStats
+{
+public:
+    struct Summary
+    {
+        quint64 count;
+        qint64 target;
+        qint64 minimum;
+        qint64 maximum;
+        qint64 p99;
+        double average;
+        quint64 overruns;
+    };
+
+    struct Bucket
+    {
+        qint64 minimum;
+        qint64 maximum;
+        quint64 count;
+    };
+
+    TimingStats();
+
+    Summary summary() const;
+    QString toString() const;
+    QVector<Bucket> histogram() const;
+    bool exportCsv(const QString &path, QString *error = nullptr) const;
+
+    void reset(const qint64 targetUs);
+    void addOverrun();
+    void addSample(const qint64 intervalUs);
+
+private:
+    static int bucketIndex(const qint64 deviation);
+    static qint64 bucketUpperBound(const int index);
+
+private:
+    mutable QMutex m_mutex;
+
+    quint64 m_count;
+    quint64 m_overruns;
+    qint64 m_target;
+    qint64 m_minimum;
+    qint64 m_maximum;
+    double m_sum;
+
+    QVector<quint64> m_buckets;
+};
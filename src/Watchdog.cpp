@@ -0,0 +1,286 @@
+/*
+ * Copyright (c) 2022 Alex Spataru <https://github.com/alex-spataru>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "Watchdog.h"
+#include "Bridge.h"
+#include "Serial.h"
+
+#include <cstring>
+
+/**
+ * Time between each check of the deadlines, in milliseconds
+ */
+static const int CHECK_INTERVAL = 5;
+
+/**
+ * Constructor function, only the loss of the joystick is detected by default & the
+ * failsafe frames are sent at 50 Hz.
+ */
+Watchdog::Watchdog()
+    : m_tripped(false)
+    , m_wasAttached(false)
+    , m_reason(None)
+    , m_rxTimeout(0)
+    , m_inputTimeout(0)
+    , m_failsafeRate(50)
+    , m_lastRx(-1)
+    , m_lastInput(-1)
+{
+    resetStats();
+
+    // Make sure that the bridge reacts to joystick changes before the watchdog
+    Bridge::instance();
+
+    // clang-format off
+    connect(&Serial::instance(), &Serial::dataReceived,
+            this, &Watchdog::onDataReceived);
+    connect(&Serial::instance(), &Serial::autoBaudChanged,
+            this, &Watchdog::onDataReceived);
+    connect(QJoysticks::getInstance(), &QJoysticks::countChanged,
+            this, &Watchdog::check);
+    connect(&Bridge::instance(), &Bridge::joystickChanged,
+            this, &Watchdog::check);
+    connect(&Bridge::instance(), &Bridge::channelsChanged,
+            this, &Watchdog::check);
+    // clang-format on
+
+    m_clock.start();
+    m_timer.setTimerType(Qt::PreciseTimer);
+    connect(&m_timer, &QTimer::timeout, this, &Watchdog::check);
+    m_timer.start(CHECK_INTERVAL);
+
+    // Input events are received as batches, without a signal for each event
+    QJoysticks::getInstance()->addListener(this);
+}
+
+/**
+ * Destructor function, stops receiving joystick input
+ */
+Watchdog::~Watchdog()
+{
+    QJoysticks::getInstance()->removeListener(this);
+}
+
+/**
+ * Returns the only instance of the class
+ */
+Watchdog &Watchdog::instance()
+{
+    static Watchdog singleton;
+    return singleton;
+}
+
+/**
+ * Returns @c true if the bridge is in failsafe mode because of the watchdog
+ */
+bool Watchdog::tripped() const
+{
+    return m_tripped;
+}
+
+/**
+ * Returns the failure that caused the current failsafe mode
+ */
+Watchdog::Reason Watchdog::reason() const
+{
+    return m_reason;
+}
+
+/**
+ * Returns the number of trips & the time (in microseconds) from the failure (the
+ * expiration of the deadline or the loss of the joystick) until the failsafe frame was
+ * written.
+ */
+Watchdog::Stats Watchdog::stats() const
+{
+    return m_stats;
+}
+
+/**
+ * Returns the maximum time without data from the device (in milliseconds), 0 if the
+ * RX deadline is disabled.
+ */
+int Watchdog::rxTimeout() const
+{
+    return m_rxTimeout;
+}
+
+/**
+ * Returns the maximum time without input events (in milliseconds), 0 if the input
+ * deadline is disabled.
+ */
+int Watchdog::inputTimeout() const
+{
+    return m_inputTimeout;
+}
+
+/**
+ * Returns the minimum number of failsafe frames sent per second
+ */
+int Watchdog::failsafeRate() const
+{
+    return m_failsafeRate;
+}
+
+/**
+ * Checks every condition, and enters or leaves the failsafe mode accordingly
+ */
+void Watchdog::check()
+{
+    const auto attached = Bridge::instance().inputAttached();
+    const auto now = currentTime();
+
+    // The joystick is lost when it is detected, the deadlines expire before the check
+    auto reason = None;
+    auto failure = now;
+    if ((m_wasAttached && !attached) || Bridge::instance().inputLost())
+        reason = InputLost;
+    else if (m_inputTimeout > 0 && m_lastInput >= 0
+             && now - m_lastInput > m_inputTimeout * 1000)
+    {
+        reason = InputTimeout;
+        failure = m_lastInput + m_inputTimeout * 1000;
+    }
+    else if (m_rxTimeout > 0 && m_lastRx >= 0 && now - m_lastRx > m_rxTimeout * 1000
+             && !Serial::instance().isDetectingBaudRate())
+    {
+        reason = RxTimeout;
+        failure = m_lastRx + m_rxTimeout * 1000;
+    }
+
+    if (attached)
+        m_wasAttached = true;
+
+    if (reason != None && !m_tripped)
+        trip(reason, failure);
+    else if (reason == None && m_tripped)
+        recover();
+}
+
+/**
+ * Clears the trip counters & latency measurements
+ */
+void Watchdog::resetStats()
+{
+    memset(&m_stats, 0, sizeof(m_stats));
+}
+
+/**
+ * Changes the maximum time without data from the device, 0 disables the RX deadline
+ */
+void Watchdog::setRxTimeout(const int msec)
+{
+    m_rxTimeout = qMax(0, msec);
+    m_lastRx = -1;
+    Q_EMIT configurationChanged();
+}
+
+/**
+ * Changes the maximum time without input events, 0 disables the input deadline
+ */
+void Watchdog::setInputTimeout(const int msec)
+{
+    m_inputTimeout = qMax(0, msec);
+    m_lastInput = -1;
+    Q_EMIT configurationChanged();
+}
+
+/**
+ * Changes the minimum number of failsafe frames sent per second
+ */
+void Watchdog::setFailsafeRate(const int hz)
+{
+    m_failsafeRate = qBound(1, hz, int(Scheduler::MAX_RATE));
+    Q_EMIT configurationChanged();
+}
+
+/**
+ * Registers the time of the last axis or button event of the given batch of @a events
+ */
+void Watchdog::joystickEvents(const QJoystickEvent *events, const int count)
+{
+    if (m_inputTimeout <= 0)
+        return;
+
+    for (int i = 0; i < count; ++i)
+    {
+        if (events[i].type != QJoystickEvent::POVEvent)
+        {
+            m_lastInput = currentTime();
+            return;
+        }
+    }
+}
+
+/**
+ * Registers the time of the last data received from the device. The RX deadline also
+ * starts again after a baud rate detection, during which no data is forwarded.
+ */
+void Watchdog::onDataReceived()
+{
+    if (m_rxTimeout > 0)
+        m_lastRx = currentTime();
+}
+
+/**
+ * Returns the time of the watchdog clock, in microseconds
+ */
+qint64 Watchdog::currentTime() const
+{
+    return m_clock.nsecsElapsed() / 1000;
+}
+
+/**
+ * Puts the bridge in failsafe mode because of the given @a reason & records the time
+ * from the @a failure (in microseconds of the watchdog clock) until the first failsafe
+ * frame was written. This includes the delay until the check that detected it.
+ */
+void Watchdog::trip(const Reason reason, const qint64 failure)
+{
+    Bridge::instance().setFailsafe(true, m_failsafeRate);
+
+    const auto elapsed = qMax<qint64>(0, currentTime() - failure);
+    m_stats.lastLatency = elapsed;
+    m_stats.maximumLatency = qMax(m_stats.maximumLatency, elapsed);
+
+    ++m_stats.trips;
+    if (reason == RxTimeout)
+        ++m_stats.rxTrips;
+    else
+        ++m_stats.inputTrips;
+
+    m_tripped = true;
+    m_reason = reason;
+    Q_EMIT trippedChanged();
+}
+
+/**
+ * Leaves the failsafe mode once every condition is healthy again
+ */
+void Watchdog::recover()
+{
+    Bridge::instance().setFailsafe(false, 0);
+
+    m_tripped = false;
+    m_reason = None;
+    Q_EMIT trippedChanged();
+}
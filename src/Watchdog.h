@@ -0,0 +1,127 @@
+/*
+ * Copyright (c) 2022 Alex Spataru <https://github.com/alex-spataru>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <QTimer>
+#include <QObject>
+#include <QElapsedTimer>
+
+#include "QJoysticks.h"
+
+/**
+ * @brief The Watchdog class
+ *
+ * Monitors the health of the link & of the joystick input, and puts the @c Bridge in
+ * failsafe mode (neutral values sent at a high rate) when one of them fails:
+ *
+ * - A joystick that drives the outputs was attached & is no longer available, even if
+ *   other joysticks are still attached.
+ * - No input event was received within the input deadline (only useful for devices
+ *   that report their state continuously, disabled by default).
+ * - No data was received from the device within the RX deadline, once the device has
+ *   started to send data (disabled by default).
+ *
+ * The failsafe mode is left as soon as every condition is healthy again. The time from
+ * the failure (the expiration of the deadline or the loss of the joystick) until the
+ * first failsafe frame has been written is recorded for each trip.
+ *
+ * This class lives in the main thread.
+ */
+class Watchdog : public QObject, private QJoystickListener
+{
+    Q_OBJECT
+
+public:
+    enum Reason
+    {
+        None,
+        InputLost,
+        InputTimeout,
+        RxTimeout
+    };
+    Q_ENUM(Reason)
+
+    struct Stats
+    {
+        quint64 trips;
+        quint64 inputTrips;
+        quint64 rxTrips;
+        qint64 lastLatency;
+        qint64 maximumLatency;
+    };
+
+Q_SIGNALS:
+    void trippedChanged();
+    void configurationChanged();
+
+private:
+    explicit Watchdog();
+    ~Watchdog();
+    Watchdog(Watchdog &&) = delete;
+    Watchdog(const Watchdog &) = delete;
+    Watchdog &operator=(Watchdog &&) = delete;
+    Watchdog &operator=(const Watchdog &) = delete;
+
+public:
+    static Watchdog &instance();
+
+    bool tripped() const;
+    Reason reason() const;
+    Stats stats() const;
+
+    int rxTimeout() const;
+    int inputTimeout() const;
+    int failsafeRate() const;
+
+public Q_SLOTS:
+    void check();
+    void resetStats();
+    void setRxTimeout(const int msec);
+    void setInputTimeout(const int msec);
+    void setFailsafeRate(const int hz);
+
+private Q_SLOTS:
+    void onDataReceived();
+
+private:
+    void joystickEvents(const QJoystickEvent *events, const int count) override;
+
+    qint64 currentTime() const;
+    void trip(const Reason reason, const qint64 failure);
+    void recover();
+
+private:
+    bool m_tripped;
+    bool m_wasAttached;
+    Reason m_reason;
+
+    int m_rxTimeout;
+    int m_inputTimeout;
+    int m_failsafeRate;
+    qint64 m_lastRx;
+    qint64 m_lastInput;
+
+    Stats m_stats;
+    QTimer m_timer;
+    QElapsedTimer m_clock;
+};
@@ -20,20 +20,63 @@
  * THE SOFTWARE.
  */
 
-#include <QApplication>
+#include <QCoreApplication>
 #include <QJoysticks.h>
 
-#include "MainWindow.h"
+#include "Bridge.h"
+#include "Headless.h"
+
+#ifndef HEADLESS_BUILD
+#    include <QApplication>
+#    include "MainWindow.h"
+#endif
+
+/**
+ * Returns @c true if the application should run without user interface
+ */
+static bool headlessMode(int argc, char **argv)
+{
+#ifdef HEADLESS_BUILD
+    Q_UNUSED(argc);
+    Q_UNUSED(argv);
+    return true;
+#else
+    for (int i = 1; i < argc; ++i)
+    {
+        if (qstrcmp(argv[i], "--headless") == 0)
+            return true;
+    }
+
+    return false;
+#endif
+}
 
 int main(int argc, char **argv)
 {
+    // Run the pipeline without loading the widget stack
+    if (headlessMode(argc, argv))
+    {
+        QCoreApplication app(argc, argv);
+
+        Headless headless;
+        if (!headless.configure(app.arguments()))
+            return EXIT_FAILURE;
+
+        return app.exec();
+    }
+
+#ifndef HEADLESS_BUILD
     QApplication app(argc, argv);
 
     auto instance = QJoysticks::getInstance();
     (void)instance;
 
+    auto bridge = &Bridge::instance();
+    (void)bridge;
+
     MainWindow window;
     window.show();
 
     return app.exec();
+#endif
 }
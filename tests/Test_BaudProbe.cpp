@@ -0,0 +1,158 @@
+/*
+ * Copyright (c) 2022 Alex Spataru <https://github.com/alex-spataru>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "Test_BaudProbe.h"
+#include "Test_Telemetry.h"
+#include "BaudProbe.h"
+
+#include <QTest>
+
+/**
+ * Passes the given @a data to the @a probe in a single chunk
+ */
+static void append(BaudProbe &probe, const QByteArray &data)
+{
+    probe.append(data.constData(), data.size());
+}
+
+void Test_BaudProbe::textLines()
+{
+    BaudProbe probe;
+
+    // The first line may have been cut, it is never scored
+    append(probe, "5,6\n1,2\n");
+    QCOMPARE(probe.score().lines, 1);
+    QCOMPARE(probe.score().validLines, 1);
+    QVERIFY(!probe.accepted());
+
+    append(probe, "3,4\r\n");
+    QCOMPARE(probe.score().validLines, int(BaudProbe::MIN_VALID));
+    QCOMPARE(probe.score().bytes, quint64(13));
+    QVERIFY(probe.accepted());
+}
+
+void Test_BaudProbe::controlLines()
+{
+    BaudProbe probe;
+
+    append(probe, "A3#\n#A12\n#N13\n");
+    QCOMPARE(probe.score().lines, 2);
+    QCOMPARE(probe.score().validLines, 2);
+    QVERIFY(probe.accepted());
+}
+
+void Test_BaudProbe::invalidLines()
+{
+    BaudProbe probe;
+
+    // One invalid line for every four valid ones at most
+    append(probe, "x\n1,2\n3,4\n\xF3\x81\xFE\n5,6\n7,8\n");
+    QCOMPARE(probe.score().lines, 5);
+    QCOMPARE(probe.score().validLines, 4);
+    QVERIFY(probe.accepted());
+
+    append(probe, "1,x\n");
+    QCOMPARE(probe.score().validLines, 4);
+    QVERIFY(!probe.accepted());
+
+    // Printable text that is not telemetry is not valid either
+    probe.clear();
+    append(probe, "x\nhello\nworld\n1,2\n3,4\n");
+    QCOMPARE(probe.score().validLines, 2);
+    QVERIFY(!probe.accepted());
+}
+
+void Test_BaudProbe::oversizedLines()
+{
+    BaudProbe probe;
+
+    append(probe, "x\n1,2\n3,4\n5,6\n7,8\n");
+    QVERIFY(probe.accepted());
+
+    // Lines that do not fit in the buffer count as invalid lines
+    append(probe, QByteArray(300, '1') + "\n");
+    QVERIFY(probe.accepted());
+    append(probe, QByteArray(300, '1') + "\n");
+    QVERIFY(!probe.accepted());
+}
+
+void Test_BaudProbe::binaryFrames()
+{
+    BaudProbe probe;
+
+    const auto frame = Test_Telemetry::binaryFrame({ 1, 2 });
+    auto corrupted = frame;
+    corrupted[3] = char(corrupted.at(3) ^ 0x01);
+
+    append(probe, frame);
+    QVERIFY(!probe.accepted());
+    append(probe, frame);
+    QCOMPARE(probe.score().frames, 2);
+    QVERIFY(probe.accepted());
+
+    append(probe, corrupted);
+    QCOMPARE(probe.score().invalidFrames, 1);
+    QVERIFY(!probe.accepted());
+
+    append(probe, frame + frame);
+    QCOMPARE(probe.score().frames, 4);
+    QVERIFY(probe.accepted());
+}
+
+void Test_BaudProbe::noise()
+{
+    BaudProbe probe;
+
+    // Bytes received at a wrong rate, without any sync byte
+    QByteArray data;
+    for (int i = 0; i < 4096; ++i)
+    {
+        if (i % 16 == 15)
+            data.append('\n');
+        else
+            data.append(char(0x80 + (i * 37) % 0x20));
+    }
+
+    append(probe, data);
+    QVERIFY(probe.score().lines > 200);
+    QCOMPARE(probe.score().validLines, 0);
+    QCOMPARE(probe.score().frames, 0);
+    QVERIFY(!probe.accepted());
+}
+
+void Test_BaudProbe::clear()
+{
+    BaudProbe probe;
+
+    append(probe, "x\n1,2\n3,4\n5,");
+    QVERIFY(probe.accepted());
+
+    // The incomplete line & the first line after clear() are not scored
+    probe.clear();
+    QCOMPARE(probe.score().bytes, quint64(0));
+    QCOMPARE(probe.score().lines, 0);
+    QVERIFY(!probe.accepted());
+
+    append(probe, "6\n7,8\n");
+    QCOMPARE(probe.score().lines, 1);
+    QCOMPARE(probe.score().validLines, 1);
+}
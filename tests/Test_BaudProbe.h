@@ -0,0 +1,47 @@
+/*
+ * Copyright (c) 2022 Alex Spataru <https://github.com/alex-spataru>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <QObject>
+
+/**
+ * @brief The Test_BaudProbe class
+ *
+ * Checks the scoring of the bytes received at a candidate baud rate: text telemetry &
+ * control lines are accepted once enough valid lines have been received, the first
+ * (possibly cut) line is ignored, and non-printable characters, lines that are too
+ * long & binary frames with a bad checksum count against the rate.
+ */
+class Test_BaudProbe : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void textLines();
+    void controlLines();
+    void invalidLines();
+    void oversizedLines();
+    void binaryFrames();
+    void noise();
+    void clear();
+};
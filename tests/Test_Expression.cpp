@@ -0,0 +1,179 @@
+/*
+ * Copyright (c) 2022 Alex Spataru <https://github.com/alex-spataru>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "Test_Expression.h"
+#include "Expression.h"
+
+#include <QTest>
+#include <QDebug>
+
+/**
+ * Compiles & evaluates @a source once with the given joystick state, the outputs of
+ * the profile are called "speed" & "angle".
+ */
+static double evaluate(const QString &source, const QVector<double> &axes = {},
+                       const QVector<double> &buttons = {},
+                       const QVector<double> &outputs = {})
+{
+    Expression expression;
+    QString error;
+    const auto names = QStringList() << "speed" << "angle";
+    if (!expression.compile(source, names, &error))
+    {
+        qWarning() << source << "-" << error;
+        return qQNaN();
+    }
+
+    QVector<double> registers(Expression::MAX_REGISTERS);
+    QVector<double> memory(Expression::MAX_REGISTERS);
+    expression.initialize(registers.data(), memory.data());
+
+    Expression::Inputs inputs;
+    inputs.axes = axes.constData();
+    inputs.axisCount = axes.count();
+    inputs.buttons = buttons.constData();
+    inputs.buttonCount = buttons.count();
+    inputs.outputs = outputs.constData();
+    inputs.outputCount = outputs.count();
+    return expression.evaluate(inputs, registers.data(), memory.data());
+}
+
+void Test_Expression::arithmetic_data()
+{
+    QTest::addColumn<QString>("source");
+    QTest::addColumn<double>("result");
+
+    QTest::newRow("precedence") << "1 + 2 * 3" << 7.0;
+    QTest::newRow("parentheses") << "(1 + 2) * 3" << 9.0;
+    QTest::newRow("negative") << "-2 * -3" << 6.0;
+    QTest::newRow("modulo") << "7 % 4" << 3.0;
+    QTest::newRow("exponent") << "1.5e2" << 150.0;
+    QTest::newRow("comparison") << "2 < 3 && 3 <= 3" << 1.0;
+    QTest::newRow("logical") << "!(1 || 0)" << 0.0;
+    QTest::newRow("conditional") << "0 ? 1 : 2 ? 3 : 4" << 3.0;
+    QTest::newRow("min max") << "min(3, max(1, 2))" << 2.0;
+    QTest::newRow("clamp") << "clamp(25, -20, 20)" << 20.0;
+    QTest::newRow("abs") << "abs(-4)" << 4.0;
+    QTest::newRow("deadzone") << "deadzone(0.05, 0.1) + deadzone(0.5, 0.1)" << 0.5;
+}
+
+void Test_Expression::arithmetic()
+{
+    QFETCH(QString, source);
+    QFETCH(double, result);
+
+    QCOMPARE(evaluate(source), result);
+}
+
+void Test_Expression::inputs()
+{
+    const QVector<double> axes = { 0.5, -1 };
+    const QVector<double> buttons = { 0, 1 };
+    const QVector<double> outputs = { 10, 90 };
+
+    QCOMPARE(evaluate("axis1 * 20 + axis0", axes), -19.5);
+    QCOMPARE(evaluate("button1 ? angle : speed", axes, buttons, outputs), 90.0);
+    QCOMPARE(evaluate("speed + 1", axes, buttons, outputs), 11.0);
+
+    // Inputs that the joystick does not have read as 0
+    QCOMPARE(evaluate("axis7 + button9 + 1", axes, buttons), 1.0);
+    QCOMPARE(evaluate("speed", axes, buttons), 0.0);
+}
+
+void Test_Expression::malformed_data()
+{
+    QTest::addColumn<QString>("source");
+
+    QTest::newRow("empty") << "";
+    QTest::newRow("missing operand") << "1 +";
+    QTest::newRow("unbalanced") << "(1 + 2";
+    QTest::newRow("extra parenthesis") << "1 + 2)";
+    QTest::newRow("missing else") << "button0 ? 1";
+    QTest::newRow("two operands") << "axis0 axis1";
+    QTest::newRow("unknown character") << "1 $ 2";
+    QTest::newRow("unknown variable") << "throttle";
+    QTest::newRow("input out of range") << "axis300";
+    QTest::newRow("unknown function") << "sqrt(4)";
+    QTest::newRow("missing argument") << "min(1)";
+    QTest::newRow("extra argument") << "abs(1, 2)";
+    QTest::newRow("unclosed call") << "max(1, 2";
+}
+
+void Test_Expression::malformed()
+{
+    QFETCH(QString, source);
+
+    Expression expression;
+    QVERIFY(expression.compile("axis0 * 2", QStringList()));
+    const auto program = expression.program().count();
+
+    QString error;
+    QVERIFY(!expression.compile(source, QStringList(), &error));
+    QVERIFY(!error.isEmpty());
+    QVERIFY(error.contains("position"));
+
+    // The previous program is kept
+    QCOMPARE(expression.program().count(), program);
+}
+
+void Test_Expression::divisionByZero()
+{
+    const QVector<double> axes = { 0 };
+
+    QCOMPARE(evaluate("5 / 0"), 0.0);
+    QCOMPARE(evaluate("5 % 0"), 0.0);
+    QCOMPARE(evaluate("1 / axis0", axes), 0.0);
+    QCOMPARE(evaluate("1 / axis3 + 2"), 2.0);
+    QCOMPARE(evaluate("-1 / 0 < 0"), 0.0);
+}
+
+void Test_Expression::rise()
+{
+    Expression expression;
+    QVERIFY(expression.compile("rise(button0) ? 1 - speed : speed",
+                               QStringList() << "speed"));
+    QCOMPARE(expression.memoryCount(), 1);
+
+    QVector<double> registers(expression.registerCount());
+    QVector<double> memory(expression.memoryCount());
+    expression.initialize(registers.data(), memory.data());
+
+    double button = 0;
+    double speed = 0;
+    Expression::Inputs inputs;
+    inputs.axes = nullptr;
+    inputs.axisCount = 0;
+    inputs.buttons = &button;
+    inputs.buttonCount = 1;
+    inputs.outputs = &speed;
+    inputs.outputCount = 1;
+
+    // Toggles once per press, holding the button does not toggle again
+    const double pressed[] = { 0, 1, 1, 0, 1, 0 };
+    const double expected[] = { 0, 1, 1, 1, 0, 0 };
+    for (int i = 0; i < 6; ++i)
+    {
+        button = pressed[i];
+        speed = expression.evaluate(inputs, registers.data(), memory.data());
+        QCOMPARE(speed, expected[i]);
+    }
+}
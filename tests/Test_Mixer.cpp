@@ -0,0 +1,173 @@
+/*
+ * Copyright (c) 2022 Alex Spataru <https://github.com/alex-spataru>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "Test_Mixer.h"
+#include "Mixer.h"
+
+#include <QTest>
+#include <QVector>
+
+/**
+ * Mixes the given @a axes & returns the value of every output of the @a mixer
+ */
+static QVector<float> mix(const Mixer &mixer, const QVector<double> &axes)
+{
+    float outputs[Mixer::MAX_OUTPUTS];
+    mixer.mix(axes.constData(), axes.count(), outputs);
+
+    QVector<float> values;
+    for (int i = 0; i < mixer.outputCount(); ++i)
+        values.append(outputs[i]);
+
+    return values;
+}
+
+/**
+ * Builds an arcade mixer: left = throttle + turn, right = throttle - turn, with the
+ * throttle on axis 1 & the turn on axis 0
+ */
+static Mixer arcadeMixer(const Mixer::Saturation saturation)
+{
+    Mixer mixer;
+    const auto throttle = mixer.addInput(1);
+    const auto turn = mixer.addInput(0);
+    const auto left = mixer.addOutput(0, saturation);
+    const auto right = mixer.addOutput(1, saturation);
+    mixer.setWeight(left, throttle, 1);
+    mixer.setWeight(left, turn, 1);
+    mixer.setWeight(right, throttle, 1);
+    mixer.setWeight(right, turn, -1);
+    return mixer;
+}
+
+void Test_Mixer::arcade()
+{
+    const auto mixer = arcadeMixer(Mixer::Normalize);
+    QCOMPARE(mixer.inputCount(), 2);
+    QCOMPARE(mixer.outputCount(), 2);
+    QCOMPARE(mixer.inputAxis(0), 1);
+    QCOMPARE(mixer.outputTarget(1), 1);
+    QCOMPARE(mixer.weight(1, 1), -1.0f);
+    QCOMPARE(mixer.saturation(0), Mixer::Normalize);
+
+    // Within range, the outputs are the plain sums
+    QCOMPARE(mix(mixer, { 0.25, 0.5 }), QVector<float>({ 0.75f, 0.25f }));
+    QCOMPARE(mix(mixer, { -0.5, 0.5 }), QVector<float>({ 0.0f, 1.0f }));
+    QCOMPARE(mix(mixer, { 1, 0 }), QVector<float>({ 1.0f, -1.0f }));
+    QCOMPARE(mix(mixer, { 0, 0 }), QVector<float>({ 0.0f, 0.0f }));
+}
+
+void Test_Mixer::mecanum()
+{
+    Mixer mixer;
+    const auto y = mixer.addInput(1);
+    const auto x = mixer.addInput(0);
+    const auto r = mixer.addInput(2);
+
+    // Front left, front right, rear left & rear right
+    const float weights[4][3] = { { 1, 1, 1 }, { 1, -1, -1 }, { 1, -1, 1 }, { 1, 1, -1 } };
+    for (int o = 0; o < 4; ++o)
+    {
+        const auto output = mixer.addOutput(o, Mixer::Normalize);
+        mixer.setWeight(output, y, weights[o][0]);
+        mixer.setWeight(output, x, weights[o][1]);
+        mixer.setWeight(output, r, weights[o][2]);
+    }
+
+    // Forward, strafe & rotation alone
+    QCOMPARE(mix(mixer, { 0, 1, 0 }), QVector<float>({ 1, 1, 1, 1 }));
+    QCOMPARE(mix(mixer, { 1, 0, 0 }), QVector<float>({ 1, -1, -1, 1 }));
+    QCOMPARE(mix(mixer, { 0, 0, 0.5 }), QVector<float>({ 0.5f, -0.5f, 0.5f, -0.5f }));
+
+    // Diagonal at full speed, normalized from 2 to 1
+    QCOMPARE(mix(mixer, { 1, 1, 0 }), QVector<float>({ 1, 0, 0, 1 }));
+
+    // Forward & rotation, the right wheels turn at a third of the speed of the left ones
+    QCOMPARE(mix(mixer, { 0, 1, 0.5 }), QVector<float>({ 1, 1.0f / 3, 1, 1.0f / 3 }));
+}
+
+void Test_Mixer::normalize()
+{
+    const auto mixer = arcadeMixer(Mixer::Normalize);
+
+    // Full throttle with half turn: 1.5 & 0.5 keep their 3:1 ratio
+    const auto values = mix(mixer, { 0.5, 1 });
+    QCOMPARE(values.at(0), 1.0f);
+    QCOMPARE(values.at(1), 1.0f / 3);
+
+    const auto reverse = mix(mixer, { -0.5, -1 });
+    QCOMPARE(reverse.at(0), -1.0f);
+    QCOMPARE(reverse.at(1), -1.0f / 3);
+}
+
+void Test_Mixer::clip()
+{
+    // Full throttle with half turn: 1.5 is clipped & the ratio is lost
+    const auto clipped = arcadeMixer(Mixer::Clip);
+    QCOMPARE(clipped.saturation(1), Mixer::Clip);
+    QCOMPARE(mix(clipped, { 0.5, 1 }), QVector<float>({ 1.0f, 0.5f }));
+    QCOMPARE(mix(clipped, { 0.5, -1 }), QVector<float>({ -0.5f, -1.0f }));
+
+    // Clipped outputs do not scale the normalized ones, and the other way around
+    Mixer mixed;
+    const auto input = mixed.addInput(0);
+    mixed.setWeight(mixed.addOutput(0, Mixer::Normalize), input, 2);
+    mixed.setWeight(mixed.addOutput(1, Mixer::Clip), input, 3);
+    mixed.setWeight(mixed.addOutput(2, Mixer::Normalize), input, 1);
+    QCOMPARE(mix(mixed, { 1 }), QVector<float>({ 1.0f, 1.0f, 0.5f }));
+    QCOMPARE(mix(mixed, { 0.25 }), QVector<float>({ 0.5f, 0.75f, 0.25f }));
+}
+
+void Test_Mixer::unsetAxes()
+{
+    const auto mixer = arcadeMixer(Mixer::Normalize);
+
+    // The throttle (axis 1) is not available & reads as 0
+    QCOMPARE(mix(mixer, { 0.5 }), QVector<float>({ 0.5f, -0.5f }));
+    QCOMPARE(mix(mixer, {}), QVector<float>({ 0.0f, 0.0f }));
+
+    // Outputs that are not driven by the mixer are 0
+    float outputs[Mixer::MAX_OUTPUTS];
+    const double axes[] = { 1, 1 };
+    mixer.mix(axes, 2, outputs);
+    for (int i = mixer.outputCount(); i < Mixer::MAX_OUTPUTS; ++i)
+        QCOMPARE(outputs[i], 0.0f);
+
+    // A mixer without outputs is empty
+    Mixer empty;
+    QVERIFY(empty.isEmpty());
+    QVERIFY(!mixer.isEmpty());
+}
+
+void Test_Mixer::capacity()
+{
+    Mixer mixer;
+    for (int i = 0; i < Mixer::MAX_INPUTS; ++i)
+        QCOMPARE(mixer.addInput(i), i);
+    for (int i = 0; i < Mixer::MAX_OUTPUTS; ++i)
+        QCOMPARE(mixer.addOutput(i, Mixer::Clip), i);
+
+    QCOMPARE(mixer.addInput(0), -1);
+    QCOMPARE(mixer.addOutput(0, Mixer::Clip), -1);
+    QCOMPARE(mixer.inputCount(), int(Mixer::MAX_INPUTS));
+    QCOMPARE(mixer.outputCount(), int(Mixer::MAX_OUTPUTS));
+}
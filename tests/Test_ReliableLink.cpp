@@ -0,0 +1,238 @@
+/*
+ * Copyright (c) 2022 Alex Spataru <https://github.com/alex-spataru>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "Test_ReliableLink.h"
+#include "ReliableLink.h"
+#include "Serial.h"
+
+#include <QTest>
+#include <QSignalSpy>
+
+/**
+ * Uses the recording driver for every test, without pending commands
+ */
+void Test_ReliableLink::init()
+{
+    auto &link = ReliableLink::instance();
+    link.setDriver(&m_device);
+    link.setEnabled(true);
+    link.reset();
+    m_device.times.clear();
+    m_device.frames.clear();
+}
+
+/**
+ * Gives the link back to the serial port, the recording driver is destroyed with
+ * the test case
+ */
+void Test_ReliableLink::cleanupTestCase()
+{
+    ReliableLink::instance().setEnabled(false);
+    ReliableLink::instance().setDriver(&Serial::instance());
+}
+
+void Test_ReliableLink::commandFrame()
+{
+    const auto sequence = ReliableLink::instance().send("STOP");
+    QVERIFY(sequence > 0);
+    QCOMPARE(m_device.frames.count(), 1);
+
+    // XOR of the bytes between '@' & '*'
+    const auto body = QByteArray::number(sequence) + ":STOP";
+    quint8 checksum = 0;
+    for (const auto byte : body)
+        checksum ^= static_cast<quint8>(byte);
+
+    const auto hex = QByteArray::number(checksum, 16).rightJustified(2, '0').toUpper();
+    const QByteArray expected = "@" + body + "*" + hex + "\n";
+    QCOMPARE(m_device.frames.first(), expected);
+    QCOMPARE(ReliableLink::instance().stats().pending, 1);
+}
+
+void Test_ReliableLink::acknowledgement()
+{
+    auto &link = ReliableLink::instance();
+    const auto first = link.send("A");
+    const auto second = link.send("B");
+    QCOMPARE(link.stats().pending, 2);
+
+    // Replies may arrive in any order, next to the telemetry
+    reply("1,2,3\n#A" + QByteArray::number(second) + "\r\n4,5,6\n");
+    QCOMPARE(link.stats().pending, 1);
+    QCOMPARE(link.stats().acknowledged, quint64(1));
+
+    reply("#A" + QByteArray::number(first) + "\n");
+    QCOMPARE(link.stats().pending, 0);
+    QCOMPARE(link.stats().acknowledged, quint64(2));
+    QCOMPARE(link.stats().retransmissions, quint64(0));
+    QVERIFY(link.stats().timeout > 0);
+}
+
+void Test_ReliableLink::splitReply()
+{
+    auto &link = ReliableLink::instance();
+    const auto sequence = QByteArray::number(link.send("STOP"));
+
+    // One byte at a time
+    const auto data = "#A" + sequence + "\n";
+    for (int i = 0; i < data.size(); ++i)
+    {
+        QCOMPARE(link.stats().acknowledged, quint64(0));
+        reply(data.mid(i, 1));
+    }
+
+    QCOMPARE(link.stats().acknowledged, quint64(1));
+    QCOMPARE(link.stats().pending, 0);
+}
+
+void Test_ReliableLink::wrongSequence()
+{
+    auto &link = ReliableLink::instance();
+    const auto sequence = link.send("STOP");
+
+    reply("#A" + QByteArray::number(sequence + 1) + "\n");
+    reply("#A" + QByteArray::number(sequence) + "0\n");
+    reply("#N" + QByteArray::number(sequence + 1) + "\n");
+    QCOMPARE(link.stats().pending, 1);
+    QCOMPARE(link.stats().acknowledged, quint64(0));
+    QCOMPARE(link.stats().rejected, quint64(0));
+    QCOMPARE(m_device.frames.count(), 1);
+
+    reply("#A" + QByteArray::number(sequence) + "\n");
+    QCOMPARE(link.stats().pending, 0);
+    QCOMPARE(link.stats().acknowledged, quint64(1));
+}
+
+void Test_ReliableLink::duplicateAcknowledgement()
+{
+    auto &link = ReliableLink::instance();
+    const auto sequence = QByteArray::number(link.send("STOP"));
+
+    reply("#A" + sequence + "\n#A" + sequence + "\n");
+    reply("#A" + sequence + "\n");
+    QCOMPARE(link.stats().acknowledged, quint64(1));
+    QCOMPARE(link.stats().pending, 0);
+    QCOMPARE(link.stats().sent, quint64(1));
+
+    // A late acknowledgement does not complete the next command
+    const auto next = link.send("GO");
+    reply("#A" + sequence + "\n");
+    QCOMPARE(link.stats().pending, 1);
+
+    reply("#A" + QByteArray::number(next) + "\n");
+    QCOMPARE(link.stats().acknowledged, quint64(2));
+}
+
+void Test_ReliableLink::malformedReplies_data()
+{
+    QTest::addColumn<QByteArray>("format");
+
+    QTest::newRow("no sequence") << QByteArray("#A\n");
+    QTest::newRow("unknown type") << QByteArray("#B%1\n");
+    QTest::newRow("lowercase") << QByteArray("#a%1\n");
+    QTest::newRow("trailing text") << QByteArray("#A%1x\n");
+    QTest::newRow("space") << QByteArray("#A %1\n");
+    QTest::newRow("not at line start") << QByteArray("12,#A%1\n");
+    QTest::newRow("checksum") << QByteArray("#A%1*00\n");
+    QTest::newRow("too long") << QByteArray("#A99999999%1\n");
+}
+
+void Test_ReliableLink::malformedReplies()
+{
+    QFETCH(QByteArray, format);
+
+    auto &link = ReliableLink::instance();
+    const auto sequence = link.send("STOP");
+    reply(QString::fromLatin1(format).arg(sequence).toLatin1());
+
+    QCOMPARE(link.stats().pending, 1);
+    QCOMPARE(link.stats().acknowledged, quint64(0));
+
+    // The next line is detected normally
+    reply("#A" + QByteArray::number(sequence) + "\n");
+    QCOMPARE(link.stats().pending, 0);
+}
+
+void Test_ReliableLink::rejection()
+{
+    auto &link = ReliableLink::instance();
+    const auto sequence = QByteArray::number(link.send("STOP"));
+
+    // The command is sent again right away, with the same frame
+    reply("#N" + sequence + "\n");
+    QCOMPARE(link.stats().rejected, quint64(1));
+    QCOMPARE(link.stats().retransmissions, quint64(1));
+    QCOMPARE(m_device.frames.count(), 2);
+    QCOMPARE(m_device.frames.at(1), m_device.frames.at(0));
+
+    // RTT samples of retransmitted commands are discarded
+    reply("#A" + sequence + "\n");
+    QCOMPARE(link.stats().acknowledged, quint64(1));
+    QCOMPARE(link.stats().smoothedRtt, qint64(0));
+}
+
+void Test_ReliableLink::timeout()
+{
+    auto &link = ReliableLink::instance();
+
+    // A fast round trip lowers the timeout, so that the test does not take seconds
+    reply("#A" + QByteArray::number(link.send("PING")) + "\n");
+    const auto timeout = link.stats().timeout;
+    QVERIFY(timeout > 0 && timeout < 100 * 1000);
+
+    qint64 failedAt = 0;
+    QSignalSpy spy(&link, &ReliableLink::commandFailed);
+    const auto connection = connect(&link, &ReliableLink::commandFailed, this, [&]() {
+        failedAt = m_device.clock.nsecsElapsed() / 1000;
+    });
+
+    const auto sequence = link.send("STOP");
+    const auto attempts = int(ReliableLink::MAX_ATTEMPTS);
+    QTRY_COMPARE_WITH_TIMEOUT(spy.count(), 1, 5000);
+    disconnect(connection);
+
+    // Same frame for every attempt, nothing is sent after the last one
+    QCOMPARE(spy.first().first().toInt(), sequence);
+    QCOMPARE(m_device.frames.count(), 1 + attempts);
+    for (int i = 2; i < m_device.frames.count(); ++i)
+        QCOMPARE(m_device.frames.at(i), m_device.frames.at(1));
+
+    // The timeout doubles after each attempt
+    for (int i = 0; i < attempts; ++i)
+    {
+        const auto sentAt = m_device.times.at(1 + i);
+        const auto next = (i + 1 < attempts) ? m_device.times.at(2 + i) : failedAt;
+        QVERIFY(next - sentAt >= (timeout << i));
+    }
+
+    QCOMPARE(link.stats().retransmissions, quint64(attempts - 1));
+    QCOMPARE(link.stats().failures, quint64(1));
+    QCOMPARE(link.stats().pending, 0);
+}
+
+/**
+ * Simulates the reception of @a data from the device
+ */
+void Test_ReliableLink::reply(const QByteArray &data)
+{
+    Q_EMIT m_device.dataReceived(data);
+}
@@ -0,0 +1,95 @@
+/*
+ * Copyright (c) 2022 Alex Spataru <https://github.com/alex-spataru>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <QList>
+#include <QObject>
+#include <QByteArray>
+#include <QElapsedTimer>
+
+#include "HAL_Driver.h"
+
+/**
+ * @brief The RecordingDriver class
+ *
+ * Driver that keeps every frame written to it & the time at which it was written (in
+ * microseconds), the replies of the device are simulated by emitting
+ * @c dataReceived().
+ */
+class RecordingDriver : public HAL_Driver
+{
+public:
+    RecordingDriver() { clock.start(); }
+
+    void close() override {}
+    bool isOpen() const override { return true; }
+    bool isReadable() const override { return true; }
+    bool isWritable() const override { return true; }
+    bool configurationOk() const override { return true; }
+    bool open(const QIODevice::OpenMode) override { return true; }
+
+    quint64 write(const QByteArray &data) override
+    {
+        frames.append(data);
+        times.append(clock.nsecsElapsed() / 1000);
+        return data.size();
+    }
+
+    QElapsedTimer clock;
+    QList<qint64> times;
+    QList<QByteArray> frames;
+};
+
+/**
+ * @brief The Test_ReliableLink class
+ *
+ * Checks the frames of the critical commands & the detection of the replies of the
+ * firmware: acknowledgements split across chunks or mixed with telemetry, replies
+ * with a wrong sequence number, duplicate acknowledgements, malformed replies and
+ * rejections, which must resend the command right away. Unacknowledged commands must
+ * be sent again with a doubled timeout & fail after the last attempt.
+ */
+class Test_ReliableLink : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void init();
+    void cleanupTestCase();
+
+    void commandFrame();
+    void acknowledgement();
+    void splitReply();
+    void wrongSequence();
+    void duplicateAcknowledgement();
+    void malformedReplies_data();
+    void malformedReplies();
+    void rejection();
+    void timeout();
+
+private:
+    void reply(const QByteArray &data);
+
+private:
+    RecordingDriver m_device;
+};
@@ -0,0 +1,227 @@
+/*
+ * Copyright (c) 2022 Alex Spataru <https://github.com/alex-spataru>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "Test_Shaper.h"
+#include "Shaper.h"
+
+#include <QTest>
+#include <QVector>
+
+#include <cmath>
+
+/**
+ * Frame interval used by the tests, in seconds
+ */
+static const double DT = 0.01;
+
+/**
+ * Builds the limits of a shaped output
+ */
+static Shaper::Limits limits(const double rate, const double acceleration,
+                             const double jerk)
+{
+    Shaper::Limits limits;
+    limits.rate = rate;
+    limits.acceleration = acceleration;
+    limits.jerk = jerk;
+    return limits;
+}
+
+/**
+ * Moves an output from @a from to @a to & returns the value sent in each frame, until
+ * the output has stopped exactly at the target (at most 1000 frames).
+ */
+static QVector<double> ramp(const Shaper::Limits &limits, const double from,
+                            const double to)
+{
+    Shaper::State state;
+    Shaper::reset(state, from);
+
+    QVector<double> values;
+    while (values.count() < 1000)
+    {
+        Shaper::step(state, to, limits, DT);
+        values.append(state.value);
+        if (state.value == to && state.position == to && state.velocity == 0)
+            break;
+    }
+
+    return values;
+}
+
+/**
+ * Returns the largest change of the @a values between two frames, starting at @a from
+ */
+static double maximumStep(const QVector<double> &values, double from)
+{
+    double maximum = 0;
+    for (const auto value : values)
+    {
+        maximum = qMax(maximum, std::fabs(value - from));
+        from = value;
+    }
+
+    return maximum;
+}
+
+/**
+ * Returns @c true if the @a values go from @a from to @a to without moving back or
+ * going past the target
+ */
+static bool monotonic(const QVector<double> &values, double from, const double to)
+{
+    const auto sign = to > from ? 1 : -1;
+    for (const auto value : values)
+    {
+        if ((value - from) * sign < 0 || (to - value) * sign < 0)
+            return false;
+
+        from = value;
+    }
+
+    return true;
+}
+
+void Test_Shaper::unlimited()
+{
+    const auto none = limits(0, 0, 0);
+    QVERIFY(!Shaper::isLimited(none));
+    QVERIFY(Shaper::isLimited(limits(1, 0, 0)));
+    QVERIFY(Shaper::isLimited(limits(0, 1, 0)));
+
+    // Jerk alone does not shape the value
+    QVERIFY(!Shaper::isLimited(limits(0, 0, 1)));
+
+    const auto values = ramp(none, 0, 360);
+    QCOMPARE(values.count(), 1);
+    QCOMPARE(values.first(), 360.0);
+}
+
+void Test_Shaper::reset()
+{
+    Shaper::State state;
+    Shaper::reset(state, 3);
+    QCOMPARE(state.value, 3.0);
+    QCOMPARE(state.velocity, 0.0);
+
+    // A stopped output stays exactly where it is
+    for (int i = 0; i < 10; ++i)
+    {
+        Shaper::step(state, 3, limits(10, 50, 500), DT);
+        QCOMPARE(state.value, 3.0);
+    }
+}
+
+void Test_Shaper::slewRate()
+{
+    const auto slew = limits(10, 0, 0);
+
+    // 0.1 per frame, the last frame ends exactly on the target
+    auto values = ramp(slew, 0, 1);
+    QVERIFY(values.count() <= 11);
+    QCOMPARE(values.last(), 1.0);
+    QVERIFY(maximumStep(values, 0) <= 10 * DT + 1e-9);
+    QVERIFY(monotonic(values, 0, 1));
+    QVERIFY(std::fabs(values.at(4) - 0.5) < 1e-9);
+
+    values = ramp(slew, 1, -1);
+    QVERIFY(values.count() <= 21);
+    QCOMPARE(values.last(), -1.0);
+    QVERIFY(monotonic(values, 1, -1));
+}
+
+void Test_Shaper::trapezoid_data()
+{
+    QTest::addColumn<double>("from");
+    QTest::addColumn<double>("to");
+    QTest::addColumn<int>("frames");
+
+    // 0.2 s to accelerate, 0.3 s at 10/s & 0.2 s to decelerate
+    QTest::newRow("forward") << 0.0 << 5.0 << 70;
+    QTest::newRow("backward") << 5.0 << -5.0 << 120;
+    QTest::newRow("short") << 0.0 << 0.5 << 20;
+}
+
+void Test_Shaper::trapezoid()
+{
+    QFETCH(double, from);
+    QFETCH(double, to);
+    QFETCH(int, frames);
+
+    const auto trapezoid = limits(10, 50, 0);
+    const auto change = 50 * DT;
+
+    Shaper::State state;
+    Shaper::reset(state, from);
+
+    int count = 0;
+    double velocity = 0;
+    while (count < 1000 && !(state.position == to && state.velocity == 0))
+    {
+        Shaper::step(state, to, trapezoid, DT);
+        ++count;
+
+        // Speed & acceleration limits, the last frame stops the output
+        QVERIFY(std::fabs(state.velocity) <= 10 + 1e-9);
+        if (state.position != to)
+            QVERIFY(std::fabs(state.velocity - velocity) <= change + 1e-9);
+
+        velocity = state.velocity;
+    }
+
+    QCOMPARE(state.value, to);
+    QVERIFY(qAbs(count - frames) <= 3);
+
+    const auto values = ramp(trapezoid, from, to);
+    QVERIFY(monotonic(values, from, to));
+    QVERIFY(maximumStep(values, from) <= 10 * DT + 1e-9);
+}
+
+void Test_Shaper::sCurve_data()
+{
+    QTest::addColumn<double>("from");
+    QTest::addColumn<double>("to");
+
+    QTest::newRow("forward") << 0.0 << 5.0;
+    QTest::newRow("backward") << 5.0 << -5.0;
+}
+
+void Test_Shaper::sCurve()
+{
+    QFETCH(double, from);
+    QFETCH(double, to);
+
+    // The acceleration is reached in 0.1 s, the average spans 20 frames
+    const auto trapezoid = ramp(limits(10, 50, 0), from, to);
+    const auto sCurve = ramp(limits(10, 50, 500), from, to);
+
+    QCOMPARE(sCurve.last(), to);
+    QVERIFY(sCurve.count() <= trapezoid.count() + 20);
+    QVERIFY(monotonic(sCurve, from, to));
+    QVERIFY(maximumStep(sCurve, from) <= 10 * DT + 1e-9);
+
+    // Softer start & end than the trapezoid
+    QVERIFY(std::fabs(sCurve.first() - from) < std::fabs(trapezoid.first() - from));
+    const auto sCurveEnd = std::fabs(to - sCurve.at(sCurve.count() - 2));
+    const auto trapezoidEnd = std::fabs(to - trapezoid.at(trapezoid.count() - 2));
+    QVERIFY(sCurveEnd < trapezoidEnd);
+}
@@ -0,0 +1,251 @@
+/*
+ * Copyright (c) 2022 Alex Spataru <https://github.com/alex-spataru>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "Test_Telemetry.h"
+#include "LineFramer.h"
+#include "TelemetryParser.h"
+
+#include <QTest>
+#include <QtEndian>
+#include <QByteArray>
+#include <QStringList>
+
+#include <cstring>
+
+/**
+ * Passes each chunk to the @a framer & returns the lines found
+ */
+static QStringList frame(LineFramer &framer, const QList<QByteArray> &chunks)
+{
+    QStringList lines;
+    for (const auto &chunk : chunks)
+    {
+        framer.append(chunk.constData(), chunk.size(), [&](const char *line, int length) {
+            lines.append(QString::fromLatin1(line, length));
+        });
+    }
+
+    return lines;
+}
+
+/**
+ * Builds a binary telemetry frame with the given @a values
+ */
+QByteArray Test_Telemetry::binaryFrame(const QVector<float> &values)
+{
+    QByteArray frame;
+    frame.append(char(0xA5));
+    frame.append(char(0x5A));
+    frame.append(char(values.count()));
+    for (const auto value : values)
+    {
+        quint32 raw;
+        memcpy(&raw, &value, sizeof(raw));
+
+        uchar bytes[4];
+        qToLittleEndian(raw, bytes);
+        frame.append(reinterpret_cast<const char *>(bytes), 4);
+    }
+
+    quint8 checksum = 0;
+    for (int i = 2; i < frame.size(); ++i)
+        checksum ^= static_cast<quint8>(frame.at(i));
+
+    frame.append(char(checksum));
+    return frame;
+}
+
+/**
+ * Passes each chunk to the @a parser & returns the number of records decoded
+ */
+static int decode(TelemetryParser &parser, const QList<QByteArray> &chunks)
+{
+    int records = 0;
+    for (const auto &chunk : chunks)
+    {
+        parser.appendBinary(chunk.constData(), chunk.size(), 1,
+                            [&](const TelemetryParser::Record &) { ++records; });
+    }
+
+    return records;
+}
+
+void Test_Telemetry::splitLines()
+{
+    LineFramer framer(64);
+    const auto lines = frame(framer, { "10,20\n30", ",40\r", "\n\n\r\n", "50\n" });
+    QCOMPARE(lines, QStringList() << "10,20" << "30,40" << "50");
+
+    // One byte at a time
+    QList<QByteArray> bytes;
+    const QByteArray data = "1,2\r\n3,4\n";
+    for (const auto byte : data)
+        bytes.append(QByteArray(1, byte));
+
+    QCOMPARE(frame(framer, bytes), QStringList() << "1,2" << "3,4");
+    QCOMPARE(framer.overflows(), quint64(0));
+
+    // An incomplete line is dropped by clear()
+    frame(framer, { "99,9" });
+    framer.clear();
+    QCOMPARE(frame(framer, { "7\n" }), QStringList() << "7");
+}
+
+void Test_Telemetry::oversizedLines()
+{
+    LineFramer framer(8);
+
+    // Lines that fill the buffer exactly are kept, even when split
+    QCOMPARE(frame(framer, { "12345678\n" }), QStringList() << "12345678");
+    QCOMPARE(frame(framer, { "1234", "5678\n" }), QStringList() << "12345678");
+    QCOMPARE(framer.overflows(), quint64(0));
+
+    // A longer line is discarded up to its line ending & counted once
+    QCOMPARE(frame(framer, { "123456789\nok\n" }), QStringList() << "ok");
+    QCOMPARE(framer.overflows(), quint64(1));
+
+    QCOMPARE(frame(framer, { "12345", "67890", "12345", "6\nok\n" }),
+             QStringList() << "ok");
+    QCOMPARE(framer.overflows(), quint64(2));
+}
+
+void Test_Telemetry::textFields()
+{
+    TelemetryParser parser;
+
+    const QByteArray line = "1523,-20, 90.5;3.2e3";
+    QVERIFY(parser.parseLine(line.constData(), line.size(), 10));
+
+    const auto &record = parser.record();
+    QCOMPARE(record.count, 4);
+    QCOMPARE(record.sequence, quint64(1));
+    QCOMPARE(record.timestamp, qint64(10));
+    QCOMPARE(record.fields[0].value, 1523.0);
+    QCOMPARE(record.fields[1].value, -20.0);
+    QCOMPARE(record.fields[2].value, 90.5);
+    QCOMPARE(record.fields[3].value, 3200.0);
+
+    // Empty fields keep their previous value & timestamp
+    const QByteArray partial = "1,,3\t4";
+    QVERIFY(parser.parseLine(partial.constData(), partial.size(), 20));
+    QCOMPARE(record.count, 4);
+    QCOMPARE(record.fields[1].value, -20.0);
+    QCOMPARE(record.fields[1].timestamp, qint64(10));
+    QCOMPARE(record.fields[3].value, 4.0);
+    QCOMPARE(record.fields[3].timestamp, qint64(20));
+    QCOMPARE(parser.errors(), quint64(0));
+}
+
+void Test_Telemetry::invalidText()
+{
+    TelemetryParser parser;
+
+    const QByteArray valid = "1,2";
+    QVERIFY(parser.parseLine(valid.constData(), valid.size(), 1));
+
+    const QList<QByteArray> invalid = { "12,abc,7", "1.2.3", "-", "1e", ",,", "12x" };
+    for (const auto &line : invalid)
+        QVERIFY2(!parser.parseLine(line.constData(), line.size(), 2), line.constData());
+
+    QCOMPARE(parser.errors(), quint64(invalid.count()));
+    QCOMPARE(parser.record().sequence, quint64(1));
+    QCOMPARE(parser.record().count, 2);
+
+    // The valid fields of a rejected line are not kept
+    QCOMPARE(parser.record().fields[0].value, 1.0);
+    QCOMPARE(parser.record().fields[0].timestamp, qint64(1));
+    QCOMPARE(parser.record().fields[1].value, 2.0);
+    QCOMPARE(parser.record().fields[2].timestamp, qint64(0));
+
+    // Control lines are skipped without being counted as errors
+    const QByteArray control = "#ACK 3";
+    QVERIFY(!parser.parseLine(control.constData(), control.size(), 3));
+    QCOMPARE(parser.errors(), quint64(invalid.count()));
+}
+
+void Test_Telemetry::binaryFrames()
+{
+    TelemetryParser parser;
+
+    const auto frame = binaryFrame({ 1.5f, -20, 90.5f });
+    QCOMPARE(decode(parser, { "\x01\x02" + frame + frame }), 2);
+
+    const auto &record = parser.record();
+    QCOMPARE(record.count, 3);
+    QCOMPARE(record.sequence, quint64(2));
+    QCOMPARE(record.fields[0].value, 1.5);
+    QCOMPARE(record.fields[1].value, -20.0);
+    QCOMPARE(record.fields[2].value, 90.5);
+    QCOMPARE(parser.errors(), quint64(0));
+}
+
+void Test_Telemetry::splitBinaryFrames()
+{
+    TelemetryParser parser;
+
+    // One byte at a time
+    QList<QByteArray> bytes;
+    const auto frame = binaryFrame({ 4, 8 });
+    for (const auto byte : frame)
+        bytes.append(QByteArray(1, byte));
+
+    QCOMPARE(decode(parser, bytes), 1);
+    QCOMPARE(parser.record().fields[1].value, 8.0);
+
+    // Split inside the sync bytes & inside a field
+    QCOMPARE(decode(parser, { frame.left(1), frame.mid(1, 4), frame.mid(5) }), 1);
+    QCOMPARE(parser.record().sequence, quint64(2));
+    QCOMPARE(parser.errors(), quint64(0));
+}
+
+void Test_Telemetry::badChecksum()
+{
+    TelemetryParser parser;
+
+    auto corrupted = binaryFrame({ 1, 2 });
+    corrupted[4] = char(corrupted.at(4) ^ 0x10);
+
+    auto wrongChecksum = binaryFrame({ 1, 2 });
+    wrongChecksum[wrongChecksum.size() - 1] = char(wrongChecksum.at(3));
+
+    // Bad frames are counted & the next frame is decoded
+    const auto good = binaryFrame({ 3, 4 });
+    QCOMPARE(decode(parser, { corrupted, wrongChecksum, good }), 1);
+    QCOMPARE(parser.errors(), quint64(2));
+    QCOMPARE(parser.record().sequence, quint64(1));
+    QCOMPARE(parser.record().fields[0].value, 3.0);
+}
+
+void Test_Telemetry::badFieldCount()
+{
+    TelemetryParser parser;
+
+    QByteArray empty("\xA5\x5A\x00", 3);
+    QByteArray tooLong("\xA5\x5A", 2);
+    tooLong.append(char(TelemetryParser::MAX_FIELDS + 1));
+
+    const auto good = binaryFrame({ 5 });
+    QCOMPARE(decode(parser, { empty, tooLong, good }), 1);
+    QCOMPARE(parser.errors(), quint64(2));
+    QCOMPARE(parser.record().count, 1);
+    QCOMPARE(parser.record().fields[0].value, 5.0);
+}
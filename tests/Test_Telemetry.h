@@ -0,0 +1,53 @@
+/*
+ * Copyright (c) 2022 Alex Spataru <https://github.com/alex-spataru>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <QVector>
+#include <QObject>
+#include <QByteArray>
+
+/**
+ * @brief The Test_Telemetry class
+ *
+ * Checks the decoding of the data received from the device: lines split across
+ * several chunks, lines that do not fit in the buffer of the @c LineFramer, text
+ * telemetry with missing or invalid fields and binary frames that are split, preceded
+ * by noise or have a bad checksum.
+ */
+class Test_Telemetry : public QObject
+{
+    Q_OBJECT
+
+public:
+    static QByteArray binaryFrame(const QVector<float> &values);
+
+private Q_SLOTS:
+    void splitLines();
+    void oversizedLines();
+    void textFields();
+    void invalidText();
+    void binaryFrames();
+    void splitBinaryFrames();
+    void badChecksum();
+    void badFieldCount();
+};
@@ -0,0 +1,47 @@
+#-------------------------------------------------------------------------------
+# Pruebas unitarias del nucleo de la aplicacion
+#
+#   qmake && make && ./joystick2serial-tests
+#-------------------------------------------------------------------------------
+
+UI_DIR = uic
+MOC_DIR = moc
+RCC_DIR = qrc
+OBJECTS_DIR = obj
+
+CONFIG += c++11
+CONFIG += silent
+CONFIG += console
+CONFIG += testcase
+CONFIG += utf8_source
+CONFIG -= app_bundle
+
+TEMPLATE = app
+TARGET = joystick2serial-tests
+
+QT += core
+QT += testlib
+
+#-------------------------------------------------------------------------------
+# Archivos
+#-------------------------------------------------------------------------------
+
+include($$PWD/../lib/Libraries.pri)
+include($$PWD/../src/Core.pri)
+
+HEADERS += \
+    $$PWD/Test_BaudProbe.h \
+    $$PWD/Test_Expression.h \
+    $$PWD/Test_Mixer.h \
+    $$PWD/Test_ReliableLink.h \
+    $$PWD/Test_Shaper.h \
+    $$PWD/Test_Telemetry.h
+
+SOURCES += \
+    $$PWD/Test_BaudProbe.cpp \
+    $$PWD/Test_Expression.cpp \
+    $$PWD/Test_Mixer.cpp \
+    $$PWD/Test_ReliableLink.cpp \
+    $$PWD/Test_Shaper.cpp \
+    $$PWD/Test_Telemetry.cpp \
+    $$PWD/main.cpp
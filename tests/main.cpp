@@ -0,0 +1,63 @@
+/*
+ * Copyright (c) 2022 Alex Spataru <https://github.com/alex-spataru>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <QTest>
+#include <QCoreApplication>
+
+#include "Test_Expression.h"
+#include "Test_Telemetry.h"
+#include "Test_ReliableLink.h"
+#include "Test_BaudProbe.h"
+#include "Test_Mixer.h"
+#include "Test_Shaper.h"
+
+/**
+ * Runs every test case, the arguments are handled by QtTest (e.g. the name of the
+ * tests to run). Returns the number of test cases that failed.
+ */
+int main(int argc, char **argv)
+{
+    QCoreApplication app(argc, argv);
+    app.setApplicationName("Joystick2Serial Tests");
+
+    int failures = 0;
+
+    Test_Expression expression;
+    failures += QTest::qExec(&expression, argc, argv) != 0;
+
+    Test_Telemetry telemetry;
+    failures += QTest::qExec(&telemetry, argc, argv) != 0;
+
+    Test_ReliableLink reliableLink;
+    failures += QTest::qExec(&reliableLink, argc, argv) != 0;
+
+    Test_BaudProbe baudProbe;
+    failures += QTest::qExec(&baudProbe, argc, argv) != 0;
+
+    Test_Mixer mixer;
+    failures += QTest::qExec(&mixer, argc, argv) != 0;
+
+    Test_Shaper shaper;
+    failures += QTest::qExec(&shaper, argc, argv) != 0;
+
+    return failures;
+}